@@ -17,7 +17,10 @@
 #include <esp_console.h>
 #include <esp_log.h>
 #include <esp_system.h>
+#include <esp_timer.h>
 #include <fcntl.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <linenoise/linenoise.h>
 #include <sdkconfig.h>
 #include <soc/soc_caps.h>
@@ -26,6 +29,8 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "cli-internal.h"
+
 /* Includes for console peripherals */
 #include <driver/uart.h>
 #include <driver/uart_vfs.h>
@@ -64,20 +69,49 @@ typedef struct
   const cli_command_t *cmd_def;     /**< Original command definition */
   void *argtable[CLI_MAX_ARGS + 1]; /**< Pointers to argtable3 (+1 for arg_end) */
   uint8_t arg_count;                /**< Number of arguments */
+  bool built;                       /**< argtable allocated (always true without arguments) */
+  bool help;                        /**< Registered with resolved help text while 'help' runs */
 } cli_registered_cmd_t;
 
+/**
+ * @brief esp_console command registered through cli_register_lazy_command()
+ */
+typedef struct
+{
+  const cli_lazy_command_t *def; /**< Descriptor */
+  bool built;                    /**< def->build() done and the command registered with its argtable */
+  bool help;                     /**< Registered with resolved help text while 'help' runs */
+} cli_lazy_cmd_t;
+
+/**
+ * @brief Argument glossary pointing to resolved interned text while 'help' runs
+ */
+typedef struct
+{
+  const char **slot; /**< Glossary pointer in the argtable */
+  const char *ref;   /**< Interned reference to put back */
+} cli_help_patch_t;
+
 /**
  * @brief Internal CLI state
  *
  */
 typedef struct
 {
-  char prompt[CLI_PROMPT_MAX_LEN];             /**< Console prompt string */
+  char prompt[CLI_PROMPT_MAX_LEN];             /**< Console prompt string or template */
   bool initialized;                            /**< true if console was initialized */
   bool store_history;                          /**< true if history persistence is enabled */
   wl_handle_t wl_handle;                       /**< Wear-levelling handle for FATFS */
   cli_registered_cmd_t cmds[CLI_MAX_COMMANDS]; /**< Registered commands */
   uint8_t cmd_count;                           /**< Number of registered commands */
+  cli_lazy_cmd_t lazy[CLI_MAX_LAZY_COMMANDS];  /**< Commands registered through cli_register_lazy_command() */
+  uint8_t lazy_count;                          /**< Number of lazy commands */
+  bool lazy_argtables;                         /**< Build argtables on first use (cli_config_t.lazy_argtables) */
+  cli_help_patch_t *help_patches;              /**< Glossaries to restore after 'help' */
+  size_t help_patch_count;                     /**< Entries in help_patches */
+  SemaphoreHandle_t exec_lock;                 /**< Serializes command execution between tasks */
+  uint8_t session;                             /**< Session of the command being executed (CLI_SESSION_*) */
+  int64_t ready_us;                            /**< esp_timer time of the first prompt, 0 before cli_run() */
 } cli_state_t;
 
 /* ========================================================================== */
@@ -94,6 +128,13 @@ static cli_state_t s_cli = {
   .store_history = false,
   .wl_handle = WL_INVALID_HANDLE,
   .cmd_count = 0,
+  .lazy_count = 0,
+  .lazy_argtables = false,
+  .help_patches = NULL,
+  .help_patch_count = 0,
+  .exec_lock = NULL,
+  .session = CLI_SESSION_CONSOLE,
+  .ready_us = 0,
 };
 
 /* ========================================================================== */
@@ -127,7 +168,7 @@ static esp_err_t cli_init_filesystem(void)
                                                    .format_if_mount_failed = true,
                                                    .allocation_unit_size = CONFIG_WL_SECTOR_SIZE};
 
-  esp_err_t err = esp_vfs_fat_spiflash_mount_rw_wl(CLI_MOUNT_PATH, "storage", &mount_config, &s_cli.wl_handle);
+  esp_err_t err = esp_vfs_fat_spiflash_mount_rw_wl(CLI_MOUNT_PATH, CLI_STORAGE_PARTITION, &mount_config, &s_cli.wl_handle);
   if (err != ESP_OK)
   {
     ESP_LOGE(TAG, "Failed to mount FATFS (%s). History disabled.", esp_err_to_name(err));
@@ -250,6 +291,9 @@ static void cli_init_linenoise(void)
   if (probe_status)
     linenoiseSetDumbMode(1);
 #endif
+
+  /* After the probe, which relies on non-blocking reads through the VFS */
+  cli_input_init();
 }
 
 /**
@@ -288,6 +332,13 @@ esp_err_t cli_init(const cli_config_t *config)
   if (config == NULL)
     config = &default_config;
 
+  if (s_cli.exec_lock == NULL)
+  {
+    s_cli.exec_lock = xSemaphoreCreateRecursiveMutex();
+    if (s_cli.exec_lock == NULL)
+      return ESP_ERR_NO_MEM;
+  }
+
   /* Initialize NVS */
   esp_err_t err = cli_init_nvs();
   if (err != ESP_OK)
@@ -314,11 +365,46 @@ esp_err_t cli_init(const cli_config_t *config)
   cli_init_peripheral();
   cli_init_linenoise();
 
+  cli_prompt_init();
   cli_setup_prompt(config->prompt);
+  s_cli.lazy_argtables = config->lazy_argtables;
 
   if (config->register_help)
     esp_console_register_help_command();
 
+  if (config->enable_audit && cli_audit_init() != ESP_OK)
+    ESP_LOGW(TAG, "Failed to enable command audit");
+
+  if (config->enable_scheduler && cli_schedule_init() != ESP_OK)
+    ESP_LOGW(TAG, "Failed to start command scheduler");
+
+  if (config->enable_compress && cli_compress_init() != ESP_OK)
+    ESP_LOGW(TAG, "Failed to register 'compress'");
+
+  if (config->enable_time && cli_time_init() != ESP_OK)
+    ESP_LOGW(TAG, "Failed to register 'time'");
+
+  if (config->enable_diff_redraw && cli_redraw_init() != ESP_OK)
+    ESP_LOGW(TAG, "Minimal line redraw disabled");
+
+  if (config->enable_record && cli_record_init() != ESP_OK)
+    ESP_LOGW(TAG, "Failed to register 'record' and 'replay'");
+
+  if (config->enable_idle_sleep && cli_power_init() != ESP_OK)
+    ESP_LOGW(TAG, "Idle light sleep disabled");
+
+  if (config->enable_cpu_boost && cli_power_boost_init() != ESP_OK)
+    ESP_LOGW(TAG, "CPU boost disabled");
+
+  if (config->enable_metrics && cli_metrics_init() != ESP_OK)
+    ESP_LOGW(TAG, "Failed to register 'metrics'");
+
+  if (config->enable_profiler && cli_profile_init() != ESP_OK)
+    ESP_LOGW(TAG, "Failed to register 'profile'");
+
+  if (config->enable_trace && cli_trace_init() != ESP_OK)
+    ESP_LOGW(TAG, "Failed to enable command tracing");
+
   if (config->banner != NULL)
     printf("\n%s\n", config->banner);
   else
@@ -346,10 +432,16 @@ esp_err_t cli_run(void)
     return ESP_ERR_INVALID_STATE;
   }
 
+  if (s_cli.ready_us == 0)
+    s_cli.ready_us = esp_timer_get_time();
+
   while (true)
   {
     /* Read line from user */
-    char *line = linenoise(s_cli.prompt);
+    cli_record_prompt();
+    cli_redraw_begin();
+    char *line = linenoise(cli_prompt_render(s_cli.prompt));
+    cli_redraw_end();
 
     if (line == NULL)
     {
@@ -360,6 +452,9 @@ esp_err_t cli_run(void)
 #endif
     }
 
+    cli_trace(CLI_TRACE_LINE, strlen(line));
+    cli_power_command_begin();
+
     if (strlen(line) > 0)
     {
       linenoiseHistoryAdd(line);
@@ -369,7 +464,7 @@ esp_err_t cli_run(void)
 
     /* Execute the command */
     int ret;
-    esp_err_t err = esp_console_run(line, &ret);
+    esp_err_t err = cli_exec_line(CLI_SESSION_CONSOLE, line, &ret);
 
     if (err == ESP_ERR_NOT_FOUND)
       printf("Command not recognized\n");
@@ -377,10 +472,12 @@ esp_err_t cli_run(void)
       printf("Command returned error: 0x%x (%s)\n", ret, esp_err_to_name(ret));
     else if (err != ESP_OK)
       printf("Internal error: %s\n", esp_err_to_name(err));
-    // Empty command, ignore
-    // if (err == ESP_ERR_INVALID_ARG)
+    if (err != ESP_ERR_INVALID_ARG) /* Empty line */
+      cli_prompt_set_result(err, ret);
+    cli_trace_flush();
 
     linenoiseFree(line);
+    cli_power_command_end();
   }
 
   ESP_LOGE(TAG, "Console terminated");
@@ -391,6 +488,7 @@ void cli_deinit(void)
 {
   if (s_cli.initialized)
   {
+    cli_schedule_deinit();
     esp_console_deinit();
 
     if (s_cli.store_history)
@@ -401,13 +499,27 @@ void cli_deinit(void)
 
     s_cli.initialized = false;
     s_cli.cmd_count = 0;
+    s_cli.lazy_count = 0;
     ESP_LOGI(TAG, "CLI finalized");
   }
 }
 
 const char *cli_get_prompt(void)
 {
-  return s_cli.prompt;
+  return cli_prompt_render(s_cli.prompt);
+}
+
+const char *cli_get_storage(wl_handle_t *wl_handle)
+{
+  if (wl_handle)
+    *wl_handle = s_cli.wl_handle;
+
+  return (s_cli.wl_handle != WL_INVALID_HANDLE) ? CLI_MOUNT_PATH : NULL;
+}
+
+int64_t cli_get_ready_time_us(void)
+{
+  return s_cli.ready_us;
 }
 
 /* ========================================================================== */
@@ -415,41 +527,347 @@ const char *cli_get_prompt(void)
 /* ========================================================================== */
 
 /**
- * @brief Wrapper function that is called by esp_console when a command is executed. It looks up the registered command,
- * parses arguments using argtable3, and calls the user-defined callback with a cli_context_t structure.
+ * @brief Find a command registered through cli_register_command()
  *
- * @param argc Number of arguments
- * @param argv Array of argument strings (argv[0] is the command name)
- * @return int
+ * @param name Command name
+ * @return cli_registered_cmd_t* Registered command, NULL if not found
  */
-static int cli_command_wrapper(int argc, char **argv)
+static cli_registered_cmd_t *cli_find_command(const char *name)
 {
-  cli_registered_cmd_t *reg_cmd = NULL;
   for (int i = 0; i < s_cli.cmd_count; i++)
   {
-    if (strcmp(s_cli.cmds[i].cmd_def->name, argv[0]) == 0)
+    if (strcmp(s_cli.cmds[i].cmd_def->name, name) == 0)
+      return &s_cli.cmds[i];
+  }
+
+  return NULL;
+}
+
+static int cli_command_wrapper(int argc, char **argv);
+static int cli_lazy_wrapper(void *context, int argc, char **argv);
+
+/**
+ * @brief Register a cli_command_t with esp_console, with its argtable once it is built
+ *
+ * @param help Help text, cmd_def->description or its resolved interned text
+ */
+static esp_err_t cli_console_register(const cli_registered_cmd_t *reg_cmd, const char *help)
+{
+  const cli_command_t *cmd = reg_cmd->cmd_def;
+  const esp_console_cmd_t esp_cmd = {
+    .command = cmd->name,
+    .help = help,
+    .hint = cmd->hint,
+    .func = cli_command_wrapper,
+    .argtable = (reg_cmd->arg_count > 0 && reg_cmd->built) ? (void *)reg_cmd->argtable : NULL,
+  };
+
+  return esp_console_cmd_register(&esp_cmd);
+}
+
+/**
+ * @brief Allocate the argtable3 structures of a registered command
+ *
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG (bad argument type) or ESP_ERR_NO_MEM, nothing left allocated
+ */
+static esp_err_t cli_build_argtable(cli_registered_cmd_t *reg_cmd)
+{
+  const cli_command_t *cmd = reg_cmd->cmd_def;
+
+  for (int i = 0; i < cmd->arg_count; i++)
+  {
+    const cli_arg_t *arg = &cmd->args[i];
+
+    switch (arg->type)
     {
-      reg_cmd = &s_cli.cmds[i];
-      break;
+      case CLI_ARG_TYPE_INT:
+      {
+        if (arg->required)
+          reg_cmd->argtable[i] = arg_int1(arg->short_opt, arg->long_opt, arg->datatype, arg->description);
+        else
+          reg_cmd->argtable[i] = arg_int0(arg->short_opt, arg->long_opt, arg->datatype, arg->description);
+        break;
+      }
+      case CLI_ARG_TYPE_STRING:
+      {
+        if (arg->required)
+          reg_cmd->argtable[i] = arg_str1(arg->short_opt, arg->long_opt, arg->datatype, arg->description);
+        else
+          reg_cmd->argtable[i] = arg_str0(arg->short_opt, arg->long_opt, arg->datatype, arg->description);
+        break;
+      }
+      case CLI_ARG_TYPE_FLAG:
+      {
+        if (arg->required)
+          reg_cmd->argtable[i] = arg_lit1(arg->short_opt, arg->long_opt, arg->description);
+        else
+          reg_cmd->argtable[i] = arg_lit0(arg->short_opt, arg->long_opt, arg->description);
+        break;
+      }
+      default:
+      {
+        ESP_LOGE(TAG, "Invalid argument type: %d", arg->type);
+        for (int j = 0; j < i; j++) free(reg_cmd->argtable[j]);
+
+        return ESP_ERR_INVALID_ARG;
+      }
+    }
+
+    if (reg_cmd->argtable[i] == NULL)
+    {
+      ESP_LOGE(TAG, "Failed to allocate argument %d", i);
+      for (int j = 0; j < i; j++) free(reg_cmd->argtable[j]);
+
+      return ESP_ERR_NO_MEM;
     }
   }
 
-  if (reg_cmd == NULL)
+  reg_cmd->argtable[cmd->arg_count] = arg_end(cmd->arg_count + 1);
+  reg_cmd->built = true;
+
+  return ESP_OK;
+}
+
+/**
+ * @brief Build the argtable of a command registered lazily, then register it again with it for help and hints
+ *
+ * On failure the command stays unbuilt and the next use tries again.
+ */
+static esp_err_t cli_materialize(cli_registered_cmd_t *reg_cmd)
+{
+  if (reg_cmd->built)
+    return ESP_OK;
+
+  esp_err_t err = cli_build_argtable(reg_cmd);
+  if (err == ESP_OK)
+    err = cli_console_register(reg_cmd, reg_cmd->cmd_def->description);
+
+  return err;
+}
+
+/**
+ * @brief Register a lazy command with esp_console, with its argtable once it is built
+ *
+ * @param help Help text, def->help or its resolved interned text
+ */
+static esp_err_t cli_lazy_register(cli_lazy_cmd_t *lazy, const char *help)
+{
+  const cli_lazy_command_t *def = lazy->def;
+  const esp_console_cmd_t esp_cmd = {
+    .command = def->command,
+    .help = help,
+    .hint = def->hint,
+    .func_w_context = cli_lazy_wrapper,
+    .context = lazy,
+    .argtable = lazy->built ? def->argtable : NULL,
+  };
+
+  return esp_console_cmd_register(&esp_cmd);
+}
+
+/**
+ * @brief Run the build function of a lazy command, then register it again with its argtable
+ *
+ * On allocation failure the members that were built are freed and the next use tries again.
+ */
+static esp_err_t cli_lazy_materialize(cli_lazy_cmd_t *lazy)
+{
+  if (lazy->built)
+    return ESP_OK;
+
+  void **table = lazy->def->argtable;
+  if (lazy->def->build != NULL)
+    lazy->def->build();
+  if (table != NULL && arg_nullcheck(table) != 0)
   {
-    ESP_LOGE(TAG, "Command '%s' not found internally", argv[0]);
-    return 1;
+    ESP_LOGE(TAG, "Failed to allocate the arguments of '%s'", lazy->def->command);
+    /* Any member may be the one missing, arg_end included: free the whole table by its length */
+    arg_freetable(table, lazy->def->argtable_len);
+    memset(table, 0, lazy->def->argtable_len * sizeof(void *));
+
+    return ESP_ERR_NO_MEM;
   }
 
-  const cli_command_t *cmd = reg_cmd->cmd_def;
+  lazy->built = true;
+  return cli_lazy_register(lazy, lazy->def->help);
+}
+
+/**
+ * @brief Mark the command called name for 'help'
+ *
+ * @return true if name is a cli-api or lazy command
+ */
+static bool cli_help_select_named(const char *name, size_t len)
+{
+  for (int i = 0; i < s_cli.cmd_count; i++)
+  {
+    const char *cmd_name = s_cli.cmds[i].cmd_def->name;
+    if (strncmp(cmd_name, name, len) == 0 && cmd_name[len] == '\0')
+    {
+      s_cli.cmds[i].help = true;
+      return true;
+    }
+  }
+
+  for (int i = 0; i < s_cli.lazy_count; i++)
+  {
+    const char *cmd_name = s_cli.lazy[i].def->command;
+    if (strncmp(cmd_name, name, len) == 0 && cmd_name[len] == '\0')
+    {
+      s_cli.lazy[i].help = true;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Point an argtable entry's glossary to its resolved interned text, remembering the reference
+ */
+static void cli_help_patch(struct arg_hdr *hdr)
+{
+  if (!cli_help_is_ref(hdr->glossary))
+    return;
+
+  cli_help_patch_t *patches = realloc(s_cli.help_patches, (s_cli.help_patch_count + 1) * sizeof(*patches));
+  if (patches == NULL)
+    return;
+
+  s_cli.help_patches = patches;
+  patches[s_cli.help_patch_count++] = (cli_help_patch_t){.slot = &hdr->glossary, .ref = hdr->glossary};
+  hdr->glossary = cli_help_resolve(hdr->glossary);
+}
+
+/**
+ * @brief Get the commands 'help' is about to describe ready: argtables built, interned texts resolved
+ *
+ * 'help' prints the argument glossary from the argtables and the texts esp_console holds, so the commands it
+ * describes are built and registered again with their resolved texts until cli_help_restore(). "help <command>"
+ * prepares that command only; a plain "help" lists every command, so all of them are prepared.
+ *
+ * @return false if line is not a 'help' command
+ */
+static bool cli_help_prepare(const char *line)
+{
+  line += strspn(line, " \t");
+  if (strncmp(line, "help", 4) != 0 || (line[4] != '\0' && line[4] != ' ' && line[4] != '\t'))
+    return false;
+
+  bool named = false;
+  for (const char *p = line + 4; *(p += strspn(p, " \t")) != '\0';)
+  {
+    size_t len = strcspn(p, " \t");
+    named |= cli_help_select_named(p, len);
+    p += len;
+  }
+
+  for (int i = 0; i < s_cli.cmd_count; i++)
+  {
+    cli_registered_cmd_t *reg_cmd = &s_cli.cmds[i];
+    if (named && !reg_cmd->help)
+      continue;
+
+    cli_materialize(reg_cmd);
+    const char *desc = reg_cmd->cmd_def->description;
+    reg_cmd->help = cli_help_is_ref(desc);
+    for (int a = 0; reg_cmd->built && a < reg_cmd->arg_count; a++) cli_help_patch(reg_cmd->argtable[a]);
+    if (reg_cmd->help)
+      cli_console_register(reg_cmd, cli_help_resolve(desc));
+  }
+
+  for (int i = 0; i < s_cli.lazy_count; i++)
+  {
+    cli_lazy_cmd_t *lazy = &s_cli.lazy[i];
+    if (named && !lazy->help)
+      continue;
+
+    cli_lazy_materialize(lazy);
+    lazy->help = cli_help_is_ref(lazy->def->help);
+    struct arg_hdr **table = lazy->def->argtable;
+    for (int a = 0; lazy->built && table != NULL && !(table[a]->flag & ARG_TERMINATOR); a++) cli_help_patch(table[a]);
+    if (lazy->help)
+      cli_lazy_register(lazy, cli_help_resolve(lazy->def->help));
+  }
+
+  return true;
+}
+
+/**
+ * @brief Put the interned references back after 'help' and free the resolved texts
+ */
+static void cli_help_restore(void)
+{
+  for (int i = 0; i < s_cli.cmd_count; i++)
+  {
+    if (s_cli.cmds[i].help)
+      cli_console_register(&s_cli.cmds[i], s_cli.cmds[i].cmd_def->description);
+    s_cli.cmds[i].help = false;
+  }
+
+  for (int i = 0; i < s_cli.lazy_count; i++)
+  {
+    if (s_cli.lazy[i].help)
+      cli_lazy_register(&s_cli.lazy[i], s_cli.lazy[i].def->help);
+    s_cli.lazy[i].help = false;
+  }
+
+  for (size_t i = 0; i < s_cli.help_patch_count; i++) *s_cli.help_patches[i].slot = s_cli.help_patches[i].ref;
+  free(s_cli.help_patches);
+  s_cli.help_patches = NULL;
+  s_cli.help_patch_count = 0;
+
+  cli_help_release();
+}
+
+/**
+ * @brief Parse the arguments of a registered command into its argtable
+ *
+ * @return int 0 on success, 1 if parsing failed (errors printed to stderr)
+ */
+static int cli_parse_args(cli_registered_cmd_t *reg_cmd, int argc, char **argv)
+{
+  if (reg_cmd->arg_count == 0)
+    return 0;
+
+  if (!reg_cmd->built)
+  {
+    cli_materialize(reg_cmd);
+    if (!reg_cmd->built)
+    {
+      fprintf(stderr, "%s: out of memory for the arguments\n", argv[0]);
+      return 1;
+    }
+  }
 
   int nerrors = arg_parse(argc, argv, reg_cmd->argtable);
   if (nerrors != 0)
   {
-    struct arg_end *end = reg_cmd->argtable[cmd->arg_count];
+    struct arg_end *end = reg_cmd->argtable[reg_cmd->arg_count];
     arg_print_errors(stderr, end, argv[0]);
     return 1;
   }
 
+  return 0;
+}
+
+/**
+ * @brief Parse arguments and call the user-defined callback of a registered command with a cli_context_t structure.
+ *
+ * @param reg_cmd Registered command
+ * @param argc Number of arguments
+ * @param argv Array of argument strings (argv[0] is the command name)
+ * @return int
+ */
+static int cli_invoke(cli_registered_cmd_t *reg_cmd, int argc, char **argv)
+{
+  const cli_command_t *cmd = reg_cmd->cmd_def;
+
+  int parse_err = cli_parse_args(reg_cmd, argc, argv);
+  cli_trace(CLI_TRACE_PARSED, parse_err);
+  if (parse_err != 0)
+    return 1;
+
   cli_context_t ctx = {
     .argc = argc,
     .argv = argv,
@@ -487,7 +905,196 @@ static int cli_command_wrapper(int argc, char **argv)
     }
   }
 
-  return cmd->callback(&ctx);
+  cli_trace(CLI_TRACE_CB_START, 0);
+  int ret = cmd->callback(&ctx);
+  cli_trace(CLI_TRACE_CB_END, ret);
+
+  return ret;
+}
+
+/**
+ * @brief Wrapper function that is called by esp_console when a command is executed. It looks up the registered command
+ * and hands it over to cli_invoke().
+ *
+ * @param argc Number of arguments
+ * @param argv Array of argument strings (argv[0] is the command name)
+ * @return int
+ */
+static int cli_command_wrapper(int argc, char **argv)
+{
+  cli_trace(CLI_TRACE_TOKENIZED, argc);
+  cli_registered_cmd_t *reg_cmd = cli_find_command(argv[0]);
+  cli_trace(CLI_TRACE_LOOKUP, reg_cmd ? reg_cmd - s_cli.cmds : CLI_TRACE_NOT_FOUND);
+  if (reg_cmd == NULL)
+  {
+    ESP_LOGE(TAG, "Command '%s' not found internally", argv[0]);
+    return 1;
+  }
+
+  return cli_invoke(reg_cmd, argc, argv);
+}
+
+/**
+ * @brief esp_console entry of the commands registered through cli_register_lazy_command(): builds the argtable on
+ * the first call
+ */
+static int cli_lazy_wrapper(void *context, int argc, char **argv)
+{
+  cli_lazy_cmd_t *lazy = context;
+
+  cli_lazy_materialize(lazy);
+  if (!lazy->built)
+  {
+    fprintf(stderr, "%s: out of memory for the arguments\n", argv[0]);
+    return 1;
+  }
+
+  return lazy->def->func(argc, argv);
+}
+
+/* ========================================================================== */
+/*                          COMMAND DISPATCH                                  */
+/* ========================================================================== */
+
+void cli_lock(void)
+{
+  xSemaphoreTakeRecursive(s_cli.exec_lock, portMAX_DELAY);
+}
+
+void cli_unlock(void)
+{
+  xSemaphoreGiveRecursive(s_cli.exec_lock);
+}
+
+esp_err_t cli_exec_line(uint8_t session, const char *line, int *ret)
+{
+  cli_lock();
+
+  uint8_t outer_session = s_cli.session;
+  s_cli.session = session;
+  int audit = cli_audit_begin(session, line);
+  int64_t start = esp_timer_get_time();
+  cli_trace(CLI_TRACE_EXEC, strlen(line));
+  bool help = cli_help_prepare(line);
+
+  *ret = 0;
+  esp_err_t err = esp_console_run(line, ret);
+  if (help)
+    cli_help_restore();
+  uint32_t duration_us = (uint32_t)(esp_timer_get_time() - start);
+  cli_trace(CLI_TRACE_DONE, (err == ESP_ERR_NOT_FOUND) ? CLI_TRACE_NOT_FOUND : *ret);
+
+  cli_audit_end(audit, err, *ret, duration_us);
+  if (err != ESP_ERR_INVALID_ARG) /* Empty line */
+    cli_metrics_command(line, err != ESP_ERR_NOT_FOUND, *ret, duration_us);
+  s_cli.session = outer_session;
+  cli_unlock();
+
+  return err;
+}
+
+esp_err_t cli_exec_argv(uint8_t session, int argc, char **argv, int *ret)
+{
+  if (argc < 1)
+    return ESP_ERR_INVALID_ARG;
+
+  cli_lock();
+
+  cli_registered_cmd_t *reg_cmd = cli_find_command(argv[0]);
+  if (reg_cmd == NULL)
+  {
+    cli_unlock();
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  uint8_t outer_session = s_cli.session;
+  s_cli.session = session;
+  int audit = cli_audit_begin_argv(session, argc, argv);
+  int64_t start = esp_timer_get_time();
+
+  /* Already tokenized and looked up: the stages are recorded back to back */
+  cli_trace(CLI_TRACE_EXEC, argc);
+  cli_trace(CLI_TRACE_TOKENIZED, argc);
+  cli_trace(CLI_TRACE_LOOKUP, reg_cmd - s_cli.cmds);
+
+  *ret = cli_invoke(reg_cmd, argc, argv);
+  uint32_t duration_us = (uint32_t)(esp_timer_get_time() - start);
+  cli_trace(CLI_TRACE_DONE, *ret);
+
+  cli_audit_end(audit, ESP_OK, *ret, duration_us);
+  cli_metrics_command(argv[0], true, *ret, duration_us);
+  s_cli.session = outer_session;
+  cli_unlock();
+
+  return ESP_OK;
+}
+
+esp_err_t cli_exec_nested(int argc, char **argv, int *ret)
+{
+  esp_err_t err = cli_exec_argv(s_cli.session, argc, argv, ret);
+  if (err != ESP_ERR_NOT_FOUND)
+    return err;
+
+  char line[CLI_MAX_CMDLINE_LENGTH];
+  if (!cli_join_argv(line, sizeof(line), argc, (const char *const *)argv))
+    return ESP_ERR_INVALID_SIZE;
+
+  return cli_exec_line(s_cli.session, line, ret);
+}
+
+uint8_t cli_current_session(void)
+{
+  return s_cli.session;
+}
+
+const char *cli_command_name(uint16_t index)
+{
+  return (index < s_cli.cmd_count) ? s_cli.cmds[index].cmd_def->name : NULL;
+}
+
+bool cli_join_argv(char *out, size_t size, int argc, const char *const *argv)
+{
+  size_t pos = 0;
+  for (int i = 0; i < argc; i++)
+  {
+    bool quote = (strpbrk(argv[i], " \t") != NULL || argv[i][0] == '\0');
+    if (i > 0 && pos < size)
+      out[pos++] = ' ';
+    if (quote && pos < size)
+      out[pos++] = '"';
+    for (const char *c = argv[i]; *c && pos < size; c++)
+    {
+      if ((*c == '"' || *c == '\\') && pos < size)
+        out[pos++] = '\\';
+      if (pos < size)
+        out[pos++] = *c;
+    }
+    if (quote && pos < size)
+      out[pos++] = '"';
+  }
+
+  if (pos >= size)
+    return false;
+
+  out[pos] = '\0';
+  return true;
+}
+
+esp_err_t cli_check_argv(int argc, char **argv)
+{
+  if (argc < 1)
+    return ESP_ERR_INVALID_ARG;
+
+  cli_lock();
+
+  esp_err_t err = ESP_ERR_NOT_FOUND;
+  cli_registered_cmd_t *reg_cmd = cli_find_command(argv[0]);
+  if (reg_cmd != NULL)
+    err = (cli_parse_args(reg_cmd, argc, argv) == 0) ? ESP_OK : ESP_ERR_INVALID_ARG;
+
+  cli_unlock();
+
+  return err;
 }
 
 esp_err_t cli_register_command(const cli_command_t *cmd)
@@ -504,90 +1111,26 @@ esp_err_t cli_register_command(const cli_command_t *cmd)
     return ESP_ERR_NO_MEM;
   }
 
-  /* If no arguments, use simple registration */
-  if (cmd->arg_count == 0)
-  {
-    const esp_console_cmd_t esp_cmd = {
-      .command = cmd->name,
-      .help = cmd->description,
-      .hint = cmd->hint,
-      .func = (int (*)(int, char **))cli_command_wrapper,
-    };
-
-    s_cli.cmds[s_cli.cmd_count].cmd_def = cmd;
-    s_cli.cmds[s_cli.cmd_count].arg_count = 0;
-    s_cli.cmd_count++;
-
-    return esp_console_cmd_register(&esp_cmd);
-  }
-
-  /* Allocate argtable3 structures for each argument */
   cli_registered_cmd_t *reg_cmd = &s_cli.cmds[s_cli.cmd_count];
   reg_cmd->cmd_def = cmd;
   reg_cmd->arg_count = cmd->arg_count;
+  reg_cmd->built = (cmd->arg_count == 0);
 
-  for (int i = 0; i < cmd->arg_count; i++)
+  /* Lazy: the argtable is allocated on first use, see cli_materialize() */
+  if (!reg_cmd->built && !s_cli.lazy_argtables)
   {
-    const cli_arg_t *arg = &cmd->args[i];
-
-    switch (arg->type)
-    {
-      case CLI_ARG_TYPE_INT:
-      {
-        if (arg->required)
-          reg_cmd->argtable[i] = arg_int1(arg->short_opt, arg->long_opt, arg->datatype, arg->description);
-        else
-          reg_cmd->argtable[i] = arg_int0(arg->short_opt, arg->long_opt, arg->datatype, arg->description);
-        break;
-      }
-      case CLI_ARG_TYPE_STRING:
-      {
-        if (arg->required)
-          reg_cmd->argtable[i] = arg_str1(arg->short_opt, arg->long_opt, arg->datatype, arg->description);
-        else
-          reg_cmd->argtable[i] = arg_str0(arg->short_opt, arg->long_opt, arg->datatype, arg->description);
-        break;
-      }
-      case CLI_ARG_TYPE_FLAG:
-      {
-        if (arg->required)
-          reg_cmd->argtable[i] = arg_lit1(arg->short_opt, arg->long_opt, arg->description);
-        else
-          reg_cmd->argtable[i] = arg_lit0(arg->short_opt, arg->long_opt, arg->description);
-        break;
-      }
-      default:
-      {
-        ESP_LOGE(TAG, "Invalid argument type: %d", arg->type);
-        return ESP_ERR_INVALID_ARG;
-      }
-    }
-
-    if (reg_cmd->argtable[i] == NULL)
-    {
-      ESP_LOGE(TAG, "Failed to allocate argument %d", i);
-      for (int j = 0; j < i; j++) free(reg_cmd->argtable[j]);
-
-      return ESP_ERR_NO_MEM;
-    }
+    esp_err_t ret = cli_build_argtable(reg_cmd);
+    if (ret != ESP_OK)
+      return ret;
   }
 
-  reg_cmd->argtable[cmd->arg_count] = arg_end(cmd->arg_count + 1);
-
   /* Register command in esp_console */
-  const esp_console_cmd_t esp_cmd = {
-    .command = cmd->name,
-    .help = cmd->description,
-    .hint = cmd->hint,
-    .func = cli_command_wrapper,
-    .argtable = reg_cmd->argtable,
-  };
-
-  esp_err_t ret = esp_console_cmd_register(&esp_cmd);
+  esp_err_t ret = cli_console_register(reg_cmd, cmd->description);
   if (ret != ESP_OK)
   {
     ESP_LOGE(TAG, "Failed to register command '%s': %s", cmd->name, esp_err_to_name(ret));
-    arg_freetable(reg_cmd->argtable, cmd->arg_count + 1);
+    if (reg_cmd->built && cmd->arg_count > 0)
+      arg_freetable(reg_cmd->argtable, cmd->arg_count + 1);
     return ret;
   }
 
@@ -633,3 +1176,35 @@ esp_err_t cli_register_commands(const cli_command_t *commands, size_t count)
 
   return ESP_OK;
 }
+
+esp_err_t cli_register_lazy_command(const cli_lazy_command_t *cmd)
+{
+  /* Without arguments both argtable and build are NULL */
+  if (cmd == NULL || cmd->command == NULL || cmd->func == NULL || (cmd->argtable == NULL) != (cmd->build == NULL) ||
+      (cmd->argtable != NULL && cmd->argtable_len == 0))
+  {
+    ESP_LOGE(TAG, "Invalid parameters");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (s_cli.lazy_count >= CLI_MAX_LAZY_COMMANDS)
+  {
+    ESP_LOGE(TAG, "Command limit reached (%d)", CLI_MAX_LAZY_COMMANDS);
+    return ESP_ERR_NO_MEM;
+  }
+
+  cli_lazy_cmd_t *lazy = &s_cli.lazy[s_cli.lazy_count];
+  lazy->def = cmd;
+  lazy->built = false;
+
+  esp_err_t ret = s_cli.lazy_argtables ? cli_lazy_register(lazy, cmd->help) : cli_lazy_materialize(lazy);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGE(TAG, "Failed to register command '%s': %s", cmd->command, esp_err_to_name(ret));
+    return ret;
+  }
+
+  s_cli.lazy_count++;
+
+  return ESP_OK;
+}
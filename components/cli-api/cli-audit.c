@@ -0,0 +1,300 @@
+/**
+ * @file cli-audit.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Audit trail of executed command lines kept in RTC slow memory.
+ *
+ * Each command gets a fixed-size record in a ring that survives software resets, panics, watchdogs and deep sleep
+ * (but not power loss). The record is written before the callback runs and completed afterwards, so a command that
+ * crashes or resets the chip is still visible after reboot, marked as interrupted. No flash writes are involved.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <argtable3/argtable3.h>
+#include <esp_attr.h>
+#include <esp_console.h>
+#include <esp_log.h>
+#include <esp_rom_crc.h>
+#include <esp_timer.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "cli-internal.h"
+
+static const char *TAG = "cli-audit";
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+#define CLI_AUDIT_MAGIC   0x41554431 /* "AUD1", bump when the record layout changes */
+#define CLI_AUDIT_RUNNING INT32_MIN  /* Return code of a record whose command never completed */
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief One executed command line
+ */
+typedef struct
+{
+  uint32_t seq;                      /**< Record number, increases across reboots */
+  uint32_t boot;                     /**< Boot counter at execution time */
+  int64_t wall_ms;                   /**< Wall clock (ms since epoch), 0 if the clock was not set */
+  uint32_t uptime_ms;                /**< Time since boot */
+  uint32_t duration_us;              /**< Execution time, including argument parsing */
+  int32_t ret;                       /**< esp_err_t of the dispatch, or callback return code */
+  uint8_t session;                   /**< Session the line came from (CLI_SESSION_*) */
+  uint8_t dispatch_ok;               /**< 1 = ret is the callback return code, 0 = ret is a dispatch error */
+  char line[CLI_AUDIT_LINE_MAX_LEN]; /**< Command line, truncated */
+  uint32_t crc;                      /**< CRC32 of all previous fields */
+} cli_audit_record_t;
+
+/**
+ * @brief Ring header and records, placed in RTC slow memory
+ */
+typedef struct
+{
+  uint32_t magic;                                    /**< CLI_AUDIT_MAGIC when the ring is valid */
+  uint32_t boot;                                     /**< Boot counter */
+  uint32_t next_seq;                                 /**< Sequence number of the next record */
+  uint32_t head;                                     /**< Slot of the next record */
+  cli_audit_record_t records[CLI_AUDIT_MAX_ENTRIES]; /**< Record slots */
+} cli_audit_ring_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+/** Not initialized at boot, so it keeps its content across resets and deep sleep */
+static RTC_NOINIT_ATTR cli_audit_ring_t s_ring;
+
+static bool s_audit_enabled = false;
+
+static struct
+{
+  struct arg_int *count;
+  struct arg_lit *clear;
+  struct arg_end *end;
+} audit_args;
+
+/* ========================================================================== */
+/*                           RECORD HANDLING                                  */
+/* ========================================================================== */
+
+static uint32_t cli_audit_crc(const cli_audit_record_t *rec)
+{
+  return esp_rom_crc32_le(0, (const uint8_t *)rec, offsetof(cli_audit_record_t, crc));
+}
+
+static bool cli_audit_valid(const cli_audit_record_t *rec)
+{
+  return rec->seq != 0 && rec->crc == cli_audit_crc(rec);
+}
+
+static void cli_audit_reset_ring(void)
+{
+  memset(&s_ring, 0, sizeof(s_ring));
+  s_ring.magic = CLI_AUDIT_MAGIC;
+  s_ring.next_seq = 1;
+}
+
+int cli_audit_begin(uint8_t session, const char *line)
+{
+  if (!s_audit_enabled || line[0] == '\0')
+    return -1;
+
+  int slot = (int)s_ring.head;
+  s_ring.head = (s_ring.head + 1) % CLI_AUDIT_MAX_ENTRIES;
+
+  cli_audit_record_t *rec = &s_ring.records[slot];
+  memset(rec, 0, sizeof(*rec));
+
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+
+  rec->seq = s_ring.next_seq++;
+  rec->boot = s_ring.boot;
+  rec->wall_ms = (tv.tv_sec >= 1577836800) ? (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000 : 0;
+  rec->uptime_ms = (uint32_t)(esp_timer_get_time() / 1000);
+  rec->ret = CLI_AUDIT_RUNNING;
+  rec->session = session;
+  strlcpy(rec->line, line, sizeof(rec->line));
+  rec->crc = cli_audit_crc(rec);
+
+  return slot;
+}
+
+int cli_audit_begin_argv(uint8_t session, int argc, char **argv)
+{
+  if (!s_audit_enabled)
+    return -1;
+
+  char line[CLI_AUDIT_LINE_MAX_LEN] = "";
+  for (int i = 0; i < argc; i++)
+  {
+    if (i > 0)
+      strlcat(line, " ", sizeof(line));
+    strlcat(line, argv[i], sizeof(line));
+  }
+
+  return cli_audit_begin(session, line);
+}
+
+void cli_audit_end(int slot, esp_err_t err, int ret, uint32_t duration_us)
+{
+  if (slot < 0 || slot >= CLI_AUDIT_MAX_ENTRIES)
+    return;
+
+  cli_audit_record_t *rec = &s_ring.records[slot];
+  rec->duration_us = duration_us;
+  rec->dispatch_ok = (err == ESP_OK);
+  rec->ret = (err == ESP_OK) ? ret : err;
+  rec->crc = cli_audit_crc(rec);
+}
+
+/* ========================================================================== */
+/*                               COMMAND                                      */
+/* ========================================================================== */
+
+static const char *cli_audit_session_name(uint8_t session, char *buf, size_t size)
+{
+  if (session == CLI_SESSION_CONSOLE)
+    return "console";
+  if (session == CLI_SESSION_SCHEDULER)
+    return "sched";
+  if (session >= CLI_SESSION_TCP && session < CLI_SESSION_TCP + CLI_TCP_MAX_SESSIONS)
+  {
+    snprintf(buf, size, "tcp%u", session - CLI_SESSION_TCP + 1);
+    return buf;
+  }
+
+  snprintf(buf, size, "s%u", session);
+  return buf;
+}
+
+static void cli_audit_print(const cli_audit_record_t *rec)
+{
+  char when[24];
+  if (rec->wall_ms != 0)
+  {
+    time_t secs = (time_t)(rec->wall_ms / 1000);
+    struct tm tm;
+    gmtime_r(&secs, &tm);
+    strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%SZ", &tm);
+  }
+  else
+  {
+    snprintf(when, sizeof(when), "+%" PRIu32 ".%03" PRIu32 "s", rec->uptime_ms / 1000, rec->uptime_ms % 1000);
+  }
+
+  /* A record still running from a previous boot is the command that was executing when the chip reset */
+  char result[24];
+  if (rec->ret == CLI_AUDIT_RUNNING && rec->boot == s_ring.boot)
+    snprintf(result, sizeof(result), "running");
+  else if (rec->ret == CLI_AUDIT_RUNNING)
+    snprintf(result, sizeof(result), "INTERRUPTED");
+  else if (!rec->dispatch_ok)
+    snprintf(result, sizeof(result), "%s", esp_err_to_name(rec->ret));
+  else
+    snprintf(result, sizeof(result), "%" PRId32, rec->ret);
+
+  char session[8];
+  printf("%6" PRIu32 " %4" PRIu32 " %-20s %-7s %10.3f %-12s %s\n",
+         rec->seq,
+         rec->boot,
+         when,
+         cli_audit_session_name(rec->session, session, sizeof(session)),
+         rec->duration_us / 1000.0,
+         result,
+         rec->line);
+}
+
+static int audit_dump(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&audit_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, audit_args.end, argv[0]);
+    return 1;
+  }
+
+  if (audit_args.clear->count > 0)
+  {
+    uint32_t boot = s_ring.boot;
+    cli_audit_reset_ring();
+    s_ring.boot = boot;
+    printf("Audit ring cleared\n");
+    return 0;
+  }
+
+  int limit = (audit_args.count->count > 0) ? audit_args.count->ival[0] : CLI_AUDIT_MAX_ENTRIES;
+  if (limit <= 0 || limit > CLI_AUDIT_MAX_ENTRIES)
+    limit = CLI_AUDIT_MAX_ENTRIES;
+
+  printf("%6s %4s %-20s %-7s %10s %-12s %s\n", "Seq", "Boot", "Time", "Session", "Dur ms", "Result", "Command");
+
+  /* Oldest first: start 'limit' slots behind the head and walk forward */
+  int shown = 0;
+  for (int i = CLI_AUDIT_MAX_ENTRIES - limit; i < CLI_AUDIT_MAX_ENTRIES; i++)
+  {
+    const cli_audit_record_t *rec = &s_ring.records[(s_ring.head + i) % CLI_AUDIT_MAX_ENTRIES];
+    if (!cli_audit_valid(rec))
+      continue;
+
+    cli_audit_print(rec);
+    shown++;
+  }
+
+  if (shown == 0)
+    printf("(empty)\n");
+
+  return 0;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+esp_err_t cli_audit_init(void)
+{
+  if (s_audit_enabled)
+    return ESP_OK;
+
+  if (s_ring.magic != CLI_AUDIT_MAGIC || s_ring.head >= CLI_AUDIT_MAX_ENTRIES || s_ring.next_seq == 0)
+  {
+    ESP_LOGI(TAG, "No valid audit ring in RTC memory, starting a new one");
+    cli_audit_reset_ring();
+  }
+  s_ring.boot++;
+
+  audit_args.count = arg_int0("n", "count", "<N>", "Show only the last N records");
+  audit_args.clear = arg_lit0(NULL, "clear", "Erase all records");
+  audit_args.end = arg_end(2);
+
+  const esp_console_cmd_t cmd = {.command = "audit",
+                                 .help = "Show the last executed commands with time, session, duration and result. "
+                                         "Survives resets and deep sleep.",
+                                 .hint = NULL,
+                                 .func = &audit_dump,
+                                 .argtable = &audit_args};
+
+  esp_err_t err = esp_console_cmd_register(&cmd);
+  if (err != ESP_OK)
+    return err;
+
+  s_audit_enabled = true;
+  ESP_LOGI(TAG, "Audit ring: %d records, boot #%" PRIu32, CLI_AUDIT_MAX_ENTRIES, s_ring.boot);
+
+  return ESP_OK;
+}
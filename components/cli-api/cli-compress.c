@@ -0,0 +1,306 @@
+/**
+ * @file cli-compress.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief 'compress' prefix command: runs a command with its output LZSS-compressed in CRC-checked frames.
+ *
+ * stdout of the console task is temporarily replaced by a stream that collects output in blocks of
+ * CLI_COMPRESS_BLOCK_SIZE bytes and emits each block as one frame:
+ *
+ *   ESC 'Z' | type | raw_len (2) | data_len (2) | data | crc32 of the raw bytes (4)      (little endian)
+ *
+ * type 'B' is an LZSS block, 'R' a block stored as is (incompressible), 'E' the end of the stream. Each block is
+ * compressed on its own, so the window is the block itself and a corrupted frame only loses that block.
+ * tools/cli_lz.py recognises the frames in the console stream and decompresses them in place.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <esp_console.h>
+#include <esp_log.h>
+#include <esp_rom_crc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli-internal.h"
+
+static const char *TAG = "cli-compress";
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+#define CLI_LZ_MIN_MATCH 3
+#define CLI_LZ_MAX_MATCH 18 /* 4-bit length field */
+#define CLI_LZ_HASH_BITS 10
+#define CLI_LZ_MAX_CHAIN 16 /* Candidates checked per position, bounds the time per byte */
+
+#define CLI_LZ_FRAME_ESC      0x1B
+#define CLI_LZ_FRAME_MAGIC    'Z'
+#define CLI_LZ_FRAME_HDR_SIZE 7
+#define CLI_LZ_FRAME_CRC_SIZE 4
+
+/** Worst case LZSS output: every byte a literal, plus one flag byte per 8 items */
+#define CLI_LZ_OUT_MAX (CLI_COMPRESS_BLOCK_SIZE + (CLI_COMPRESS_BLOCK_SIZE + 7) / 8)
+
+#define CLI_LZ_FRAME_MAX (CLI_LZ_FRAME_HDR_SIZE + CLI_LZ_OUT_MAX + CLI_LZ_FRAME_CRC_SIZE)
+
+_Static_assert(CLI_COMPRESS_BLOCK_SIZE <= 4096, "12-bit match offsets and 16-bit positions limit the block size");
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief State of one compressed output stream
+ */
+typedef struct
+{
+  FILE *out;                              /**< Real stdout the frames are written to */
+  uint8_t in[CLI_COMPRESS_BLOCK_SIZE];    /**< Block being collected */
+  size_t in_len;                          /**< Bytes in in[] */
+  uint8_t frame[CLI_LZ_FRAME_MAX];        /**< Outgoing frame */
+  uint16_t head[1 << CLI_LZ_HASH_BITS];   /**< Last position + 1 of each 3-byte hash, 0 = none */
+  uint16_t prev[CLI_COMPRESS_BLOCK_SIZE]; /**< Previous position + 1 with the same hash */
+  size_t raw_total;                       /**< Bytes written by the command */
+  size_t out_total;                       /**< Bytes sent, frames included */
+} cli_lz_stream_t;
+
+/* ========================================================================== */
+/*                              LZSS ENCODER                                  */
+/* ========================================================================== */
+
+static inline uint32_t cli_lz_hash(const uint8_t *p)
+{
+  return ((p[0] << 16 | p[1] << 8 | p[2]) * 2654435761u) >> (32 - CLI_LZ_HASH_BITS);
+}
+
+static inline void cli_lz_insert(cli_lz_stream_t *s, size_t pos, size_t len)
+{
+  if (pos + CLI_LZ_MIN_MATCH > len)
+    return;
+
+  uint32_t h = cli_lz_hash(&s->in[pos]);
+  s->prev[pos] = s->head[h];
+  s->head[h] = (uint16_t)(pos + 1);
+}
+
+/**
+ * @brief Compress in[0..len) into out
+ *
+ * Groups of up to 8 items follow a flag byte (bit set = literal byte, LSB first). A match is two bytes:
+ * offset - 1 in 12 bits, then length - 3 in 4 bits.
+ *
+ * @return size_t Compressed size (at most CLI_LZ_OUT_MAX)
+ */
+static size_t cli_lz_compress(cli_lz_stream_t *s, size_t len, uint8_t *out)
+{
+  const uint8_t *in = s->in;
+  size_t op = 0, flag_pos = 0;
+  int bit = 8;
+
+  memset(s->head, 0, sizeof(s->head));
+
+  for (size_t i = 0; i < len;)
+  {
+    if (bit == 8)
+    {
+      flag_pos = op++;
+      out[flag_pos] = 0;
+      bit = 0;
+    }
+
+    size_t best_len = 0, best_off = 0;
+    if (i + CLI_LZ_MIN_MATCH <= len)
+    {
+      size_t max = (len - i < CLI_LZ_MAX_MATCH) ? len - i : CLI_LZ_MAX_MATCH;
+      uint16_t cand = s->head[cli_lz_hash(&in[i])];
+      for (int chain = 0; cand != 0 && chain < CLI_LZ_MAX_CHAIN; chain++)
+      {
+        size_t p = cand - 1;
+        size_t l = 0;
+        while (l < max && in[p + l] == in[i + l]) l++;
+        if (l > best_len)
+        {
+          best_len = l;
+          best_off = i - p;
+          if (l == max)
+            break;
+        }
+        cand = s->prev[p];
+      }
+    }
+
+    if (best_len >= CLI_LZ_MIN_MATCH)
+    {
+      out[op++] = (uint8_t)(best_off - 1);
+      out[op++] = (uint8_t)(((best_off - 1) >> 8) << 4 | (best_len - CLI_LZ_MIN_MATCH));
+      for (size_t k = 0; k < best_len; k++) cli_lz_insert(s, i + k, len);
+      i += best_len;
+    }
+    else
+    {
+      out[flag_pos] |= 1 << bit;
+      out[op++] = in[i];
+      cli_lz_insert(s, i, len);
+      i++;
+    }
+    bit++;
+  }
+
+  return op;
+}
+
+/* ========================================================================== */
+/*                              FRAMING                                       */
+/* ========================================================================== */
+
+static void cli_lz_emit(cli_lz_stream_t *s, uint8_t type)
+{
+  uint8_t *f = s->frame;
+  uint8_t *data = &f[CLI_LZ_FRAME_HDR_SIZE];
+  size_t raw_len = (type == 'E') ? 0 : s->in_len;
+  size_t data_len = 0;
+
+  if (type != 'E')
+  {
+    data_len = cli_lz_compress(s, raw_len, data);
+    if (data_len >= raw_len)
+    {
+      type = 'R';
+      data_len = raw_len;
+      memcpy(data, s->in, raw_len);
+    }
+  }
+
+  uint32_t crc = esp_rom_crc32_le(0, s->in, raw_len);
+  f[0] = CLI_LZ_FRAME_ESC;
+  f[1] = CLI_LZ_FRAME_MAGIC;
+  f[2] = type;
+  f[3] = raw_len & 0xFF;
+  f[4] = raw_len >> 8;
+  f[5] = data_len & 0xFF;
+  f[6] = data_len >> 8;
+  for (int i = 0; i < 4; i++) data[data_len + i] = (crc >> (8 * i)) & 0xFF;
+
+  size_t frame_len = CLI_LZ_FRAME_HDR_SIZE + data_len + CLI_LZ_FRAME_CRC_SIZE;
+  fwrite(f, 1, frame_len, s->out);
+  fflush(s->out);
+
+  s->out_total += frame_len;
+  s->in_len = 0;
+}
+
+static ssize_t cli_lz_write(void *cookie, const char *buf, size_t size)
+{
+  cli_lz_stream_t *s = cookie;
+
+  for (size_t done = 0; done < size;)
+  {
+    size_t n = CLI_COMPRESS_BLOCK_SIZE - s->in_len;
+    if (n > size - done)
+      n = size - done;
+    memcpy(&s->in[s->in_len], buf + done, n);
+    s->in_len += n;
+    done += n;
+
+    if (s->in_len == CLI_COMPRESS_BLOCK_SIZE)
+      cli_lz_emit(s, 'B');
+  }
+
+  s->raw_total += size;
+  return size;
+}
+
+static int cli_lz_close(void *cookie)
+{
+  cli_lz_stream_t *s = cookie;
+
+  if (s->in_len > 0)
+    cli_lz_emit(s, 'B');
+  cli_lz_emit(s, 'E');
+
+  return 0;
+}
+
+/* ========================================================================== */
+/*                               COMMAND                                      */
+/* ========================================================================== */
+
+static int compress_cmd(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    printf("Usage: compress <command> [args...]\n");
+    return 1;
+  }
+  if (strcmp(argv[1], argv[0]) == 0)
+  {
+    printf("ERROR: compress cannot be nested\n");
+    return 1;
+  }
+
+  cli_lz_stream_t *s = calloc(1, sizeof(cli_lz_stream_t));
+  if (s == NULL)
+  {
+    ESP_LOGE(TAG, "No memory for the compression buffers (%u bytes)", (unsigned)sizeof(cli_lz_stream_t));
+    return 1;
+  }
+
+  const cookie_io_functions_t io = {.write = cli_lz_write, .close = cli_lz_close};
+  FILE *zout = fopencookie(s, "w", io);
+  if (zout == NULL)
+  {
+    free(s);
+    return 1;
+  }
+  /* Let the stream hand whole chunks to cli_lz_write() instead of line by line */
+  setvbuf(zout, NULL, _IOFBF, 256);
+
+  fflush(stdout);
+  cli_set_binary_mode(true);
+
+  /* stdout is per task, so only output of this command (including its log lines) is redirected */
+  s->out = stdout;
+  stdout = zout;
+
+  int ret = 0;
+  esp_err_t err = cli_exec_nested(argc - 1, &argv[1], &ret);
+
+  stdout = s->out;
+  fclose(zout);
+  cli_set_binary_mode(false);
+
+  if (err == ESP_ERR_NOT_FOUND)
+    printf("Unrecognized command\n");
+  else if (err != ESP_OK)
+    printf("Command failed: %s\n", esp_err_to_name(err));
+  else
+    ESP_LOGD(TAG, "%u bytes compressed to %u", (unsigned)s->raw_total, (unsigned)s->out_total);
+
+  free(s);
+
+  return (err == ESP_OK) ? ret : 1;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+esp_err_t cli_compress_init(void)
+{
+  const esp_console_cmd_t cmd = {.command = "compress",
+                                 .help = "Run a command with its output compressed (LZSS, CRC-checked frames). "
+                                         "Decode with tools/cli_lz.py.\n"
+                                         "Example: compress cat history.txt",
+                                 .hint = "<command> [args...]",
+                                 .func = &compress_cmd,
+                                 .argtable = NULL};
+
+  return esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,182 @@
+/**
+ * @file cli-help.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Interned help text: command and argument descriptions kept in one LZSS-compressed table in flash.
+ *
+ * tools/cli_helpgen.py turns a text file of "NAME text" entries into the table and a header of references. Equal
+ * texts are stored once. The table is packed in blocks of whole strings (at most 4096 bytes, the LZSS window), each
+ * compressed on its own in the 'compress' format, or stored when that does not help. A reference is a short string
+ * (CLI_HELP_REF_MARK, then the decimal index) used in place of the text in cli_command_t, cli_arg_t and
+ * cli_lazy_command_t descriptions.
+ *
+ * Descriptions are only read by 'help'. While it runs (cli_exec_line()), references are resolved into a scratch
+ * buffer: a block is decompressed the first time one of its strings is needed, so "help <command>" decodes only the
+ * blocks of that command's texts. The buffer is freed when 'help' returns.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <esp_log.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli-internal.h"
+
+static const char *TAG = "cli-help";
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+#define CLI_HELP_MAX_BLOCKS 64 /**< Blocks tracked by the decoded bitmap (256 KB of text at the largest block size) */
+
+/** Resolution of a reference that cannot be decoded */
+#define CLI_HELP_UNAVAILABLE "(help text not available)"
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Decompressed view of the table while 'help' runs
+ */
+typedef struct
+{
+  const cli_help_table_t *table; /**< Installed table, NULL if none */
+  char *scratch;                 /**< Decompressed table, allocated on the first reference */
+  uint64_t decoded;              /**< Blocks already decompressed into scratch (bit per block) */
+} cli_help_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_help_t s_help = {0};
+
+/* ========================================================================== */
+/*                              LZSS DECODER                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Decompress one block (format of cli_lz_compress() in cli-compress.c)
+ *
+ * @return false if the data is corrupted
+ */
+static bool cli_help_lz_decode(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len)
+{
+  size_t ip = 0, op = 0;
+
+  while (ip < in_len && op < out_len)
+  {
+    uint8_t flags = in[ip++];
+    for (int bit = 0; bit < 8 && ip < in_len && op < out_len; bit++)
+    {
+      if (flags & (1 << bit))
+      {
+        out[op++] = in[ip++];
+        continue;
+      }
+
+      if (ip + 2 > in_len)
+        return false;
+      size_t offset = (in[ip] | (in[ip + 1] >> 4) << 8) + 1;
+      size_t len = (in[ip + 1] & 0x0F) + 3;
+      ip += 2;
+      if (offset > op || len > out_len - op)
+        return false;
+      for (size_t k = 0; k < len; k++, op++) out[op] = out[op - offset];
+    }
+  }
+
+  return op == out_len;
+}
+
+/**
+ * @brief Make sure block b is decompressed into the scratch buffer
+ */
+static bool cli_help_decode_block(uint16_t b)
+{
+  if (s_help.decoded & (1ULL << b))
+    return true;
+
+  const cli_help_table_t *t = s_help.table;
+  const uint8_t *in = &t->data[t->block_pos[b]];
+  size_t in_len = t->block_pos[b + 1] - t->block_pos[b];
+  uint8_t *out = (uint8_t *)&s_help.scratch[t->block_raw[b]];
+  size_t out_len = t->block_raw[b + 1] - t->block_raw[b];
+
+  /* The generator stores a block as is when compressing it does not make it smaller */
+  if (in_len == out_len)
+    memcpy(out, in, out_len);
+  else if (!cli_help_lz_decode(in, in_len, out, out_len))
+  {
+    ESP_LOGE(TAG, "Help table block %u is corrupted", b);
+    return false;
+  }
+
+  s_help.decoded |= 1ULL << b;
+  return true;
+}
+
+/* ========================================================================== */
+/*                           PUBLIC INTERFACE                                 */
+/* ========================================================================== */
+
+esp_err_t cli_help_set_table(const cli_help_table_t *table)
+{
+  if (table != NULL && (table->block_count > CLI_HELP_MAX_BLOCKS || table->str_count == 0))
+    return ESP_ERR_INVALID_ARG;
+
+  cli_help_release();
+  s_help.table = table;
+
+  return ESP_OK;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+bool cli_help_is_ref(const char *text)
+{
+  return text != NULL && text[0] == CLI_HELP_REF_MARK[0];
+}
+
+const char *cli_help_resolve(const char *text)
+{
+  if (!cli_help_is_ref(text))
+    return text;
+
+  const cli_help_table_t *t = s_help.table;
+  char *end;
+  unsigned long id = strtoul(text + 1, &end, 10);
+  if (t == NULL || *end != '\0' || id >= t->str_count)
+    return CLI_HELP_UNAVAILABLE;
+
+  if (s_help.scratch == NULL)
+  {
+    s_help.scratch = malloc(t->block_raw[t->block_count]);
+    if (s_help.scratch == NULL)
+      return CLI_HELP_UNAVAILABLE;
+    s_help.decoded = 0;
+  }
+
+  /* Strings never straddle blocks: find the block holding this one */
+  uint32_t pos = t->str_raw[id];
+  uint16_t b = 0;
+  while (b + 1 < t->block_count && t->block_raw[b + 1] <= pos) b++;
+
+  return cli_help_decode_block(b) ? &s_help.scratch[pos] : CLI_HELP_UNAVAILABLE;
+}
+
+void cli_help_release(void)
+{
+  free(s_help.scratch);
+  s_help.scratch = NULL;
+  s_help.decoded = 0;
+}
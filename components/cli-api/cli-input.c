@@ -0,0 +1,173 @@
+/**
+ * @file cli-input.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Batched console input: the line editor is fed from a local buffer filled straight from the driver.
+ *
+ * linenoise asks for one byte per read() call, and with stdin unbuffered each of those is a full VFS and driver
+ * round trip. This layer installs the linenoise read function: when its buffer is empty it blocks in the UART or
+ * USB Serial/JTAG driver for the first byte, then takes everything else already waiting in the driver's ring
+ * (up to CLI_INPUT_BUFFER_SIZE) in the same call, without a timeout. Keys typed by hand still cost one driver call
+ * each; a pasted or scripted burst costs one per buffer.
+ *
+ * The buffer keeps the bytes as received. The VFS conversion of line endings (CR to LF, see cli_init_peripheral()) is
+ * applied when bytes are handed to linenoise, since the VFS is bypassed. USB CDC has no driver API and keeps using
+ * read().
+ *
+ * Bytes read ahead belong to the console: a command that reads stdin itself (binary transfers) must first take them
+ * with cli_input_read().
+ *
+ * Input batches taken from the driver are what 'record' stores, and a running 'replay' supplies the batches instead
+ * of the driver (cli-record.c).
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <linenoise/linenoise.h>
+#include <sdkconfig.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cli-internal.h"
+
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+#include <driver/uart.h>
+#elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+#include <driver/usb_serial_jtag.h>
+#endif
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Bytes taken from the driver and not yet consumed
+ */
+typedef struct
+{
+  uint8_t buf[CLI_INPUT_BUFFER_SIZE]; /**< Read-ahead buffer */
+  size_t pos;                         /**< Next byte to hand out */
+  size_t len;                         /**< Valid bytes in buf */
+} cli_input_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_input_t s_input = {0};
+
+/* ========================================================================== */
+/*                              DRIVER READS                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Wait up to wait ticks for a byte, then take whatever else the driver already holds
+ *
+ * @return Bytes read into buf, 0 on timeout, < 0 on error
+ */
+static ssize_t cli_input_fill(int fd, uint8_t *buf, size_t size, TickType_t wait)
+{
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+  int n = uart_read_bytes(CONFIG_ESP_CONSOLE_UART_NUM, buf, 1, wait);
+  if (n == 1 && size > 1)
+  {
+    int more = uart_read_bytes(CONFIG_ESP_CONSOLE_UART_NUM, buf + 1, size - 1, 0);
+    if (more > 0)
+      n += more;
+  }
+#elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+  int n = usb_serial_jtag_read_bytes(buf, 1, wait);
+  if (n == 1 && size > 1)
+  {
+    int more = usb_serial_jtag_read_bytes(buf + 1, size - 1, 0);
+    if (more > 0)
+      n += more;
+  }
+#else
+  /* No driver API to wait with a timeout: only block forever, or sleep */
+  if (wait != portMAX_DELAY)
+  {
+    vTaskDelay(wait);
+    return 0;
+  }
+  int n = read(fd, buf, size);
+#endif
+
+  return n;
+}
+
+/**
+ * @brief linenoise read function: hand out buffered bytes, refill from the driver when empty
+ *
+ * Console input is also where the power and trace hooks see activity.
+ */
+static ssize_t cli_input_read_fn(int fd, void *buf, size_t count)
+{
+  if (s_input.pos == s_input.len)
+  {
+    ssize_t n = cli_record_replay(s_input.buf, sizeof(s_input.buf));
+    if (n == 0)
+    {
+      n = cli_input_fill(fd, s_input.buf, sizeof(s_input.buf), portMAX_DELAY);
+      if (n <= 0)
+        return n;
+      cli_record_input(s_input.buf, n);
+    }
+    s_input.pos = 0;
+    s_input.len = n;
+    cli_power_input();
+  }
+
+  size_t n = s_input.len - s_input.pos;
+  if (n > count)
+    n = count;
+  uint8_t *out = buf;
+  for (size_t i = 0; i < n; i++)
+  {
+    uint8_t c = s_input.buf[s_input.pos++];
+    cli_trace(CLI_TRACE_RX, c);
+    /* Same as the VFS with ESP_LINE_ENDINGS_CR: the terminal's CR is delivered as LF */
+    out[i] = (c == '\r') ? '\n' : c;
+  }
+
+  return n;
+}
+
+/* ========================================================================== */
+/*                           PUBLIC INTERFACE                                 */
+/* ========================================================================== */
+
+size_t cli_input_read(void *buf, size_t size)
+{
+  size_t n = s_input.len - s_input.pos;
+  if (n > size)
+    n = size;
+  memcpy(buf, &s_input.buf[s_input.pos], n);
+  s_input.pos += n;
+
+  return n;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+size_t cli_input_wait(uint8_t *buf, size_t size, uint32_t ms)
+{
+  ssize_t n = cli_input_fill(fileno(stdin), buf, size, pdMS_TO_TICKS(ms));
+  return (n > 0) ? n : 0;
+}
+
+void cli_input_init(void)
+{
+  s_input.pos = 0;
+  s_input.len = 0;
+  linenoiseSetReadFunction(cli_input_read_fn);
+}
@@ -0,0 +1,377 @@
+/**
+ * @file cli-internal.h
+ * @brief Internal interfaces shared between the cli-api translation units
+ *
+ * Not part of the public API. Everything here may change between releases.
+ *
+ * @author Pedro Luis Dionisio Fraga
+ * @date 2026
+ */
+
+#ifndef CLI_INTERNAL_H
+#define CLI_INTERNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "cli-api.h"
+#include "esp_err.h"
+
+/* ========================================================================== */
+/*                              SESSIONS                                      */
+/* ========================================================================== */
+
+#define CLI_SESSION_CONSOLE   0    /**< Local console (UART / USB) */
+#define CLI_SESSION_TCP       1    /**< First TCP session, slot i is CLI_SESSION_TCP + i (cli-tcp.c) */
+#define CLI_SESSION_SCHEDULER 0xFF /**< Internal command scheduler */
+
+/* ========================================================================== */
+/*                          DISPATCH (cli-api.c)                              */
+/* ========================================================================== */
+
+/**
+ * @brief Take the command execution lock (recursive)
+ *
+ * Every command runs with this lock held, so the shared argtables and any state touched by command callbacks are
+ * never accessed by two tasks at once.
+ */
+void cli_lock(void);
+
+/**
+ * @brief Release the command execution lock
+ */
+void cli_unlock(void);
+
+/**
+ * @brief Execute a full command line through esp_console
+ *
+ * @param session Session the line comes from (CLI_SESSION_*)
+ * @param line Command line
+ * @param[out] ret Return code of the command callback
+ * @return esp_err_t Same as esp_console_run()
+ */
+esp_err_t cli_exec_line(uint8_t session, const char *line, int *ret);
+
+/**
+ * @brief Execute an already tokenized command, skipping esp_console tokenization and lookup
+ *
+ * Only commands registered through cli_register_command() can be executed this way.
+ *
+ * @param session Session the command comes from (CLI_SESSION_*)
+ * @param argc Number of tokens
+ * @param argv Tokens (argv[0] is the command name)
+ * @param[out] ret Return code of the command callback
+ * @return esp_err_t
+ *         - ESP_OK: Command executed, result in ret
+ *         - ESP_ERR_NOT_FOUND: Not a cli-api command, caller must fall back to cli_exec_line()
+ */
+esp_err_t cli_exec_argv(uint8_t session, int argc, char **argv, int *ret);
+
+/**
+ * @brief Check the arguments of an already tokenized command without running it
+ *
+ * Parse errors are printed to stderr.
+ *
+ * @return esp_err_t
+ *         - ESP_OK: Arguments are valid
+ *         - ESP_ERR_INVALID_ARG: Arguments do not parse
+ *         - ESP_ERR_NOT_FOUND: Not a cli-api command, arguments cannot be checked in advance
+ */
+esp_err_t cli_check_argv(int argc, char **argv);
+
+/**
+ * @brief Execute a command from inside another command's callback, in the caller's session
+ *
+ * Used by prefix commands ("compress <command...>"). cli-api commands run from their tokens, others are re-joined
+ * and go through esp_console.
+ *
+ * @return esp_err_t Same as cli_exec_line(), or ESP_ERR_INVALID_SIZE if the re-joined line is too long
+ */
+esp_err_t cli_exec_nested(int argc, char **argv, int *ret);
+
+/**
+ * @brief Session of the command currently being executed (CLI_SESSION_*)
+ */
+uint8_t cli_current_session(void);
+
+/**
+ * @brief Name of the index-th command registered through cli_register_command(), NULL past the last one
+ */
+const char *cli_command_name(uint16_t index);
+
+/**
+ * @brief Re-join argv tokens into a command line, quoting tokens that contain spaces
+ *
+ * @return false if the line does not fit in size bytes
+ */
+bool cli_join_argv(char *out, size_t size, int argc, const char *const *argv);
+
+/* ========================================================================== */
+/*                           HELP TEXT (cli-help.c)                           */
+/* ========================================================================== */
+
+/**
+ * @brief true if text is an interned help reference (CLI_HELP_REF_MARK...)
+ */
+bool cli_help_is_ref(const char *text);
+
+/**
+ * @brief Text of an interned reference, decompressed into the scratch buffer; other texts are returned as is
+ *
+ * The pointer stays valid until cli_help_release().
+ */
+const char *cli_help_resolve(const char *text);
+
+/**
+ * @brief Free the scratch buffer of resolved texts
+ */
+void cli_help_release(void);
+
+/* ========================================================================== */
+/*                            INPUT (cli-input.c)                             */
+/* ========================================================================== */
+
+/**
+ * @brief Feed linenoise from the batched input buffer (install its read function)
+ */
+void cli_input_init(void);
+
+/**
+ * @brief Wait up to ms for console input, without the line editor
+ *
+ * @return Bytes read into buf, 0 if nothing arrived
+ */
+size_t cli_input_wait(uint8_t *buf, size_t size, uint32_t ms);
+
+/* ========================================================================== */
+/*                          RECORDING (cli-record.c)                          */
+/* ========================================================================== */
+
+/**
+ * @brief Register the 'record' and 'replay' commands
+ */
+esp_err_t cli_record_init(void);
+
+/**
+ * @brief Input batch taken from the driver: append it to the recording, if any
+ */
+void cli_record_input(const uint8_t *buf, size_t len);
+
+/**
+ * @brief Next batch of a running replay, paced as recorded
+ *
+ * @return Bytes written to buf, 0 if no replay is running or it ended
+ */
+ssize_t cli_record_replay(uint8_t *buf, size_t size);
+
+/**
+ * @brief A prompt is about to be shown: mark the line boundary, report a finished replay
+ */
+void cli_record_prompt(void);
+
+/* ========================================================================== */
+/*                         SCHEDULER (cli-schedule.c)                         */
+/* ========================================================================== */
+
+/**
+ * @brief Load persisted entries, register the schedule_* commands and start the scheduler
+ */
+esp_err_t cli_schedule_init(void);
+
+/**
+ * @brief Stop the scheduler timer and task (entries stay persisted)
+ */
+void cli_schedule_deinit(void);
+
+/* ========================================================================== */
+/*                            AUDIT (cli-audit.c)                             */
+/* ========================================================================== */
+
+/**
+ * @brief Validate the RTC audit ring, bump the boot counter and register the 'audit' command
+ */
+esp_err_t cli_audit_init(void);
+
+/**
+ * @brief Record the start of a command line
+ *
+ * @return int Slot to pass to cli_audit_end(), -1 if auditing is disabled
+ */
+int cli_audit_begin(uint8_t session, const char *line);
+
+/**
+ * @brief Same as cli_audit_begin() for an already tokenized command
+ */
+int cli_audit_begin_argv(uint8_t session, int argc, char **argv);
+
+/**
+ * @brief Complete a record with the outcome of the command
+ *
+ * @param slot Value returned by cli_audit_begin()
+ * @param err Dispatch result
+ * @param ret Callback return code (valid if err == ESP_OK)
+ * @param duration_us Execution time
+ */
+void cli_audit_end(int slot, esp_err_t err, int ret, uint32_t duration_us);
+
+/* ========================================================================== */
+/*                         COMPRESSION (cli-compress.c)                       */
+/* ========================================================================== */
+
+/**
+ * @brief Register the 'compress' prefix command
+ */
+esp_err_t cli_compress_init(void);
+
+/* ========================================================================== */
+/*                            TIMING (cli-time.c)                             */
+/* ========================================================================== */
+
+/**
+ * @brief Register the 'time' prefix command
+ */
+esp_err_t cli_time_init(void);
+
+/* ========================================================================== */
+/*                           REDRAW (cli-redraw.c)                            */
+/* ========================================================================== */
+
+/**
+ * @brief Create the refresh filter stream and register 'redraw_stats'
+ *
+ * @return ESP_ERR_NOT_SUPPORTED in dumb terminal mode (linenoise does not refresh)
+ */
+esp_err_t cli_redraw_init(void);
+
+/**
+ * @brief Install the filter as stdout while linenoise() edits a line (no-op unless enabled)
+ */
+void cli_redraw_begin(void);
+
+/**
+ * @brief Restore stdout after linenoise() returned
+ */
+void cli_redraw_end(void);
+
+/* ========================================================================== */
+/*                          POWER (cli-power.c)                               */
+/* ========================================================================== */
+
+/**
+ * @brief Enable automatic light sleep with UART wakeup and register 'idle_stats'
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if power management or tickless idle are disabled, or the console is not a UART
+ */
+esp_err_t cli_power_init(void);
+
+/**
+ * @brief Hold the CPU at maximum frequency while commands run and block light sleep while keys arrive
+ *
+ * @return ESP_ERR_NOT_SUPPORTED without CONFIG_PM_ENABLE
+ */
+esp_err_t cli_power_boost_init(void);
+
+/**
+ * @brief Console input received: keep light sleep blocked for a while
+ */
+void cli_power_input(void);
+
+/**
+ * @brief Line complete: boost the CPU and keep the chip awake while the command runs
+ */
+void cli_power_command_begin(void);
+
+/**
+ * @brief Output flushed: drop the boost, allow light sleep again after the awake delay
+ */
+void cli_power_command_end(void);
+
+/* ========================================================================== */
+/*                           PROMPT (cli-prompt.c)                            */
+/* ========================================================================== */
+
+/**
+ * @brief Register the built-in prompt tokens
+ */
+void cli_prompt_init(void);
+
+/**
+ * @brief Prompt to display: the template with its tokens expanded, or tmpl itself if it has none
+ */
+const char *cli_prompt_render(const char *tmpl);
+
+/**
+ * @brief Record the outcome of a console command for the {rc} token
+ */
+void cli_prompt_set_result(esp_err_t err, int ret);
+
+/* ========================================================================== */
+/*                          METRICS (cli-metrics.c)                           */
+/* ========================================================================== */
+
+/**
+ * @brief Register the built-in metric families and the 'metrics' command
+ */
+esp_err_t cli_metrics_init(void);
+
+/**
+ * @brief Account one executed command (no-op unless metrics are enabled)
+ *
+ * @param line Command line or command name, the first token is used
+ * @param found false if no command of that name is registered
+ * @param ret Callback return code
+ * @param duration_us Execution time
+ */
+void cli_metrics_command(const char *line, bool found, int ret, uint32_t duration_us);
+
+/* ========================================================================== */
+/*                          PROFILER (cli-profile.c)                          */
+/* ========================================================================== */
+
+/**
+ * @brief Register the 'profile' sampling profiler
+ */
+esp_err_t cli_profile_init(void);
+
+/* ========================================================================== */
+/*                            TRACE (cli-trace.c)                             */
+/* ========================================================================== */
+
+/**
+ * @brief Console pipeline stages recorded by cli_trace()
+ */
+typedef enum
+{
+  CLI_TRACE_RX,        /**< Byte received by linenoise (arg: byte) */
+  CLI_TRACE_LINE,      /**< Line complete (arg: length) */
+  CLI_TRACE_EXEC,      /**< Dispatch started (arg: line length, or argc for tokenized commands) */
+  CLI_TRACE_TOKENIZED, /**< Tokens available (esp_console has split the line and found the command) */
+  CLI_TRACE_LOOKUP,    /**< cli-api command found (arg: command index, 0xFFFF if not found) */
+  CLI_TRACE_PARSED,    /**< Arguments parsed (arg: 0 = valid, 1 = parse errors) */
+  CLI_TRACE_CB_START,  /**< Command callback entered */
+  CLI_TRACE_CB_END,    /**< Command callback returned (arg: return code) */
+  CLI_TRACE_DONE,      /**< Dispatch finished (arg: return code, 0xFFFF if the command does not exist) */
+  CLI_TRACE_FLUSHED,   /**< Command output sent */
+  CLI_TRACE_EVENT_MAX,
+} cli_trace_event_t;
+
+/** DONE / LOOKUP argument of a command that does not exist */
+#define CLI_TRACE_NOT_FOUND 0xFFFF
+
+/**
+ * @brief Allocate the per-core rings and register 'trace'
+ */
+esp_err_t cli_trace_init(void);
+
+/**
+ * @brief Record one event in the calling core's ring (no-op unless tracing is enabled and on)
+ */
+void cli_trace(cli_trace_event_t event, uint16_t arg);
+
+/**
+ * @brief Flush stdout; while tracing, wait until it is sent and record CLI_TRACE_FLUSHED
+ */
+void cli_trace_flush(void);
+
+#endif /* CLI_INTERNAL_H */
@@ -0,0 +1,415 @@
+/**
+ * @file cli-metrics.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Registry of metric callbacks rendered by the 'metrics' command in OpenMetrics text format.
+ *
+ * Every family (name, type, help) is registered once with a callback that writes its samples when scraped, so values
+ * are read at scrape time and nothing is sampled in the background. Built-in families cover command execution, heap
+ * per capability, tasks and NVS; other components add their own with cli_metrics_register().
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <argtable3/argtable3.h>
+#include <esp_console.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+#include <nvs.h>
+#include <sdkconfig.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli-internal.h"
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && CONFIG_FREERTOS_RUN_TIME_STATS_USING_CPU_CLK
+#include <esp_rom_sys.h>
+#endif
+
+static const char *TAG = "cli-metrics";
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+/** Command name bytes kept per statistics row (longer names are truncated) */
+#define CLI_METRICS_NAME_LEN 24
+
+/** Label buffer of the built-in families: task names are at most configMAX_TASK_NAME_LEN, escaped */
+#define CLI_METRICS_LABEL_LEN 96
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief One registered metric family
+ */
+typedef struct
+{
+  const char *name;       /**< Family name, without the "_total" suffix of counters */
+  const char *help;       /**< HELP text */
+  cli_metric_type_t type; /**< Counter or gauge */
+  cli_metric_cb_t cb;     /**< Writes the samples */
+  void *arg;              /**< Passed to cb */
+} cli_metric_family_t;
+
+/**
+ * @brief Output state handed to the callbacks
+ */
+struct cli_metrics_writer
+{
+  FILE *out;                         /**< Destination stream */
+  const cli_metric_family_t *family; /**< Family being rendered */
+};
+
+/**
+ * @brief Execution statistics of one command
+ */
+typedef struct
+{
+  char name[CLI_METRICS_NAME_LEN]; /**< Command name, empty if the row is free */
+  uint32_t runs;                   /**< Executions */
+  uint32_t errors;                 /**< Executions that returned non-zero */
+  uint64_t time_us;                /**< Total execution time */
+} cli_metrics_cmd_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_metric_family_t s_families[CLI_METRICS_MAX_FAMILIES];
+static size_t s_family_count = 0;
+
+static cli_metrics_cmd_t s_cmds[CLI_METRICS_MAX_COMMANDS];
+static uint32_t s_unknown = 0; /**< Lines whose command was not found */
+static bool s_metrics_enabled = false;
+
+static struct
+{
+  struct arg_str *prefix;
+  struct arg_end *end;
+} metrics_args;
+
+/* ========================================================================== */
+/*                              SAMPLE OUTPUT                                 */
+/* ========================================================================== */
+
+/**
+ * @brief Escape a label value (backslash, double quote, newline) into out
+ */
+static void cli_metrics_escape(char *out, size_t size, const char *value)
+{
+  size_t pos = 0;
+  for (const char *c = value; *c && pos + 2 < size; c++)
+  {
+    if (*c == '\\' || *c == '"')
+      out[pos++] = '\\';
+    else if (*c == '\n')
+    {
+      out[pos++] = '\\';
+      out[pos++] = 'n';
+      continue;
+    }
+    out[pos++] = *c;
+  }
+  out[pos] = '\0';
+}
+
+void cli_metrics_sample(cli_metrics_writer_t *w, const char *labels, double value)
+{
+  const char *suffix = (w->family->type == CLI_METRIC_COUNTER) ? "_total" : "";
+  if (labels != NULL && labels[0] != '\0')
+    fprintf(w->out, "%s%s{%s} %.15g\n", w->family->name, suffix, labels, value);
+  else
+    fprintf(w->out, "%s%s %.15g\n", w->family->name, suffix, value);
+}
+
+/* ========================================================================== */
+/*                            BUILT-IN FAMILIES                               */
+/* ========================================================================== */
+
+static void cli_metrics_cmd_runs(cli_metrics_writer_t *w, void *arg)
+{
+  char labels[CLI_METRICS_LABEL_LEN];
+  for (size_t i = 0; i < CLI_METRICS_MAX_COMMANDS && s_cmds[i].name[0] != '\0'; i++)
+  {
+    char name[CLI_METRICS_NAME_LEN * 2];
+    cli_metrics_escape(name, sizeof(name), s_cmds[i].name);
+
+    snprintf(labels, sizeof(labels), "command=\"%s\",result=\"ok\"", name);
+    cli_metrics_sample(w, labels, s_cmds[i].runs - s_cmds[i].errors);
+    snprintf(labels, sizeof(labels), "command=\"%s\",result=\"error\"", name);
+    cli_metrics_sample(w, labels, s_cmds[i].errors);
+  }
+}
+
+static void cli_metrics_cmd_time(cli_metrics_writer_t *w, void *arg)
+{
+  char labels[CLI_METRICS_LABEL_LEN];
+  for (size_t i = 0; i < CLI_METRICS_MAX_COMMANDS && s_cmds[i].name[0] != '\0'; i++)
+  {
+    char name[CLI_METRICS_NAME_LEN * 2];
+    cli_metrics_escape(name, sizeof(name), s_cmds[i].name);
+    snprintf(labels, sizeof(labels), "command=\"%s\"", name);
+    cli_metrics_sample(w, labels, s_cmds[i].time_us / 1e6);
+  }
+}
+
+static void cli_metrics_cmd_unknown(cli_metrics_writer_t *w, void *arg)
+{
+  cli_metrics_sample(w, NULL, s_unknown);
+}
+
+/** Heap capabilities reported by the heap families; empty pools (e.g. no PSRAM) are skipped */
+static const struct
+{
+  uint32_t caps;
+  const char *label;
+} s_heap_caps[] = {
+  {MALLOC_CAP_INTERNAL, "caps=\"internal\""},
+  {MALLOC_CAP_DMA, "caps=\"dma\""},
+  {MALLOC_CAP_SPIRAM, "caps=\"spiram\""},
+  {MALLOC_CAP_EXEC, "caps=\"exec\""},
+};
+
+/**
+ * @brief Heap families share this callback; arg selects the multi_heap_info_t field
+ */
+static void cli_metrics_heap(cli_metrics_writer_t *w, void *arg)
+{
+  size_t field = (size_t)arg;
+  for (size_t i = 0; i < sizeof(s_heap_caps) / sizeof(s_heap_caps[0]); i++)
+  {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, s_heap_caps[i].caps);
+    if (info.total_free_bytes + info.total_allocated_bytes == 0)
+      continue;
+
+    size_t values[] = {
+      info.total_free_bytes,
+      info.minimum_free_bytes,
+      info.largest_free_block,
+      info.total_free_bytes + info.total_allocated_bytes,
+    };
+    cli_metrics_sample(w, s_heap_caps[i].label, values[field]);
+  }
+}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+
+/**
+ * @brief Task families share this callback; arg is 0 for free stack, 1 for CPU time
+ */
+static void cli_metrics_tasks(cli_metrics_writer_t *w, void *arg)
+{
+  UBaseType_t count = uxTaskGetNumberOfTasks() + 2; /* Room for tasks created meanwhile */
+  TaskStatus_t *tasks = malloc(count * sizeof(TaskStatus_t));
+  if (tasks == NULL)
+    return;
+
+  configRUN_TIME_COUNTER_TYPE total;
+  count = uxTaskGetSystemState(tasks, count, &total);
+
+  double tick_s = 0;
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && CONFIG_FREERTOS_RUN_TIME_STATS_USING_CPU_CLK
+  tick_s = 1.0 / (esp_rom_get_cpu_ticks_per_us() * 1e6);
+#elif CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  tick_s = 1e-6; /* esp_timer microseconds */
+#endif
+
+  char name[CLI_METRICS_LABEL_LEN / 2];
+  char labels[CLI_METRICS_LABEL_LEN];
+  for (UBaseType_t i = 0; i < count; i++)
+  {
+    cli_metrics_escape(name, sizeof(name), tasks[i].pcTaskName);
+    snprintf(labels, sizeof(labels), "task=\"%s\"", name);
+    if (arg == NULL)
+      cli_metrics_sample(w, labels, tasks[i].usStackHighWaterMark);
+    else if (tick_s > 0)
+      cli_metrics_sample(w, labels, tasks[i].ulRunTimeCounter * tick_s);
+  }
+
+  free(tasks);
+}
+
+#endif /* CONFIG_FREERTOS_USE_TRACE_FACILITY */
+
+static void cli_metrics_nvs(cli_metrics_writer_t *w, void *arg)
+{
+  nvs_stats_t stats;
+  if (nvs_get_stats(NULL, &stats) != ESP_OK)
+    return;
+
+  cli_metrics_sample(w, "state=\"used\"", stats.used_entries);
+  cli_metrics_sample(w, "state=\"free\"", stats.free_entries);
+}
+
+static void cli_metrics_nvs_namespaces(cli_metrics_writer_t *w, void *arg)
+{
+  nvs_stats_t stats;
+  if (nvs_get_stats(NULL, &stats) == ESP_OK)
+    cli_metrics_sample(w, NULL, stats.namespace_count);
+}
+
+/* ========================================================================== */
+/*                               COMMAND                                      */
+/* ========================================================================== */
+
+static int metrics(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&metrics_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, metrics_args.end, argv[0]);
+    return 1;
+  }
+
+  for (size_t i = 0; i < s_family_count; i++)
+  {
+    const cli_metric_family_t *f = &s_families[i];
+
+    bool selected = (metrics_args.prefix->count == 0);
+    for (int p = 0; p < metrics_args.prefix->count && !selected; p++)
+      selected = (strncmp(f->name, metrics_args.prefix->sval[p], strlen(metrics_args.prefix->sval[p])) == 0);
+    if (!selected)
+      continue;
+
+    printf("# TYPE %s %s\n", f->name, (f->type == CLI_METRIC_COUNTER) ? "counter" : "gauge");
+    if (f->help != NULL)
+      printf("# HELP %s %s\n", f->name, f->help);
+
+    cli_metrics_writer_t w = {.out = stdout, .family = f};
+    f->cb(&w, f->arg);
+  }
+  printf("# EOF\n");
+
+  return 0;
+}
+
+/* ========================================================================== */
+/*                          REGISTRATION INTERFACE                            */
+/* ========================================================================== */
+
+esp_err_t cli_metrics_register(
+  const char *name, cli_metric_type_t type, const char *help, cli_metric_cb_t cb, void *arg)
+{
+  if (name == NULL || cb == NULL)
+    return ESP_ERR_INVALID_ARG;
+
+  for (size_t i = 0; i < s_family_count; i++)
+  {
+    if (strcmp(s_families[i].name, name) == 0)
+      return ESP_ERR_INVALID_STATE;
+  }
+
+  if (s_family_count >= CLI_METRICS_MAX_FAMILIES)
+  {
+    ESP_LOGE(TAG, "Metric registry full (%d), '%s' not added", CLI_METRICS_MAX_FAMILIES, name);
+    return ESP_ERR_NO_MEM;
+  }
+
+  s_families[s_family_count++] = (cli_metric_family_t){
+    .name = name,
+    .help = help,
+    .type = type,
+    .cb = cb,
+    .arg = arg,
+  };
+
+  return ESP_OK;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+void cli_metrics_command(const char *line, bool found, int ret, uint32_t duration_us)
+{
+  if (!s_metrics_enabled)
+    return;
+
+  if (!found)
+  {
+    s_unknown++;
+    return;
+  }
+
+  /* First token of the line, the command name */
+  line += strspn(line, " \t");
+  size_t len = strcspn(line, " \t");
+  if (len >= CLI_METRICS_NAME_LEN)
+    len = CLI_METRICS_NAME_LEN - 1;
+
+  /* Rows are filled in order of first use; commands beyond the table are not counted */
+  for (size_t i = 0; i < CLI_METRICS_MAX_COMMANDS; i++)
+  {
+    cli_metrics_cmd_t *c = &s_cmds[i];
+    if (c->name[0] == '\0')
+    {
+      memcpy(c->name, line, len);
+      c->name[len] = '\0';
+    }
+    else if (strncmp(c->name, line, len) != 0 || c->name[len] != '\0')
+      continue;
+
+    c->runs++;
+    if (ret != 0)
+      c->errors++;
+    c->time_us += duration_us;
+    return;
+  }
+}
+
+esp_err_t cli_metrics_init(void)
+{
+  if (s_metrics_enabled)
+    return ESP_OK;
+
+  cli_metrics_register("cli_command_runs", CLI_METRIC_COUNTER, "Command executions", cli_metrics_cmd_runs, NULL);
+  cli_metrics_register(
+    "cli_command_seconds", CLI_METRIC_COUNTER, "Time spent executing commands", cli_metrics_cmd_time, NULL);
+  cli_metrics_register(
+    "cli_command_unknown", CLI_METRIC_COUNTER, "Lines naming no registered command", cli_metrics_cmd_unknown, NULL);
+
+  cli_metrics_register("heap_free_bytes", CLI_METRIC_GAUGE, "Free heap", cli_metrics_heap, (void *)0);
+  cli_metrics_register(
+    "heap_min_free_bytes", CLI_METRIC_GAUGE, "Lowest free heap since boot", cli_metrics_heap, (void *)1);
+  cli_metrics_register(
+    "heap_largest_free_block_bytes", CLI_METRIC_GAUGE, "Largest allocatable block", cli_metrics_heap, (void *)2);
+  cli_metrics_register("heap_size_bytes", CLI_METRIC_GAUGE, "Heap size", cli_metrics_heap, (void *)3);
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+  cli_metrics_register(
+    "task_stack_free_bytes", CLI_METRIC_GAUGE, "Lowest free stack since the task started", cli_metrics_tasks, NULL);
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  cli_metrics_register("task_cpu_seconds", CLI_METRIC_COUNTER, "CPU time used by the task", cli_metrics_tasks, (void *)1);
+#endif
+#endif
+
+  cli_metrics_register("nvs_entries", CLI_METRIC_GAUGE, "NVS entries of the default partition", cli_metrics_nvs, NULL);
+  cli_metrics_register("nvs_namespaces", CLI_METRIC_GAUGE, "NVS namespaces", cli_metrics_nvs_namespaces, NULL);
+
+  metrics_args.prefix = arg_strn(NULL, NULL, "<prefix>", 0, 8, "Only families whose name starts with a prefix");
+  metrics_args.end = arg_end(1);
+
+  const esp_console_cmd_t cmd = {.command = "metrics",
+                                 .help = "Print all registered metrics in OpenMetrics text format",
+                                 .hint = NULL,
+                                 .func = &metrics,
+                                 .argtable = &metrics_args};
+
+  esp_err_t err = esp_console_cmd_register(&cmd);
+  if (err == ESP_OK)
+    s_metrics_enabled = true;
+
+  return err;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file cli-output.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Output helpers shared by commands: hexdump formatting and binary-safe console mode.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <sdkconfig.h>
+#include <soc/soc_caps.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cli-internal.h"
+
+/* Includes for console peripherals */
+#include <driver/uart_vfs.h>
+#if SOC_USB_SERIAL_JTAG_SUPPORTED
+#include <driver/usb_serial_jtag_vfs.h>
+#endif
+#if CONFIG_ESP_CONSOLE_USB_CDC
+#include <esp_vfs_cdcacm.h>
+#endif
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+/** Bytes per hexdump line */
+#define CLI_HEXDUMP_WIDTH 16
+
+/** "aaaaaaaa  xx xx xx xx xx xx xx xx  xx xx xx xx xx xx xx xx  |................|\n" */
+#define CLI_HEXDUMP_LINE_LEN (8 + 2 + CLI_HEXDUMP_WIDTH * 3 + 1 + 2 + CLI_HEXDUMP_WIDTH + 2)
+
+static const char s_hex_digits[16] = "0123456789abcdef";
+
+/* ========================================================================== */
+/*                              HEXDUMP                                       */
+/* ========================================================================== */
+
+/**
+ * @brief Format one hexdump line without going through printf
+ *
+ * @return size_t Number of characters written to out
+ */
+static size_t cli_hexdump_line(char *out, uint32_t addr, const uint8_t *data, size_t len)
+{
+  char *p = out;
+
+  for (int shift = 28; shift >= 0; shift -= 4) *p++ = s_hex_digits[(addr >> shift) & 0xF];
+  *p++ = ' ';
+
+  for (size_t i = 0; i < CLI_HEXDUMP_WIDTH; i++)
+  {
+    if (i % 8 == 0)
+      *p++ = ' ';
+
+    if (i < len)
+    {
+      *p++ = s_hex_digits[data[i] >> 4];
+      *p++ = s_hex_digits[data[i] & 0xF];
+    }
+    else
+    {
+      *p++ = ' ';
+      *p++ = ' ';
+    }
+    *p++ = ' ';
+  }
+
+  *p++ = ' ';
+  *p++ = '|';
+  for (size_t i = 0; i < len; i++) *p++ = (data[i] >= 0x20 && data[i] < 0x7F) ? (char)data[i] : '.';
+  *p++ = '|';
+  *p++ = '\n';
+
+  return p - out;
+}
+
+void cli_hexdump(uint32_t addr, const void *data, size_t len)
+{
+  const uint8_t *bytes = data;
+  char line[CLI_HEXDUMP_LINE_LEN];
+
+  while (len > 0)
+  {
+    size_t chunk = (len < CLI_HEXDUMP_WIDTH) ? len : CLI_HEXDUMP_WIDTH;
+    fwrite(line, 1, cli_hexdump_line(line, addr, bytes, chunk), stdout);
+
+    addr += chunk;
+    bytes += chunk;
+    len -= chunk;
+  }
+}
+
+/* ========================================================================== */
+/*                              BINARY MODE                                   */
+/* ========================================================================== */
+
+void cli_set_binary_mode(bool enable)
+{
+  fflush(stdout);
+  fsync(fileno(stdout));
+
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+  uart_vfs_dev_port_set_rx_line_endings(CONFIG_ESP_CONSOLE_UART_NUM, enable ? ESP_LINE_ENDINGS_LF : ESP_LINE_ENDINGS_CR);
+  uart_vfs_dev_port_set_tx_line_endings(CONFIG_ESP_CONSOLE_UART_NUM, enable ? ESP_LINE_ENDINGS_LF : ESP_LINE_ENDINGS_CRLF);
+#elif defined(CONFIG_ESP_CONSOLE_USB_CDC)
+  esp_vfs_dev_cdcacm_set_rx_line_endings(enable ? ESP_LINE_ENDINGS_LF : ESP_LINE_ENDINGS_CR);
+  esp_vfs_dev_cdcacm_set_tx_line_endings(enable ? ESP_LINE_ENDINGS_LF : ESP_LINE_ENDINGS_CRLF);
+#elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+  usb_serial_jtag_vfs_set_rx_line_endings(enable ? ESP_LINE_ENDINGS_LF : ESP_LINE_ENDINGS_CR);
+  usb_serial_jtag_vfs_set_tx_line_endings(enable ? ESP_LINE_ENDINGS_LF : ESP_LINE_ENDINGS_CRLF);
+#endif
+}
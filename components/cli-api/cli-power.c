@@ -0,0 +1,437 @@
+/**
+ * @file cli-power.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Power management of the console: CPU boost while commands run, light sleep while the prompt is idle.
+ *
+ * Both features build on esp_pm locks and are independent of each other:
+ *
+ * CPU boost (CONFIG_PM_ENABLE): with dynamic frequency scaling the console would run at the minimum CPU frequency.
+ * An ESP_PM_CPU_FREQ_MAX lock is held from the moment a line is complete until its output has been flushed, and an
+ * ESP_PM_NO_LIGHT_SLEEP lock while keys are arriving (until CLI_INPUT_AWAKE_MS after the last one), so typing and
+ * commands are fast while the idle console keeps the DFS savings. The time spent boosted is accounted.
+ *
+ * Idle light sleep (ESP-IDF automatic light sleep with tickless idle): while linenoise() is blocked reading the UART
+ * nothing is ready to run, and the idle task puts the chip into light sleep. The same ESP_PM_NO_LIGHT_SLEEP lock is
+ * held while a command runs and for CLI_IDLE_SLEEP_DELAY_MS after the last command or key, so only a prompt nobody
+ * uses sleeps. The console UART wakes the chip (RX edge threshold, as the 'light_sleep' example command does). The
+ * character that wakes it is consumed by the wakeup logic; the light sleep exit callback immediately hands over to a
+ * small task that takes the lock again, so everything typed after the wake key is received. esp_pm restores the CPU
+ * clock on wakeup.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <argtable3/argtable3.h>
+#include <esp_console.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <inttypes.h>
+#include <sdkconfig.h>
+#include <stdio.h>
+
+#include "cli-internal.h"
+
+static const char *TAG = "cli-power";
+
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE && CONFIG_PM_LIGHT_SLEEP_CALLBACKS && \
+  (defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM))
+#define CLI_IDLE_SLEEP_SUPPORTED 1
+#else
+#define CLI_IDLE_SLEEP_SUPPORTED 0
+#endif
+
+#if CONFIG_PM_ENABLE
+
+#include <esp_attr.h>
+#include <esp_pm.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#if CLI_IDLE_SLEEP_SUPPORTED
+#include <driver/uart.h>
+#include <esp_sleep.h>
+#endif
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+#define CLI_POWER_WAKE_TASK_STACK 2048
+#define CLI_POWER_WAKE_TASK_PRIO  (configMAX_PRIORITIES - 2) /* Must run before the next key arrives */
+
+/* RX edges that wake the chip; a single CR or space is enough */
+#define CLI_POWER_UART_WAKE_EDGES 3
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Power locks and residency counters
+ */
+typedef struct
+{
+  esp_pm_lock_handle_t awake; /**< ESP_PM_NO_LIGHT_SLEEP, held while the console is active */
+  esp_pm_lock_handle_t boost; /**< ESP_PM_CPU_FREQ_MAX, held from line complete to output flushed */
+  bool held;                  /**< true while 'awake' is acquired */
+  bool running;               /**< true while a console command executes */
+  bool idle_sleep;            /**< true once automatic light sleep is enabled */
+  uint32_t awake_ms;          /**< How long 'awake' stays held after the last activity */
+  esp_timer_handle_t idle;    /**< Releases 'awake' awake_ms after the last activity */
+  TaskHandle_t wake_task;     /**< Takes 'awake' after a UART wakeup */
+  portMUX_TYPE lock;          /**< Protects held/running, shared with the timer and wake task */
+  int64_t since_us;           /**< Start of the statistics window */
+  uint64_t asleep_us;         /**< Total time in light sleep */
+  uint32_t sleeps;            /**< Number of light sleeps */
+  uint32_t uart_wakeups;      /**< Sleeps ended by console input */
+  uint32_t longest_ms;        /**< Longest single sleep */
+  int64_t boost_start_us;     /**< esp_timer time the boost lock was taken, 0 when not held */
+  uint64_t boosted_us;        /**< Total time at maximum CPU frequency on behalf of the console */
+  uint32_t boosts;            /**< Commands run boosted */
+  uint32_t longest_boost_ms;  /**< Longest single boost */
+} cli_power_state_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_power_state_t s_power = {.lock = portMUX_INITIALIZER_UNLOCKED};
+
+static struct
+{
+  struct arg_lit *reset;
+  struct arg_end *end;
+} idle_stats_args;
+
+/* ========================================================================== */
+/*                              AWAKE LOCK                                    */
+/* ========================================================================== */
+
+/**
+ * @brief Take the awake lock; unless a command is running, schedule its release
+ */
+static void cli_power_hold(bool running)
+{
+  portENTER_CRITICAL(&s_power.lock);
+  if (!s_power.held)
+  {
+    esp_pm_lock_acquire(s_power.awake);
+    s_power.held = true;
+  }
+  s_power.running = running;
+  portEXIT_CRITICAL(&s_power.lock);
+
+  esp_timer_stop(s_power.idle);
+  if (!running)
+    esp_timer_start_once(s_power.idle, s_power.awake_ms * 1000ULL);
+}
+
+static void cli_power_idle_cb(void *arg)
+{
+  portENTER_CRITICAL(&s_power.lock);
+  if (s_power.held && !s_power.running)
+  {
+    esp_pm_lock_release(s_power.awake);
+    s_power.held = false;
+  }
+  portEXIT_CRITICAL(&s_power.lock);
+}
+
+/**
+ * @brief Create the awake lock and its release timer (shared by CPU boost and idle sleep)
+ */
+static esp_err_t cli_power_awake_init(void)
+{
+  if (s_power.awake != NULL)
+    return ESP_OK;
+
+  esp_err_t err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "cli_awake", &s_power.awake);
+  if (err != ESP_OK)
+    return err;
+
+  const esp_timer_create_args_t timer_args = {.callback = &cli_power_idle_cb, .name = "cli_idle"};
+  err = esp_timer_create(&timer_args, &s_power.idle);
+  if (err != ESP_OK)
+    return err;
+
+  s_power.awake_ms = CLI_INPUT_AWAKE_MS;
+  s_power.since_us = esp_timer_get_time();
+  return ESP_OK;
+}
+
+/* ========================================================================== */
+/*                              IDLE SLEEP                                    */
+/* ========================================================================== */
+
+#if CLI_IDLE_SLEEP_SUPPORTED
+
+static void cli_power_wake_task(void *arg)
+{
+  while (true)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (!s_power.running)
+      cli_power_hold(false);
+  }
+}
+
+/**
+ * @brief Light sleep exit callback: account residency, wake the console up on UART input
+ *
+ * Runs from the idle task with interrupts disabled, so it only updates counters and notifies.
+ */
+static esp_err_t IRAM_ATTR cli_power_sleep_exit_cb(int64_t sleep_time_us, void *arg)
+{
+  s_power.sleeps++;
+  s_power.asleep_us += sleep_time_us;
+  if (sleep_time_us / 1000 > s_power.longest_ms)
+    s_power.longest_ms = sleep_time_us / 1000;
+
+  if (esp_sleep_get_wakeup_causes() & BIT(ESP_SLEEP_WAKEUP_UART))
+  {
+    s_power.uart_wakeups++;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_power.wake_task, &woken);
+  }
+  return ESP_OK;
+}
+
+#endif /* CLI_IDLE_SLEEP_SUPPORTED */
+
+/* ========================================================================== */
+/*                               COMMAND                                      */
+/* ========================================================================== */
+
+static int idle_stats(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&idle_stats_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, idle_stats_args.end, argv[0]);
+    return 1;
+  }
+
+  if (idle_stats_args.reset->count > 0)
+  {
+    portENTER_CRITICAL(&s_power.lock);
+    s_power.since_us = esp_timer_get_time();
+    s_power.asleep_us = 0;
+    s_power.sleeps = 0;
+    s_power.uart_wakeups = 0;
+    s_power.longest_ms = 0;
+    s_power.boosted_us = 0;
+    s_power.boosts = 0;
+    s_power.longest_boost_ms = 0;
+    portEXIT_CRITICAL(&s_power.lock);
+    printf("Power statistics reset\n");
+    return 0;
+  }
+
+  uint64_t window_us = esp_timer_get_time() - s_power.since_us;
+  uint64_t asleep_us = s_power.asleep_us;
+  uint32_t sleeps = s_power.sleeps;
+
+  printf("Awake delay:   %" PRIu32 " ms after the last command or key\n", s_power.awake_ms);
+  if (s_power.idle_sleep)
+  {
+    printf("Residency:     %.3f s asleep of %.3f s (%.1f%%)\n",
+           asleep_us / 1e6,
+           window_us / 1e6,
+           window_us ? 100.0 * asleep_us / window_us : 0.0);
+    printf("Sleeps:        %" PRIu32 " (%" PRIu32 " ended by console input)\n", sleeps, s_power.uart_wakeups);
+    printf("Sleep length:  avg %.1f ms, max %" PRIu32 " ms\n",
+           sleeps ? asleep_us / 1000.0 / sleeps : 0.0,
+           s_power.longest_ms);
+  }
+
+  if (s_power.boost != NULL)
+  {
+    uint64_t boosted_us = s_power.boosted_us;
+    uint32_t boosts = s_power.boosts;
+    printf("Boosted:       %.3f s at max CPU frequency of %.3f s (%.2f%%)\n",
+           boosted_us / 1e6,
+           window_us / 1e6,
+           window_us ? 100.0 * boosted_us / window_us : 0.0);
+    printf("Boosts:        %" PRIu32 " commands, avg %.1f ms, max %" PRIu32 " ms\n",
+           boosts,
+           boosts ? boosted_us / 1000.0 / boosts : 0.0,
+           s_power.longest_boost_ms);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Register 'idle_stats' once, whichever feature is enabled first
+ */
+static esp_err_t cli_power_register_stats(void)
+{
+  static bool registered = false;
+  if (registered)
+    return ESP_OK;
+
+  idle_stats_args.reset = arg_lit0(NULL, "reset", "Restart the statistics window");
+  idle_stats_args.end = arg_end(1);
+
+  const esp_console_cmd_t cmd = {.command = "idle_stats",
+                                 .help = "Show how long the console spent in automatic light sleep and boosted",
+                                 .hint = NULL,
+                                 .func = &idle_stats,
+                                 .argtable = &idle_stats_args};
+
+  esp_err_t err = esp_console_cmd_register(&cmd);
+  registered = (err == ESP_OK);
+  return err;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+esp_err_t cli_power_boost_init(void)
+{
+  if (s_power.boost != NULL)
+    return ESP_OK;
+
+  esp_err_t err = cli_power_awake_init();
+  if (err != ESP_OK)
+    return err;
+
+  err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "cli_boost", &s_power.boost);
+  if (err != ESP_OK)
+    return err;
+
+  ESP_LOGI(TAG, "CPU boost while commands run, light sleep blocked while typing");
+
+  return cli_power_register_stats();
+}
+
+esp_err_t cli_power_init(void)
+{
+#if CLI_IDLE_SLEEP_SUPPORTED
+  if (s_power.idle_sleep)
+    return ESP_OK;
+
+  /* Keep the application's frequency limits, only allow light sleep on top */
+  esp_pm_config_t pm_config = {0};
+  if (esp_pm_get_configuration(&pm_config) != ESP_OK || pm_config.max_freq_mhz == 0)
+  {
+    pm_config.max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    pm_config.min_freq_mhz = CONFIG_XTAL_FREQ;
+  }
+  pm_config.light_sleep_enable = true;
+
+  esp_err_t err = cli_power_awake_init();
+  if (err != ESP_OK)
+    return err;
+
+  if (xTaskCreate(cli_power_wake_task,
+                  "cli_wake",
+                  CLI_POWER_WAKE_TASK_STACK,
+                  NULL,
+                  CLI_POWER_WAKE_TASK_PRIO,
+                  &s_power.wake_task) != pdPASS)
+    return ESP_ERR_NO_MEM;
+
+  esp_pm_sleep_cbs_register_config_t cbs = {.exit_cb = &cli_power_sleep_exit_cb};
+  err = esp_pm_light_sleep_register_cbs(&cbs);
+  if (err != ESP_OK)
+    return err;
+
+  ESP_ERROR_CHECK(uart_set_wakeup_threshold(CONFIG_ESP_CONSOLE_UART_NUM, CLI_POWER_UART_WAKE_EDGES));
+  ESP_ERROR_CHECK(esp_sleep_enable_uart_wakeup(CONFIG_ESP_CONSOLE_UART_NUM));
+
+  s_power.awake_ms = CLI_IDLE_SLEEP_DELAY_MS;
+  s_power.since_us = esp_timer_get_time();
+  cli_power_hold(false);
+
+  err = esp_pm_configure(&pm_config);
+  if (err != ESP_OK)
+    return err;
+  s_power.idle_sleep = true;
+
+  ESP_LOGI(TAG,
+           "Idle light sleep after %d ms, CPU %d-%d MHz",
+           CLI_IDLE_SLEEP_DELAY_MS,
+           pm_config.min_freq_mhz,
+           pm_config.max_freq_mhz);
+
+  return cli_power_register_stats();
+#else
+  ESP_LOGW(TAG,
+           "Idle sleep needs a UART console with CONFIG_PM_ENABLE, CONFIG_FREERTOS_USE_TICKLESS_IDLE and "
+           "CONFIG_PM_LIGHT_SLEEP_CALLBACKS");
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void cli_power_input(void)
+{
+  if (s_power.awake != NULL && !s_power.running)
+    cli_power_hold(false);
+}
+
+void cli_power_command_begin(void)
+{
+  if (s_power.boost != NULL)
+  {
+    esp_pm_lock_acquire(s_power.boost);
+    s_power.boost_start_us = esp_timer_get_time();
+  }
+  if (s_power.awake != NULL)
+    cli_power_hold(true);
+}
+
+void cli_power_command_end(void)
+{
+  if (s_power.awake != NULL)
+    cli_power_hold(false);
+  if (s_power.boost != NULL && s_power.boost_start_us != 0)
+  {
+    int64_t boosted_us = esp_timer_get_time() - s_power.boost_start_us;
+    esp_pm_lock_release(s_power.boost);
+    s_power.boost_start_us = 0;
+
+    portENTER_CRITICAL(&s_power.lock);
+    s_power.boosted_us += boosted_us;
+    s_power.boosts++;
+    if (boosted_us / 1000 > s_power.longest_boost_ms)
+      s_power.longest_boost_ms = boosted_us / 1000;
+    portEXIT_CRITICAL(&s_power.lock);
+  }
+}
+
+#else /* !CONFIG_PM_ENABLE */
+
+esp_err_t cli_power_boost_init(void)
+{
+  ESP_LOGW(TAG, "CPU boost needs CONFIG_PM_ENABLE");
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cli_power_init(void)
+{
+  ESP_LOGW(TAG,
+           "Idle sleep needs a UART console with CONFIG_PM_ENABLE, CONFIG_FREERTOS_USE_TICKLESS_IDLE and "
+           "CONFIG_PM_LIGHT_SLEEP_CALLBACKS");
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void cli_power_input(void)
+{
+}
+
+void cli_power_command_begin(void)
+{
+}
+
+void cli_power_command_end(void)
+{
+}
+
+#endif /* CONFIG_PM_ENABLE */
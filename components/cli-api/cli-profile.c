@@ -0,0 +1,398 @@
+/**
+ * @file cli-profile.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Statistical sampling profiler: 'profile [--hz N] [--ms T] [--top K] [command...]'.
+ *
+ * One GPTimer per core fires at the sampling rate. Its interrupt is allocated on that core, so every alarm interrupts
+ * whatever the core was running. Outside of nested interrupts the FreeRTOS port has already saved the interrupted
+ * context on the task stack and stored that stack pointer in the task's TCB (pxTopOfStack), so the interrupted program
+ * counter is read from the saved frame. Samples are counted per address in a fixed open-addressing histogram,
+ * allocated for the run; nothing is allocated or printed from the interrupt.
+ *
+ * Samples taken in the idle tasks or inside another interrupt are counted per core but not added to the histogram.
+ * Code running with interrupts disabled (critical sections, flash operations) cannot be sampled and shows up as the
+ * instruction that re-enabled them.
+ *
+ * Application images carry no symbol table, so the device prints addresses; tools/cli_profile.py maps them to
+ * functions with the ELF and adds up the samples per function.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <driver/gptimer.h>
+#include <esp_attr.h>
+#include <esp_console.h>
+#include <esp_cpu.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+#include <sdkconfig.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !CONFIG_FREERTOS_UNICORE
+#include <esp_ipc.h>
+#endif
+
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+#include <xtensa_context.h>
+#define CLI_PROFILE_FRAME_PC XT_STK_PC
+#else
+#include <riscv/rvruntime-frames.h>
+#define CLI_PROFILE_FRAME_PC RV_STK_MEPC
+#endif
+
+#include "cli-internal.h"
+
+static const char *TAG = "cli-profile";
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+#define CLI_PROFILE_DEFAULT_HZ  1000
+#define CLI_PROFILE_DEFAULT_MS  1000
+#define CLI_PROFILE_MAX_MS      60000
+#define CLI_PROFILE_DEFAULT_TOP 20
+
+/* Slots probed before a sample is dropped; keeps the interrupt short when the histogram fills up */
+#define CLI_PROFILE_PROBES 16
+
+#define CLI_PROFILE_TIMER_RESOLUTION_HZ 1000000
+
+_Static_assert((CLI_PROFILE_MAX_PCS & (CLI_PROFILE_MAX_PCS - 1)) == 0, "the histogram is indexed with a mask");
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief One histogram slot
+ */
+typedef struct
+{
+  uint32_t pc;    /**< Interrupted program counter, 0 = free slot */
+  uint32_t count; /**< Samples at pc */
+} cli_profile_bucket_t;
+
+/**
+ * @brief State of the running profile
+ */
+typedef struct
+{
+  cli_profile_bucket_t *buckets;               /**< CLI_PROFILE_MAX_PCS slots, internal RAM */
+  gptimer_handle_t timers[portNUM_PROCESSORS]; /**< Sampling timer of each core */
+  portMUX_TYPE lock;                           /**< Histogram is shared by the cores' interrupts */
+  uint32_t samples[portNUM_PROCESSORS];        /**< All samples per core */
+  uint32_t idle[portNUM_PROCESSORS];           /**< Samples in the core's idle task */
+  uint32_t in_isr[portNUM_PROCESSORS];         /**< Samples inside another interrupt */
+  uint32_t dropped;                            /**< Samples lost to a full histogram */
+} cli_profile_state_t;
+
+/**
+ * @brief Timer setup request, executed on the core that must receive the interrupts
+ */
+typedef struct
+{
+  int core;      /**< Target core */
+  uint32_t hz;   /**< Sampling rate */
+  esp_err_t err; /**< Result */
+} cli_profile_start_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_profile_state_t s_prof = {.lock = portMUX_INITIALIZER_UNLOCKED};
+
+/* ========================================================================== */
+/*                               SAMPLING                                     */
+/* ========================================================================== */
+
+/**
+ * @brief Program counter the interrupted task will resume at
+ */
+static inline uint32_t cli_profile_interrupted_pc(TaskHandle_t task)
+{
+  /* pxTopOfStack is the first member of the TCB; the interrupt entry code stored the saved frame's address there */
+  const uint8_t *frame = *(const uint8_t *const *)task;
+  return *(const uint32_t *)(frame + CLI_PROFILE_FRAME_PC);
+}
+
+static inline void cli_profile_count(uint32_t pc)
+{
+  uint32_t slot = (pc * 2654435761u) >> (32 - __builtin_ctz(CLI_PROFILE_MAX_PCS));
+
+  for (int i = 0; i < CLI_PROFILE_PROBES; i++)
+  {
+    cli_profile_bucket_t *b = &s_prof.buckets[(slot + i) & (CLI_PROFILE_MAX_PCS - 1)];
+    if (b->pc == pc || b->pc == 0)
+    {
+      b->pc = pc;
+      b->count++;
+      return;
+    }
+  }
+  s_prof.dropped++;
+}
+
+static bool IRAM_ATTR cli_profile_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg)
+{
+  int core = esp_cpu_get_core_id();
+  TaskHandle_t task = xTaskGetCurrentTaskHandleForCore(core);
+
+  portENTER_CRITICAL_ISR(&s_prof.lock);
+  s_prof.samples[core]++;
+  if (xPortInterruptedFromISRContext())
+    s_prof.in_isr[core]++;
+  else if (task == xTaskGetIdleTaskHandleForCore(core))
+    s_prof.idle[core]++;
+  else
+    cli_profile_count(cli_profile_interrupted_pc(task));
+  portEXIT_CRITICAL_ISR(&s_prof.lock);
+
+  return false;
+}
+
+/**
+ * @brief Create and start the sampling timer of the calling core (the interrupt is allocated where this runs)
+ */
+static void cli_profile_start_on_core(void *arg)
+{
+  cli_profile_start_t *req = arg;
+  gptimer_handle_t timer = NULL;
+
+  const gptimer_config_t timer_config = {
+    .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+    .direction = GPTIMER_COUNT_UP,
+    .resolution_hz = CLI_PROFILE_TIMER_RESOLUTION_HZ,
+  };
+  req->err = gptimer_new_timer(&timer_config, &timer);
+  if (req->err != ESP_OK)
+    return;
+  s_prof.timers[req->core] = timer;
+
+  const gptimer_event_callbacks_t cbs = {.on_alarm = cli_profile_on_alarm};
+  const gptimer_alarm_config_t alarm = {
+    .alarm_count = CLI_PROFILE_TIMER_RESOLUTION_HZ / req->hz,
+    .reload_count = 0,
+    .flags.auto_reload_on_alarm = true,
+  };
+
+  req->err = gptimer_register_event_callbacks(timer, &cbs, NULL);
+  if (req->err == ESP_OK)
+    req->err = gptimer_set_alarm_action(timer, &alarm);
+  if (req->err == ESP_OK)
+    req->err = gptimer_enable(timer);
+  if (req->err == ESP_OK)
+    req->err = gptimer_start(timer);
+}
+
+static esp_err_t cli_profile_start(uint32_t hz)
+{
+  for (int core = 0; core < portNUM_PROCESSORS; core++)
+  {
+    cli_profile_start_t req = {.core = core, .hz = hz, .err = ESP_FAIL};
+#if CONFIG_FREERTOS_UNICORE
+    cli_profile_start_on_core(&req);
+#else
+    esp_err_t err = esp_ipc_call_blocking(core, cli_profile_start_on_core, &req);
+    if (err != ESP_OK)
+      return err;
+#endif
+    if (req.err != ESP_OK)
+      return req.err;
+  }
+  return ESP_OK;
+}
+
+static void cli_profile_stop(void)
+{
+  for (int core = 0; core < portNUM_PROCESSORS; core++)
+  {
+    gptimer_handle_t timer = s_prof.timers[core];
+    if (timer == NULL)
+      continue;
+
+    /* Stop and disable fail harmlessly on a timer whose setup did not get that far */
+    gptimer_stop(timer);
+    gptimer_disable(timer);
+    gptimer_del_timer(timer);
+    s_prof.timers[core] = NULL;
+  }
+}
+
+/* ========================================================================== */
+/*                               REPORT                                       */
+/* ========================================================================== */
+
+static int cli_profile_cmp(const void *a, const void *b)
+{
+  const cli_profile_bucket_t *x = a;
+  const cli_profile_bucket_t *y = b;
+  if (x->count != y->count)
+    return (x->count < y->count) ? 1 : -1;
+  return (x->pc > y->pc) - (x->pc < y->pc);
+}
+
+static void cli_profile_report(uint32_t hz, int64_t elapsed_us, size_t top)
+{
+  /* Move the used slots to the front and sort them by sample count */
+  size_t used = 0;
+  for (size_t i = 0; i < CLI_PROFILE_MAX_PCS; i++)
+  {
+    if (s_prof.buckets[i].pc != 0)
+      s_prof.buckets[used++] = s_prof.buckets[i];
+  }
+  qsort(s_prof.buckets, used, sizeof(cli_profile_bucket_t), cli_profile_cmp);
+
+  uint32_t total = 0;
+  for (int core = 0; core < portNUM_PROCESSORS; core++)
+    total += s_prof.samples[core];
+
+  printf("Profile: %" PRIu32 " Hz for %" PRId64 " ms, %" PRIu32 " samples\n", hz, elapsed_us / 1000, total);
+  for (int core = 0; core < portNUM_PROCESSORS; core++)
+  {
+    uint32_t n = s_prof.samples[core];
+    printf("  core %d: %" PRIu32 " samples, %.1f%% idle, %.1f%% in interrupts\n",
+           core,
+           n,
+           n ? 100.0 * s_prof.idle[core] / n : 0.0,
+           n ? 100.0 * s_prof.in_isr[core] / n : 0.0);
+  }
+
+  printf("\n%10s %7s  %s\n", "samples", "%", "pc");
+  for (size_t i = 0; i < used && (top == 0 || i < top); i++)
+  {
+    printf("%10" PRIu32 " %6.2f%%  0x%08" PRIx32 "\n",
+           s_prof.buckets[i].count,
+           total ? 100.0 * s_prof.buckets[i].count / total : 0.0,
+           s_prof.buckets[i].pc);
+  }
+
+  printf("%u distinct addresses, %" PRIu32 " samples dropped (histogram full)\n", (unsigned)used, s_prof.dropped);
+}
+
+/* ========================================================================== */
+/*                               COMMAND                                      */
+/* ========================================================================== */
+
+/**
+ * @brief Parse the leading "--name value" options; everything after them is the command to profile
+ *
+ * @return Index of the first command token (argc if there is none), -1 on a bad option
+ */
+static int cli_profile_parse(int argc, char **argv, uint32_t *hz, uint32_t *ms, size_t *top)
+{
+  int i = 1;
+  while (i < argc && strncmp(argv[i], "--", 2) == 0)
+  {
+    if (strcmp(argv[i], "--") == 0)
+      return i + 1;
+    if (i + 1 >= argc)
+      return -1;
+
+    char *end = NULL;
+    unsigned long value = strtoul(argv[i + 1], &end, 0);
+    if (end == argv[i + 1] || *end != '\0')
+      return -1;
+
+    if (strcmp(argv[i], "--hz") == 0)
+      *hz = value;
+    else if (strcmp(argv[i], "--ms") == 0)
+      *ms = value;
+    else if (strcmp(argv[i], "--top") == 0)
+      *top = value;
+    else
+      return -1;
+    i += 2;
+  }
+  return i;
+}
+
+static int profile_cmd(int argc, char **argv)
+{
+  uint32_t hz = CLI_PROFILE_DEFAULT_HZ;
+  uint32_t ms = CLI_PROFILE_DEFAULT_MS;
+  size_t top = CLI_PROFILE_DEFAULT_TOP;
+
+  int first = cli_profile_parse(argc, argv, &hz, &ms, &top);
+  if (first < 0 || hz == 0 || hz > CLI_PROFILE_MAX_HZ || ms == 0 || ms > CLI_PROFILE_MAX_MS)
+  {
+    printf("Usage: profile [--hz 1-%d] [--ms 1-%d] [--top K, 0 = all] [command [args...]]\n",
+           CLI_PROFILE_MAX_HZ,
+           CLI_PROFILE_MAX_MS);
+    return 1;
+  }
+  if (first < argc && strcmp(argv[first], argv[0]) == 0)
+  {
+    printf("ERROR: profile cannot be nested\n");
+    return 1;
+  }
+
+  s_prof.buckets = heap_caps_calloc(CLI_PROFILE_MAX_PCS, sizeof(cli_profile_bucket_t), MALLOC_CAP_INTERNAL);
+  if (s_prof.buckets == NULL)
+  {
+    ESP_LOGE(TAG,
+             "No memory for the histogram (%u bytes)",
+             (unsigned)(CLI_PROFILE_MAX_PCS * sizeof(cli_profile_bucket_t)));
+    return 1;
+  }
+  memset(s_prof.samples, 0, sizeof(s_prof.samples));
+  memset(s_prof.idle, 0, sizeof(s_prof.idle));
+  memset(s_prof.in_isr, 0, sizeof(s_prof.in_isr));
+  s_prof.dropped = 0;
+
+  int64_t start_us = esp_timer_get_time();
+  esp_err_t err = cli_profile_start(hz);
+
+  int ret = 0;
+  if (err != ESP_OK)
+    printf("ERROR: Cannot start the sampling timers: %s\n", esp_err_to_name(err));
+  else if (first < argc)
+    err = cli_exec_nested(argc - first, &argv[first], &ret);
+  else
+    vTaskDelay(pdMS_TO_TICKS(ms));
+
+  cli_profile_stop();
+  int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+  if (err == ESP_ERR_NOT_FOUND)
+    printf("Unrecognized command\n");
+  else if (err != ESP_OK && first < argc)
+    printf("Command failed: %s\n", esp_err_to_name(err));
+  else if (err == ESP_OK)
+    cli_profile_report(hz, elapsed_us, top);
+
+  free(s_prof.buckets);
+  s_prof.buckets = NULL;
+
+  return (err == ESP_OK) ? ret : 1;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+esp_err_t cli_profile_init(void)
+{
+  const esp_console_cmd_t cmd = {.command = "profile",
+                                 .help = "Sample the program counter of every core and list the hottest addresses. "
+                                         "Profiles the given command, or the whole system for --ms. "
+                                         "Symbolize with tools/cli_profile.py.\n"
+                                         "Example: profile --hz 5000 fsbench -s 256",
+                                 .hint = "[--hz N] [--ms T] [--top K] [command [args...]]",
+                                 .func = &profile_cmd,
+                                 .argtable = NULL};
+
+  return esp_console_cmd_register(&cmd);
+}
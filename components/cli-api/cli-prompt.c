@@ -0,0 +1,220 @@
+/**
+ * @file cli-prompt.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Prompt templates with cached status tokens.
+ *
+ * A prompt containing "{name}" tokens is a template: each token is replaced by the text of a registered provider.
+ * Provider output is cached; a provider is only called again when its source invalidates it
+ * (cli_prompt_invalidate()) or when its cache is older than its max age, and the prompt string is only rebuilt when
+ * a token text actually changed. Built-in tokens: {heap} (free heap) and {rc} (last console return code).
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cli-internal.h"
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+/** The free heap changes with every command; re-read it at most once per second */
+#define CLI_PROMPT_HEAP_MAX_AGE_MS 1000
+
+/** {rc} of a line whose command does not exist, as in POSIX shells */
+#define CLI_PROMPT_RC_NOT_FOUND 127
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief One registered token and its cached text
+ */
+typedef struct
+{
+  const char *name;                    /**< Token name, without braces */
+  cli_prompt_token_cb_t cb;            /**< Provider */
+  void *arg;                           /**< Passed to cb */
+  uint32_t max_age_ms;                 /**< Refresh period, 0 = only when invalidated */
+  int64_t updated_us;                  /**< esp_timer time of the last call to cb */
+  volatile bool stale;                 /**< Set by cli_prompt_invalidate(), possibly from another task */
+  char text[CLI_PROMPT_TOKEN_MAX_LEN]; /**< Cached provider output */
+} cli_prompt_token_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_prompt_token_t s_tokens[CLI_PROMPT_MAX_TOKENS];
+static size_t s_token_count = 0;
+
+static char s_rendered[CLI_PROMPT_MAX_LEN]; /**< Last prompt built from a template */
+static bool s_render_valid = false;         /**< false forces a rebuild (new token, new template) */
+static int s_last_rc = 0;
+
+/* ========================================================================== */
+/*                           BUILT-IN TOKENS                                  */
+/* ========================================================================== */
+
+static void cli_prompt_heap(char *buf, size_t size, void *arg)
+{
+  snprintf(buf, size, "%uK", (unsigned)(heap_caps_get_free_size(MALLOC_CAP_DEFAULT) / 1024));
+}
+
+static void cli_prompt_rc(char *buf, size_t size, void *arg)
+{
+  snprintf(buf, size, "%d", s_last_rc);
+}
+
+/* ========================================================================== */
+/*                              RENDERING                                     */
+/* ========================================================================== */
+
+static cli_prompt_token_t *cli_prompt_find(const char *name, size_t len)
+{
+  for (size_t i = 0; i < s_token_count; i++)
+  {
+    if (strncmp(s_tokens[i].name, name, len) == 0 && s_tokens[i].name[len] == '\0')
+      return &s_tokens[i];
+  }
+  return NULL;
+}
+
+/**
+ * @brief Refresh the cache of every stale or expired token
+ *
+ * @return true if any token text changed
+ */
+static bool cli_prompt_refresh(void)
+{
+  int64_t now = esp_timer_get_time();
+  bool changed = false;
+
+  for (size_t i = 0; i < s_token_count; i++)
+  {
+    cli_prompt_token_t *t = &s_tokens[i];
+    bool expired = t->max_age_ms > 0 && now - t->updated_us >= (int64_t)t->max_age_ms * 1000;
+    if (!t->stale && !expired)
+      continue;
+
+    char text[CLI_PROMPT_TOKEN_MAX_LEN] = "";
+    t->stale = false;
+    t->cb(text, sizeof(text), t->arg);
+    t->updated_us = now;
+
+    if (strcmp(text, t->text) != 0)
+    {
+      memcpy(t->text, text, sizeof(text));
+      changed = true;
+    }
+  }
+
+  return changed;
+}
+
+/**
+ * @brief Expand the tokens of a template; unknown tokens are copied as they are
+ */
+static void cli_prompt_build(const char *tmpl)
+{
+  size_t pos = 0;
+  const char *p = tmpl;
+
+  while (*p && pos < sizeof(s_rendered) - 1)
+  {
+    const char *close = (*p == '{') ? strchr(p + 1, '}') : NULL;
+    cli_prompt_token_t *t = close ? cli_prompt_find(p + 1, close - p - 1) : NULL;
+    if (t == NULL)
+    {
+      s_rendered[pos++] = *p++;
+      continue;
+    }
+
+    size_t len = strnlen(t->text, sizeof(t->text));
+    if (len > sizeof(s_rendered) - 1 - pos)
+      len = sizeof(s_rendered) - 1 - pos;
+    memcpy(&s_rendered[pos], t->text, len);
+    pos += len;
+    p = close + 1;
+  }
+
+  s_rendered[pos] = '\0';
+}
+
+/* ========================================================================== */
+/*                          REGISTRATION INTERFACE                            */
+/* ========================================================================== */
+
+esp_err_t cli_prompt_register_token(const char *name, uint32_t max_age_ms, cli_prompt_token_cb_t cb, void *arg)
+{
+  if (name == NULL || cb == NULL)
+    return ESP_ERR_INVALID_ARG;
+  if (cli_prompt_find(name, strlen(name)) != NULL)
+    return ESP_ERR_INVALID_STATE;
+  if (s_token_count >= CLI_PROMPT_MAX_TOKENS)
+    return ESP_ERR_NO_MEM;
+
+  s_tokens[s_token_count++] = (cli_prompt_token_t){
+    .name = name,
+    .cb = cb,
+    .arg = arg,
+    .max_age_ms = max_age_ms,
+    .stale = true,
+  };
+  s_render_valid = false;
+
+  return ESP_OK;
+}
+
+void cli_prompt_invalidate(const char *name)
+{
+  cli_prompt_token_t *t = cli_prompt_find(name, strlen(name));
+  if (t != NULL)
+    t->stale = true;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+void cli_prompt_init(void)
+{
+  cli_prompt_register_token("heap", CLI_PROMPT_HEAP_MAX_AGE_MS, cli_prompt_heap, NULL);
+  cli_prompt_register_token("rc", 0, cli_prompt_rc, NULL);
+  s_render_valid = false;
+}
+
+const char *cli_prompt_render(const char *tmpl)
+{
+  if (strchr(tmpl, '{') == NULL)
+    return tmpl;
+
+  if (cli_prompt_refresh() || !s_render_valid)
+  {
+    cli_prompt_build(tmpl);
+    s_render_valid = true;
+  }
+
+  return s_rendered;
+}
+
+void cli_prompt_set_result(esp_err_t err, int ret)
+{
+  int rc = (err == ESP_ERR_NOT_FOUND) ? CLI_PROMPT_RC_NOT_FOUND : (err != ESP_OK) ? 1 : ret;
+  if (rc != s_last_rc)
+  {
+    s_last_rc = rc;
+    cli_prompt_invalidate("rc");
+  }
+}
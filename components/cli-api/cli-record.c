@@ -0,0 +1,416 @@
+/**
+ * @file cli-record.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Console session recording ('record') and timed replay ('replay') of the raw input stream.
+ *
+ * While recording, every batch of bytes the input layer takes from the driver (cli-input.c) is appended to a file
+ * with the time since the previous batch. Keys typed by hand arrive one per batch, so they keep their own timing. A
+ * replay feeds the file back through the same input path: linenoise edits the lines and the console executes them
+ * exactly as if they were typed, at the recorded pace, scaled by --speed, or with no delays (--max). A key pressed
+ * during a replay stops it. When the recording is exhausted, the time from 'replay' to the end of the last command
+ * is reported before the next prompt.
+ *
+ * File format (little endian), shared with tools/cli_replay.py:
+ *
+ *   "CLIREC1\n"
+ *   { uint32 delta_us, uint16 len, uint8 bytes[len] } ...
+ *
+ * delta_us saturates at UINT32_MAX, so an idle gap longer than ~71 minutes is replayed as ~71 minutes.
+ *
+ * 'record stop' cuts the file back to the end of the previous line, so the stop command itself is not replayed.
+ *
+ * Recording and replay only use stdio, esp_console and the cli-input.c read path, so they also run on the linux target:
+ * test_apps/record_replay checks the replayed lines and their pacing there, and tools/cli_replay.py -e against it.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <argtable3/argtable3.h>
+#include <errno.h>
+#include <esp_console.h>
+#include <esp_timer.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cli-internal.h"
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+#define CLI_RECORD_MAGIC     "CLIREC1\n"
+#define CLI_RECORD_MAGIC_LEN 8
+#define CLI_RECORD_PATH_MAX  64
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Header of one input batch in a recording
+ */
+typedef struct __attribute__((packed))
+{
+  uint32_t delta_us; /**< Time since the previous batch (since 'record start' for the first) */
+  uint16_t len;      /**< Bytes that follow */
+} cli_record_chunk_t;
+
+/**
+ * @brief Recording and replay state (console task only)
+ */
+typedef struct
+{
+  FILE *rec;                          /**< Recording file, NULL when not recording */
+  char rec_path[CLI_RECORD_PATH_MAX]; /**< Its path, for the report */
+  int64_t rec_last_us;                /**< Time of the last recorded batch */
+  long line_end;                      /**< File offset at the last prompt */
+  bool rec_failed;                    /**< Recording stopped by a write error */
+
+  FILE *play;                         /**< File being replayed, NULL when not replaying */
+  double speed;                       /**< Pace multiplier, 0 = no delays */
+  cli_record_chunk_t next;            /**< Header of the next batch */
+  bool have_next;                     /**< next holds an unread batch; false at the end of the file */
+  uint16_t remain;                    /**< Bytes of the current batch not handed out yet */
+  int64_t play_start_us;              /**< Time of the 'replay' command */
+  int64_t play_last_us;               /**< Time the last batch was handed out */
+  uint64_t recorded_us;               /**< Recorded time of the batches handed out */
+  uint32_t play_bytes;                /**< Bytes handed out */
+  uint32_t play_lines;                /**< Line ends handed out */
+  bool interrupted;                   /**< Stopped by a key */
+} cli_record_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_record_t s_record = {0};
+
+static struct
+{
+  struct arg_str *action;
+  struct arg_str *file;
+  struct arg_end *end;
+} record_args;
+
+static struct
+{
+  struct arg_str *file;
+  struct arg_dbl *speed;
+  struct arg_lit *max;
+  struct arg_end *end;
+} replay_args;
+
+/* ========================================================================== */
+/*                               HELPERS                                      */
+/* ========================================================================== */
+
+/**
+ * @brief Resolve a name relative to the history volume ("s.rec" -> "/data/s.rec"), absolute paths are kept
+ */
+static bool cli_record_path(const char *name, char *out, size_t size)
+{
+  const char *mount = cli_get_storage(NULL);
+  if (name[0] != '/' && mount == NULL)
+  {
+    printf("ERROR: No filesystem mounted (history storage disabled)\n");
+    return false;
+  }
+
+  int len = (name[0] == '/') ? snprintf(out, size, "%s", name) : snprintf(out, size, "%s/%s", mount, name);
+  if (len < 0 || (size_t)len >= size)
+  {
+    printf("ERROR: Path too long\n");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Read the header of the following batch, have_next = false at the end of the file
+ */
+static void cli_record_read_next(void)
+{
+  s_record.have_next = (fread(&s_record.next, sizeof(s_record.next), 1, s_record.play) == 1);
+}
+
+static void cli_record_replay_close(void)
+{
+  fclose(s_record.play);
+  s_record.play = NULL;
+  s_record.have_next = false;
+  s_record.remain = 0;
+}
+
+/* ========================================================================== */
+/*                              RECORDING                                     */
+/* ========================================================================== */
+
+void cli_record_input(const uint8_t *buf, size_t len)
+{
+  if (s_record.rec == NULL)
+    return;
+
+  int64_t now = esp_timer_get_time();
+  int64_t gap_us = now - s_record.rec_last_us;
+  cli_record_chunk_t chunk = {.delta_us = (gap_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)gap_us, .len = len};
+  s_record.rec_last_us = now;
+
+  if (fwrite(&chunk, sizeof(chunk), 1, s_record.rec) != 1 || fwrite(buf, 1, len, s_record.rec) != len)
+  {
+    /* Out of space: keep what was written */
+    fclose(s_record.rec);
+    s_record.rec = NULL;
+    s_record.rec_failed = true;
+  }
+}
+
+static int cli_record_start(const char *name)
+{
+  if (s_record.rec != NULL)
+  {
+    printf("ERROR: Already recording to '%s'\n", s_record.rec_path);
+    return 1;
+  }
+  if (!cli_record_path(name, s_record.rec_path, sizeof(s_record.rec_path)))
+    return 1;
+
+  s_record.rec = fopen(s_record.rec_path, "wb");
+  if (s_record.rec == NULL)
+  {
+    printf("ERROR: Cannot create '%s': %s\n", s_record.rec_path, strerror(errno));
+    return 1;
+  }
+  if (fwrite(CLI_RECORD_MAGIC, CLI_RECORD_MAGIC_LEN, 1, s_record.rec) != 1)
+  {
+    printf("ERROR: Cannot write '%s'\n", s_record.rec_path);
+    fclose(s_record.rec);
+    s_record.rec = NULL;
+    return 1;
+  }
+
+  s_record.rec_last_us = esp_timer_get_time();
+  s_record.line_end = CLI_RECORD_MAGIC_LEN;
+  printf("Recording console input to '%s', stop with 'record stop'\n", s_record.rec_path);
+  return 0;
+}
+
+static int cli_record_stop(void)
+{
+  if (s_record.rec == NULL)
+  {
+    printf("ERROR: Not recording\n");
+    return 1;
+  }
+
+  /* The bytes after the last prompt are this 'record stop' line */
+  long size = s_record.line_end;
+  fflush(s_record.rec);
+  if (ftruncate(fileno(s_record.rec), size) != 0)
+    size = ftell(s_record.rec);
+  fclose(s_record.rec);
+  s_record.rec = NULL;
+
+  printf("Recorded %ld bytes to '%s'\n", size, s_record.rec_path);
+  return 0;
+}
+
+/* ========================================================================== */
+/*                                REPLAY                                      */
+/* ========================================================================== */
+
+ssize_t cli_record_replay(uint8_t *buf, size_t size)
+{
+  if (s_record.play == NULL || (s_record.remain == 0 && !s_record.have_next))
+    return 0;
+
+  if (s_record.remain == 0)
+  {
+    s_record.remain = s_record.next.len;
+    s_record.recorded_us += s_record.next.delta_us;
+
+    int64_t wait_us = (s_record.speed > 0) ? s_record.play_last_us + (int64_t)(s_record.next.delta_us / s_record.speed) -
+                                               esp_timer_get_time()
+                                           : 0;
+    /* Wait on the console itself, or just poll it without delays (--max): a key stops the replay and goes to the
+     * line editor instead */
+    size_t n = cli_input_wait(buf, size, (wait_us >= 1000) ? wait_us / 1000 : 0);
+    if (n > 0)
+    {
+      s_record.interrupted = true;
+      cli_record_replay_close();
+      return n;
+    }
+  }
+
+  size_t n = (s_record.remain < size) ? s_record.remain : size;
+  if (fread(buf, 1, n, s_record.play) != n)
+  {
+    cli_record_replay_close();
+    return 0;
+  }
+  s_record.remain -= n;
+  s_record.play_last_us = esp_timer_get_time();
+  s_record.play_bytes += n;
+  for (size_t i = 0; i < n; i++)
+    if (buf[i] == '\r' || buf[i] == '\n')
+      s_record.play_lines++;
+
+  /* Look ahead, so the end is known before the line editor asks for more */
+  if (s_record.remain == 0)
+    cli_record_read_next();
+
+  return n;
+}
+
+void cli_record_prompt(void)
+{
+  if (s_record.rec != NULL)
+    s_record.line_end = ftell(s_record.rec);
+  else if (s_record.rec_failed)
+  {
+    printf("Recording to '%s' stopped: write failed\n", s_record.rec_path);
+    s_record.rec_failed = false;
+  }
+
+  if (s_record.interrupted)
+  {
+    printf("Replay stopped by input after %" PRIu32 " bytes\n", s_record.play_bytes);
+    s_record.interrupted = false;
+  }
+  else if (s_record.play != NULL && s_record.remain == 0 && !s_record.have_next)
+  {
+    int64_t elapsed_us = esp_timer_get_time() - s_record.play_start_us;
+    printf("Replayed %" PRIu32 " bytes, %" PRIu32 " lines in %.3f s (recorded over %.3f s)\n",
+           s_record.play_bytes,
+           s_record.play_lines,
+           elapsed_us / 1e6,
+           s_record.recorded_us / 1e6);
+    cli_record_replay_close();
+  }
+}
+
+/* ========================================================================== */
+/*                               COMMANDS                                     */
+/* ========================================================================== */
+
+static int record_cmd(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&record_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, record_args.end, argv[0]);
+    return 1;
+  }
+
+  const char *action = record_args.action->sval[0];
+  if (strcmp(action, "start") == 0)
+  {
+    if (record_args.file->count == 0)
+    {
+      printf("ERROR: record start needs a file name\n");
+      return 1;
+    }
+    return cli_record_start(record_args.file->sval[0]);
+  }
+  if (strcmp(action, "stop") == 0)
+    return cli_record_stop();
+
+  printf("ERROR: Action '%s' invalid. Use: start, stop\n", action);
+  return 1;
+}
+
+static int replay_cmd(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&replay_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, replay_args.end, argv[0]);
+    return 1;
+  }
+
+  if (s_record.play != NULL)
+  {
+    printf("ERROR: A replay is already running\n");
+    return 1;
+  }
+
+  double speed = (replay_args.speed->count > 0) ? replay_args.speed->dval[0] : 1.0;
+  if (replay_args.max->count > 0)
+    speed = 0;
+  else if (speed <= 0)
+  {
+    printf("ERROR: --speed must be > 0\n");
+    return 1;
+  }
+
+  char path[CLI_RECORD_PATH_MAX];
+  if (!cli_record_path(replay_args.file->sval[0], path, sizeof(path)))
+    return 1;
+
+  FILE *f = fopen(path, "rb");
+  char magic[CLI_RECORD_MAGIC_LEN];
+  if (f == NULL || fread(magic, sizeof(magic), 1, f) != 1 || memcmp(magic, CLI_RECORD_MAGIC, sizeof(magic)) != 0)
+  {
+    printf("ERROR: '%s' is not a console recording\n", path);
+    if (f != NULL)
+      fclose(f);
+    return 1;
+  }
+
+  s_record.play = f;
+  s_record.speed = speed;
+  s_record.remain = 0;
+  s_record.recorded_us = 0;
+  s_record.play_bytes = 0;
+  s_record.play_lines = 0;
+  s_record.interrupted = false;
+  s_record.play_start_us = esp_timer_get_time();
+  s_record.play_last_us = s_record.play_start_us;
+  cli_record_read_next();
+
+  if (speed > 0)
+    printf("Replaying '%s' at %.2fx, press any key to stop\n", path, speed);
+  else
+    printf("Replaying '%s' without delays, press any key to stop\n", path);
+  return 0;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+esp_err_t cli_record_init(void)
+{
+  record_args.action = arg_str1(NULL, NULL, "<start|stop>", "Action");
+  record_args.file = arg_str0(NULL, NULL, "<file>", "Recording, relative to the history volume (start)");
+  record_args.end = arg_end(2);
+
+  replay_args.file = arg_str1(NULL, NULL, "<file>", "Recording made with 'record'");
+  replay_args.speed = arg_dbl0("s", "speed", "<x>", "Pace multiplier (default 1, 2 = twice as fast)");
+  replay_args.max = arg_lit0(NULL, "max", "No delays, as fast as the console takes the input");
+  replay_args.end = arg_end(3);
+
+  const esp_console_cmd_t record = {.command = "record",
+                                    .help = "Record the console input with its timing into a file",
+                                    .hint = NULL,
+                                    .func = &record_cmd,
+                                    .argtable = &record_args};
+  const esp_console_cmd_t replay = {.command = "replay",
+                                    .help = "Feed a recording back through the console input and time it",
+                                    .hint = NULL,
+                                    .func = &replay_cmd,
+                                    .argtable = &replay_args};
+
+  esp_err_t err = esp_console_cmd_register(&record);
+  if (err == ESP_OK)
+    err = esp_console_cmd_register(&replay);
+
+  return err;
+}
@@ -0,0 +1,453 @@
+/**
+ * @file cli-redraw.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Minimal line redraw: linenoise refresh frames are turned into the changed tail and cursor moves.
+ *
+ * In multi-line mode linenoise repaints the whole line on every key: clear the row, prompt (with its color codes),
+ * buffer, hint, then an absolute cursor placement. While linenoise() edits a line its stdout is a filter stream.
+ * Each refresh arrives as one write; the filter keeps what the terminal shows (the last frame's text, cursor column
+ * and color state) and sends only the bytes from the first difference on, "clear to end of line" if the line got
+ * shorter, and the cursor move. Typing at the end of a line costs one byte, a cursor key a few.
+ *
+ * A frame is diffed only if it and the frame on screen fit in one terminal row. The width is taken from linenoise's
+ * own column probe ("ESC[999C" followed by the "ESC[<n>D" that restores the cursor), which gives a lower bound.
+ * Anything else (wrapped lines, completion lists, screen clears, the probe itself) passes through unchanged and the
+ * next frame is sent in full. So is a frame after CLI_REDRAW_REFRESH_MS without keys, which repaints the line if log
+ * output from another task ran over it in between.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <argtable3/argtable3.h>
+#include <esp_console.h>
+#include <esp_timer.h>
+#include <inttypes.h>
+#include <linenoise/linenoise.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cli-internal.h"
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+/** Largest refresh frame: prompt, line, hint and escape sequences */
+#define CLI_REDRAW_FRAME_MAX (CLI_PROMPT_MAX_LEN + CLI_MAX_CMDLINE_LENGTH + 128)
+
+/** Color state kept for the terminal: SGR sequences since the last reset */
+#define CLI_REDRAW_SGR_MAX 32
+
+#define ESC "\x1b"
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief A refresh frame that leaves one row on screen
+ */
+typedef struct
+{
+  const char *text;             /**< Prompt, line and hint with their color codes */
+  size_t len;                   /**< Bytes of text */
+  uint16_t width;               /**< Columns text occupies */
+  uint16_t cursor;              /**< Cursor column the frame ends at */
+  bool row_start;               /**< Frame only clears its own row (linenoise drew one row before) */
+  char sgr[CLI_REDRAW_SGR_MAX]; /**< Color state after text */
+  size_t sgr_len;               /**< Bytes of sgr */
+} cli_redraw_frame_t;
+
+/**
+ * @brief Filter state
+ */
+typedef struct
+{
+  FILE *stream;                        /**< Filter stream, stdout of linenoise() */
+  FILE *out;                           /**< Real stdout while the filter is installed */
+  bool shown;                          /**< text/cursor/sgr describe the terminal row */
+  char text[CLI_REDRAW_FRAME_MAX];     /**< Text of the frame on screen */
+  size_t len;                          /**< Bytes of text */
+  uint16_t width;                      /**< Columns of text */
+  uint16_t cursor;                     /**< Cursor column */
+  char sgr[CLI_REDRAW_SGR_MAX];        /**< Color state of the terminal */
+  size_t sgr_len;                      /**< Bytes of sgr */
+  uint16_t cols;                       /**< Terminal width (lower bound), 0 = unknown */
+  bool probing;                        /**< linenoise is measuring the width */
+  int64_t last_us;                     /**< Time of the last frame */
+  char buf[CLI_REDRAW_FRAME_MAX + 64]; /**< Output being built */
+  uint32_t frames;                     /**< Refresh frames */
+  uint32_t diffs;                      /**< Frames sent as a diff */
+  uint64_t bytes_in;                   /**< Bytes linenoise wrote for those frames */
+  uint64_t bytes_out;                  /**< Bytes actually sent for them */
+  uint32_t last_in;                    /**< Bytes of the last frame */
+  uint32_t last_out;                   /**< Bytes sent for the last frame */
+} cli_redraw_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_redraw_t s_redraw = {0};
+
+static struct
+{
+  struct arg_lit *reset;
+  struct arg_end *end;
+} redraw_stats_args;
+
+/* ========================================================================== */
+/*                              FRAME PARSING                                 */
+/* ========================================================================== */
+
+/**
+ * @brief Length of the escape sequence at s (ESC '[' params final), 0 if incomplete
+ */
+static size_t cli_redraw_esc_len(const char *s, size_t len)
+{
+  if (len < 2 || s[0] != '\x1b' || s[1] != '[')
+    return 0;
+  for (size_t i = 2; i < len; i++)
+    if (s[i] >= 0x40 && s[i] <= 0x7E)
+      return i + 1;
+  return 0;
+}
+
+/**
+ * @brief Apply an SGR sequence to a color state; a leading 0 (or no parameter) resets it
+ *
+ * @return false if the state does not fit
+ */
+static bool cli_redraw_sgr(char *sgr, size_t *sgr_len, const char *seq, size_t len)
+{
+  if (seq[2] == 'm' || (seq[2] == '0' && (seq[3] == 'm' || seq[3] == ';')))
+  {
+    *sgr_len = 0;
+    if (seq[2] == 'm' || seq[3] == 'm')
+      return true;
+  }
+  if (*sgr_len + len > CLI_REDRAW_SGR_MAX)
+    return false;
+  memcpy(&sgr[*sgr_len], seq, len);
+  *sgr_len += len;
+  return true;
+}
+
+/**
+ * @brief Columns and color state after the first len bytes of text (printable bytes and SGR sequences only)
+ *
+ * @return false if text holds anything else
+ */
+static bool cli_redraw_scan(const char *text, size_t len, uint16_t *width, char *sgr, size_t *sgr_len)
+{
+  *width = 0;
+  *sgr_len = 0;
+  for (size_t i = 0; i < len;)
+  {
+    uint8_t c = text[i];
+    if (c == '\x1b')
+    {
+      size_t n = cli_redraw_esc_len(&text[i], len - i);
+      if (n == 0 || text[i + n - 1] != 'm' || !cli_redraw_sgr(sgr, sgr_len, &text[i], n))
+        return false;
+      i += n;
+      continue;
+    }
+    if (c < 0x20 || c == 0x7F)
+      return false;
+    if ((c & 0xC0) != 0x80) /* UTF-8 continuation bytes take no column */
+      (*width)++;
+    i++;
+  }
+  return true;
+}
+
+/**
+ * @brief Recognize a multi-line mode refresh: row clears, text, "\r" and an optional "ESC[<n>C"
+ *
+ * @return false if buf is not a refresh or leaves more than one row on screen
+ */
+static bool cli_redraw_parse(const char *buf, size_t size, cli_redraw_frame_t *f)
+{
+  static const char clear[] = "\r" ESC "[0K";
+  const size_t clear_len = sizeof(clear) - 1;
+
+  /* Text starts after the last row clear and ends at the last "\r" */
+  const char *start = NULL;
+  for (size_t i = 0; i + clear_len <= size; i++)
+    if (memcmp(&buf[i], clear, clear_len) == 0)
+      start = &buf[i + clear_len];
+  if (start == NULL)
+    return false;
+  const char *end = memrchr(start, '\r', size - (start - buf));
+  if (end == NULL)
+    return false;
+
+  const char *tail = end + 1;
+  size_t tail_len = size - (tail - buf);
+  unsigned cursor = 0;
+  if (tail_len > 0)
+  {
+    char *num_end;
+    if (tail_len < 4 || tail[0] != '\x1b' || tail[1] != '[' || tail[tail_len - 1] != 'C')
+      return false;
+    cursor = strtoul(&tail[2], &num_end, 10);
+    if (num_end != &tail[tail_len - 1])
+      return false;
+  }
+
+  f->text = start;
+  f->len = end - start;
+  f->cursor = cursor;
+  f->row_start = (start == buf + clear_len);
+  if (f->len > CLI_REDRAW_FRAME_MAX || !cli_redraw_scan(f->text, f->len, &f->width, f->sgr, &f->sgr_len))
+    return false;
+
+  return s_redraw.cols > 0 && f->width < s_redraw.cols && f->cursor <= f->width;
+}
+
+/* ========================================================================== */
+/*                                 DIFF                                       */
+/* ========================================================================== */
+
+/**
+ * @brief Shortest relative cursor move between two columns of the row
+ */
+static size_t cli_redraw_move(char *p, uint16_t from, uint16_t to)
+{
+  if (to == from)
+    return 0;
+  if (to == 0)
+  {
+    *p = '\r';
+    return 1;
+  }
+  if (to < from && from - to <= 3)
+  {
+    memset(p, '\b', from - to);
+    return from - to;
+  }
+  return sprintf(p, ESC "[%u%c", (unsigned)abs(to - from), (to < from) ? 'D' : 'C');
+}
+
+/**
+ * @brief Build the bytes that turn the row on screen into frame f
+ */
+static size_t cli_redraw_diff(const cli_redraw_frame_t *f)
+{
+  const char *old = s_redraw.text;
+  size_t min = (f->len < s_redraw.len) ? f->len : s_redraw.len;
+
+  /* Common prefix, backed off to the start of an escape sequence or UTF-8 character it ends in */
+  size_t same = 0;
+  size_t esc_at = SIZE_MAX;
+  while (same < min && old[same] == f->text[same])
+  {
+    if (f->text[same] == '\x1b')
+      esc_at = same;
+    else if (esc_at != SIZE_MAX && f->text[same] >= 0x40 && f->text[same] <= 0x7E && f->text[same] != '[')
+      esc_at = SIZE_MAX;
+    same++;
+  }
+  if (esc_at != SIZE_MAX)
+    same = esc_at;
+  while (same > 0 && ((same < f->len && (f->text[same] & 0xC0) == 0x80) ||
+                      (same < s_redraw.len && (old[same] & 0xC0) == 0x80)))
+    same--;
+
+  char *p = s_redraw.buf;
+  if (same == f->len && same == s_redraw.len)
+  {
+    p += cli_redraw_move(p, s_redraw.cursor, f->cursor);
+    return p - s_redraw.buf;
+  }
+
+  /* Terminal state where the frames part: column and colors */
+  uint16_t col;
+  char sgr[CLI_REDRAW_SGR_MAX];
+  size_t sgr_len;
+  cli_redraw_scan(f->text, same, &col, sgr, &sgr_len);
+
+  p += cli_redraw_move(p, s_redraw.cursor, col);
+  if (sgr_len != s_redraw.sgr_len || memcmp(sgr, s_redraw.sgr, sgr_len) != 0)
+  {
+    memcpy(p, ESC "[0m", 4);
+    p += 4;
+    memcpy(p, sgr, sgr_len);
+    p += sgr_len;
+  }
+  memcpy(p, &f->text[same], f->len - same);
+  p += f->len - same;
+  if (f->width < s_redraw.width)
+  {
+    memcpy(p, ESC "[0K", 4);
+    p += 4;
+  }
+  p += cli_redraw_move(p, f->width, f->cursor);
+
+  return p - s_redraw.buf;
+}
+
+/* ========================================================================== */
+/*                                 FILTER                                     */
+/* ========================================================================== */
+
+static void cli_redraw_send(const char *buf, size_t size)
+{
+  fwrite(buf, 1, size, s_redraw.out);
+  fflush(s_redraw.out);
+  /* As linenoise's own flush: the bytes are on the wire before it reads a reply */
+  fsync(fileno(s_redraw.out));
+}
+
+static ssize_t cli_redraw_write(void *cookie, const char *buf, size_t size)
+{
+  cli_redraw_frame_t f;
+  int64_t now = esp_timer_get_time();
+
+  if (!cli_redraw_parse(buf, size, &f))
+  {
+    /* Width probe: "ESC[999C", a position report, then "ESC[<n>D" back to the start column (at least 1) */
+    if (size == 6 && memcmp(buf, ESC "[999C", 6) == 0)
+      s_redraw.probing = true;
+    else if (s_redraw.probing && size > 3 && buf[0] == '\x1b' && buf[size - 1] == 'D')
+    {
+      s_redraw.cols = atoi(&buf[2]) + 1;
+      s_redraw.probing = false;
+    }
+    s_redraw.shown = false;
+    cli_redraw_send(buf, size);
+    return size;
+  }
+
+  const char *out = buf;
+  size_t out_len = size;
+  if (s_redraw.shown && f.row_start && now - s_redraw.last_us < CLI_REDRAW_REFRESH_MS * 1000LL)
+  {
+    out = s_redraw.buf;
+    out_len = cli_redraw_diff(&f);
+    s_redraw.diffs++;
+  }
+  cli_redraw_send(out, out_len);
+
+  memcpy(s_redraw.text, f.text, f.len);
+  s_redraw.len = f.len;
+  s_redraw.width = f.width;
+  s_redraw.cursor = f.cursor;
+  memcpy(s_redraw.sgr, f.sgr, f.sgr_len);
+  s_redraw.sgr_len = f.sgr_len;
+  s_redraw.shown = true;
+  s_redraw.last_us = now;
+
+  s_redraw.frames++;
+  s_redraw.bytes_in += size;
+  s_redraw.bytes_out += out_len;
+  s_redraw.last_in = size;
+  s_redraw.last_out = out_len;
+
+  return size;
+}
+
+/* ========================================================================== */
+/*                               COMMAND                                      */
+/* ========================================================================== */
+
+static int redraw_stats(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&redraw_stats_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, redraw_stats_args.end, argv[0]);
+    return 1;
+  }
+
+  if (redraw_stats_args.reset->count > 0)
+  {
+    s_redraw.frames = 0;
+    s_redraw.diffs = 0;
+    s_redraw.bytes_in = 0;
+    s_redraw.bytes_out = 0;
+    printf("Redraw statistics reset\n");
+    return 0;
+  }
+
+  uint32_t frames = s_redraw.frames;
+  printf("Refreshes:     %" PRIu32 " (%" PRIu32 " as diff, %" PRIu32 " in full)\n",
+         frames,
+         s_redraw.diffs,
+         frames - s_redraw.diffs);
+  printf("Full redraw:   %" PRIu64 " B, avg %.1f B per refresh\n",
+         s_redraw.bytes_in,
+         frames ? (double)s_redraw.bytes_in / frames : 0.0);
+  printf("Sent:          %" PRIu64 " B, avg %.1f B per refresh (%.1f%%)\n",
+         s_redraw.bytes_out,
+         frames ? (double)s_redraw.bytes_out / frames : 0.0,
+         s_redraw.bytes_in ? 100.0 * s_redraw.bytes_out / s_redraw.bytes_in : 0.0);
+  printf("Last refresh:  %" PRIu32 " B sent instead of %" PRIu32 " B\n", s_redraw.last_out, s_redraw.last_in);
+  printf("Terminal:      %u columns%s\n", s_redraw.cols, s_redraw.cols ? "" : " (unknown, every refresh in full)");
+
+  return 0;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+void cli_redraw_begin(void)
+{
+  if (s_redraw.stream == NULL)
+    return;
+
+  s_redraw.shown = false;
+  s_redraw.probing = false;
+  s_redraw.out = stdout;
+  stdout = s_redraw.stream;
+}
+
+void cli_redraw_end(void)
+{
+  if (s_redraw.stream == NULL)
+    return;
+
+  fflush(s_redraw.stream);
+  stdout = s_redraw.out;
+}
+
+esp_err_t cli_redraw_init(void)
+{
+  if (linenoiseIsDumbMode())
+    return ESP_ERR_NOT_SUPPORTED;
+
+  if (s_redraw.stream == NULL)
+  {
+    const cookie_io_functions_t io = {.write = cli_redraw_write};
+    FILE *stream = fopencookie(NULL, "w", io);
+    if (stream == NULL)
+      return ESP_ERR_NO_MEM;
+    /* Large enough that each linenoise fwrite() + fflush() reaches the filter as one write */
+    if (setvbuf(stream, NULL, _IOFBF, CLI_REDRAW_FRAME_MAX) != 0)
+    {
+      fclose(stream);
+      return ESP_ERR_NO_MEM;
+    }
+    s_redraw.stream = stream;
+  }
+
+  redraw_stats_args.reset = arg_lit0(NULL, "reset", "Clear the counters");
+  redraw_stats_args.end = arg_end(1);
+
+  const esp_console_cmd_t cmd = {.command = "redraw_stats",
+                                 .help = "Show the bytes sent per line editor refresh, as diff and in full",
+                                 .hint = NULL,
+                                 .func = &redraw_stats,
+                                 .argtable = &redraw_stats_args};
+
+  return esp_console_cmd_register(&cmd);
+}
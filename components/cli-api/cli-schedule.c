@@ -0,0 +1,747 @@
+/**
+ * @file cli-schedule.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Periodic and cron-style execution of console commands.
+ *
+ * Command lines are tokenized once when an entry is added (or loaded at boot), then executed from a single task
+ * woken every second by an esp_timer. The entry list is persisted in NVS as a single blob.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <argtable3/argtable3.h>
+#include <ctype.h>
+#include <esp_console.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+#include <nvs.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cli-internal.h"
+
+static const char *TAG = "cli-schedule";
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+#define CLI_SCHEDULE_NVS_NAMESPACE "cli_sched"
+#define CLI_SCHEDULE_NVS_KEY       "entries"
+#define CLI_SCHEDULE_TICK_US       (1000 * 1000)
+#define CLI_SCHEDULE_TASK_STACK    4096
+#define CLI_SCHEDULE_TASK_PRIO     2
+
+/** Wall clock is considered valid (set by SNTP/RTC) after 2020-01-01 */
+#define CLI_SCHEDULE_MIN_VALID_TIME 1577836800
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Kind of schedule specification
+ */
+typedef enum
+{
+  CLI_SCHEDULE_PERIOD, /**< Fixed period (ex: "30s", "5m") */
+  CLI_SCHEDULE_CRON,   /**< 5-field cron expression (ex: "*\/5 * * * *") */
+} cli_schedule_kind_t;
+
+/**
+ * @brief Cron expression as one bitmap per field (bit n set = value n matches)
+ */
+typedef struct
+{
+  uint64_t minute; /**< 0-59 */
+  uint32_t hour;   /**< 0-23 */
+  uint32_t mday;   /**< 1-31 */
+  uint16_t month;  /**< 1-12 */
+  uint8_t wday;    /**< 0-6, Sunday = 0 */
+  bool mday_any;   /**< Day-of-month field was '*' */
+  bool wday_any;   /**< Day-of-week field was '*' */
+} cli_cron_t;
+
+/**
+ * @brief Persisted form of an entry, stored as an array in a single NVS blob
+ */
+typedef struct
+{
+  char spec[CLI_SCHEDULE_SPEC_MAX_LEN]; /**< Schedule specification, empty if slot unused */
+  char line[CLI_SCHEDULE_LINE_MAX_LEN]; /**< Command line */
+} cli_schedule_record_t;
+
+/**
+ * @brief Scheduled entry with its pre-parsed command and run statistics
+ */
+typedef struct
+{
+  cli_schedule_record_t rec;              /**< Persisted specification and command line */
+  cli_schedule_kind_t kind;               /**< Kind of specification */
+  uint32_t period_s;                      /**< Period in seconds (CLI_SCHEDULE_PERIOD) */
+  cli_cron_t cron;                        /**< Parsed cron expression (CLI_SCHEDULE_CRON) */
+  char argbuf[CLI_SCHEDULE_LINE_MAX_LEN]; /**< Tokenized copy of the command line */
+  char *argv[CLI_MAX_ARGS];               /**< Tokens pointing into argbuf */
+  int argc;                               /**< Number of tokens */
+  int64_t next_run_us;                    /**< Next run time (CLI_SCHEDULE_PERIOD) */
+  uint32_t runs;                          /**< Number of executions */
+  uint32_t failures;                      /**< Executions with an error or non-zero return */
+  int last_ret;                           /**< Last return code */
+  uint32_t last_us;                       /**< Duration of the last execution */
+  uint32_t max_us;                        /**< Longest execution */
+  uint64_t total_us;                      /**< Sum of all execution times */
+} cli_schedule_entry_t;
+
+/**
+ * @brief Internal scheduler state
+ */
+typedef struct
+{
+  cli_schedule_entry_t entries[CLI_SCHEDULE_MAX_ENTRIES]; /**< Entry slots, index is the entry ID */
+  esp_timer_handle_t timer;                               /**< Periodic tick */
+  TaskHandle_t task;                                      /**< Task executing the entries */
+  int64_t last_minute;                                    /**< Last wall-clock minute evaluated for cron entries */
+} cli_schedule_state_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_schedule_state_t s_sched = {
+  .timer = NULL,
+  .task = NULL,
+  .last_minute = -1,
+};
+
+static struct
+{
+  struct arg_str *spec;
+  struct arg_str *command;
+  struct arg_end *end;
+} schedule_add_args;
+
+static struct
+{
+  struct arg_int *id;
+  struct arg_end *end;
+} schedule_rm_args;
+
+/* ========================================================================== */
+/*                         SPECIFICATION PARSING                              */
+/* ========================================================================== */
+
+/**
+ * @brief Parse a period such as "90", "30s", "5m", "2h" or "1d" into seconds
+ */
+static bool cli_schedule_parse_period(const char *spec, uint32_t *period_s)
+{
+  char *end;
+  unsigned long value = strtoul(spec, &end, 10);
+  if (end == spec || value == 0)
+    return false;
+
+  unsigned long mult = 1;
+  switch (*end)
+  {
+    case '\0':
+    case 's':
+      break;
+    case 'm':
+      mult = 60;
+      break;
+    case 'h':
+      mult = 3600;
+      break;
+    case 'd':
+      mult = 86400;
+      break;
+    default:
+      return false;
+  }
+
+  if (*end != '\0' && end[1] != '\0')
+    return false;
+
+  if (value > UINT32_MAX / mult)
+    return false;
+
+  *period_s = value * mult;
+  return true;
+}
+
+/**
+ * @brief Parse one cron field ("*", "*\/n", "a", "a-b", "a-b/n", comma separated) into a bitmap
+ */
+static bool cli_cron_parse_field(const char *field, size_t len, int min, int max, uint64_t *bits)
+{
+  *bits = 0;
+  const char *p = field;
+  const char *field_end = field + len;
+
+  while (p < field_end)
+  {
+    const char *item_end = memchr(p, ',', field_end - p);
+    if (item_end == NULL)
+      item_end = field_end;
+
+    int lo = min;
+    int hi = max;
+    int step = 1;
+    char *end;
+
+    if (*p == '*')
+    {
+      end = (char *)p + 1;
+    }
+    else
+    {
+      lo = (int)strtol(p, &end, 10);
+      if (end == p)
+        return false;
+      hi = lo;
+      if (end < item_end && *end == '-')
+      {
+        const char *hi_start = end + 1;
+        hi = (int)strtol(hi_start, &end, 10);
+        if (end == hi_start)
+          return false;
+      }
+    }
+
+    if (end < item_end && *end == '/')
+    {
+      const char *step_start = end + 1;
+      step = (int)strtol(step_start, &end, 10);
+      if (end == step_start || step <= 0)
+        return false;
+      /* "a/n" means "a-max/n" */
+      if (*p != '*' && hi == lo)
+        hi = max;
+    }
+
+    if (end != item_end || lo < min || hi > max || lo > hi)
+      return false;
+
+    for (int v = lo; v <= hi; v += step) *bits |= 1ULL << v;
+
+    p = item_end + 1;
+  }
+
+  return *bits != 0;
+}
+
+/**
+ * @brief Parse a 5-field cron expression "minute hour day-of-month month day-of-week"
+ */
+static bool cli_schedule_parse_cron(const char *spec, cli_cron_t *cron)
+{
+  static const struct
+  {
+    int min;
+    int max;
+  } limits[5] = {{0, 59}, {0, 23}, {1, 31}, {1, 12}, {0, 7}};
+
+  uint64_t fields[5];
+  bool any[5];
+  const char *p = spec;
+
+  for (int i = 0; i < 5; i++)
+  {
+    while (isspace((unsigned char)*p)) p++;
+    const char *start = p;
+    while (*p != '\0' && !isspace((unsigned char)*p)) p++;
+    if (p == start)
+      return false;
+
+    any[i] = (p - start == 1 && *start == '*');
+    if (!cli_cron_parse_field(start, p - start, limits[i].min, limits[i].max, &fields[i]))
+      return false;
+  }
+
+  while (isspace((unsigned char)*p)) p++;
+  if (*p != '\0')
+    return false;
+
+  /* Day-of-week 7 is an alias for Sunday */
+  if (fields[4] & (1ULL << 7))
+    fields[4] = (fields[4] | 1ULL) & 0x7F;
+
+  cron->minute = fields[0];
+  cron->hour = (uint32_t)fields[1];
+  cron->mday = (uint32_t)fields[2];
+  cron->month = (uint16_t)fields[3];
+  cron->wday = (uint8_t)fields[4];
+  cron->mday_any = any[2];
+  cron->wday_any = any[4];
+
+  return true;
+}
+
+/**
+ * @brief Check whether a broken-down local time matches a cron expression
+ */
+static bool cli_cron_matches(const cli_cron_t *cron, const struct tm *tm)
+{
+  if (!(cron->minute & (1ULL << tm->tm_min)) || !(cron->hour & (1UL << tm->tm_hour)) ||
+      !(cron->month & (1U << (tm->tm_mon + 1))))
+    return false;
+
+  bool mday = (cron->mday & (1UL << tm->tm_mday)) != 0;
+  bool wday = (cron->wday & (1U << tm->tm_wday)) != 0;
+
+  /* Standard cron: when both day fields are restricted, either one may match */
+  if (!cron->mday_any && !cron->wday_any)
+    return mday || wday;
+
+  return mday && wday;
+}
+
+/**
+ * @brief Parse the specification and tokenize the command line of an entry
+ */
+static esp_err_t cli_schedule_prepare(cli_schedule_entry_t *entry)
+{
+  if (strchr(entry->rec.spec, ' ') != NULL)
+  {
+    if (!cli_schedule_parse_cron(entry->rec.spec, &entry->cron))
+      return ESP_ERR_INVALID_ARG;
+    entry->kind = CLI_SCHEDULE_CRON;
+  }
+  else
+  {
+    if (!cli_schedule_parse_period(entry->rec.spec, &entry->period_s))
+      return ESP_ERR_INVALID_ARG;
+    entry->kind = CLI_SCHEDULE_PERIOD;
+    entry->next_run_us = esp_timer_get_time() + (int64_t)entry->period_s * 1000000;
+  }
+
+  strlcpy(entry->argbuf, entry->rec.line, sizeof(entry->argbuf));
+  entry->argc = esp_console_split_argv(entry->argbuf, entry->argv, CLI_MAX_ARGS);
+  if (entry->argc == 0)
+    return ESP_ERR_INVALID_ARG;
+
+  return ESP_OK;
+}
+
+/* ========================================================================== */
+/*                              PERSISTENCE                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Write all entry slots to NVS as one blob
+ */
+static esp_err_t cli_schedule_save(void)
+{
+  cli_schedule_record_t *records = calloc(CLI_SCHEDULE_MAX_ENTRIES, sizeof(cli_schedule_record_t));
+  if (records == NULL)
+    return ESP_ERR_NO_MEM;
+
+  for (int i = 0; i < CLI_SCHEDULE_MAX_ENTRIES; i++) records[i] = s_sched.entries[i].rec;
+
+  nvs_handle_t nvs;
+  esp_err_t err = nvs_open(CLI_SCHEDULE_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+  if (err == ESP_OK)
+  {
+    err = nvs_set_blob(nvs, CLI_SCHEDULE_NVS_KEY, records, CLI_SCHEDULE_MAX_ENTRIES * sizeof(cli_schedule_record_t));
+    if (err == ESP_OK)
+      err = nvs_commit(nvs);
+    nvs_close(nvs);
+  }
+
+  free(records);
+  return err;
+}
+
+/**
+ * @brief Load entries from NVS and pre-parse them
+ */
+static esp_err_t cli_schedule_load(void)
+{
+  nvs_handle_t nvs;
+  esp_err_t err = nvs_open(CLI_SCHEDULE_NVS_NAMESPACE, NVS_READONLY, &nvs);
+  if (err == ESP_ERR_NVS_NOT_FOUND)
+    return ESP_OK;
+  if (err != ESP_OK)
+    return err;
+
+  size_t len = 0;
+  err = nvs_get_blob(nvs, CLI_SCHEDULE_NVS_KEY, NULL, &len);
+  if (err != ESP_OK || len == 0 || len % sizeof(cli_schedule_record_t) != 0)
+  {
+    nvs_close(nvs);
+    return (err == ESP_ERR_NVS_NOT_FOUND) ? ESP_OK : err;
+  }
+
+  cli_schedule_record_t *records = malloc(len);
+  if (records == NULL)
+  {
+    nvs_close(nvs);
+    return ESP_ERR_NO_MEM;
+  }
+
+  err = nvs_get_blob(nvs, CLI_SCHEDULE_NVS_KEY, records, &len);
+  nvs_close(nvs);
+
+  size_t count = len / sizeof(cli_schedule_record_t);
+  for (size_t i = 0; err == ESP_OK && i < count && i < CLI_SCHEDULE_MAX_ENTRIES; i++)
+  {
+    if (records[i].spec[0] == '\0')
+      continue;
+
+    cli_schedule_entry_t *entry = &s_sched.entries[i];
+    entry->rec = records[i];
+    entry->rec.spec[CLI_SCHEDULE_SPEC_MAX_LEN - 1] = '\0';
+    entry->rec.line[CLI_SCHEDULE_LINE_MAX_LEN - 1] = '\0';
+
+    if (cli_schedule_prepare(entry) != ESP_OK)
+    {
+      ESP_LOGW(TAG, "Dropping invalid persisted entry %u ('%s')", (unsigned)i, entry->rec.spec);
+      memset(entry, 0, sizeof(*entry));
+      continue;
+    }
+
+    ESP_LOGI(TAG, "Restored entry %u: [%s] %s", (unsigned)i, entry->rec.spec, entry->rec.line);
+  }
+
+  free(records);
+  return err;
+}
+
+/* ========================================================================== */
+/*                              EXECUTION                                     */
+/* ========================================================================== */
+
+/**
+ * @brief Execute one entry and update its statistics
+ */
+static void cli_schedule_run(cli_schedule_entry_t *entry)
+{
+  int ret = 0;
+  int64_t start = esp_timer_get_time();
+
+  esp_err_t err = cli_exec_argv(CLI_SESSION_SCHEDULER, entry->argc, entry->argv, &ret);
+  if (err == ESP_ERR_NOT_FOUND)
+    err = cli_exec_line(CLI_SESSION_SCHEDULER, entry->rec.line, &ret);
+
+  uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+  entry->runs++;
+  entry->last_ret = (err == ESP_OK) ? ret : err;
+  entry->last_us = elapsed;
+  entry->total_us += elapsed;
+  if (elapsed > entry->max_us)
+    entry->max_us = elapsed;
+
+  if (err != ESP_OK || ret != 0)
+  {
+    entry->failures++;
+    ESP_LOGW(TAG, "'%s' failed: %s (ret %d)", entry->rec.line, esp_err_to_name(err), ret);
+  }
+}
+
+/**
+ * @brief esp_timer callback: wake up the scheduler task
+ */
+static void cli_schedule_tick(void *arg)
+{
+  xTaskNotifyGive(s_sched.task);
+}
+
+/**
+ * @brief Scheduler task: on every tick, run the entries that are due
+ */
+static void cli_schedule_task(void *arg)
+{
+  while (true)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    int64_t now_us = esp_timer_get_time();
+
+    /* Cron entries are evaluated once per wall-clock minute, and only once the clock has been set */
+    time_t now = time(NULL);
+    int64_t minute = (int64_t)now / 60;
+    bool cron_due = (now >= CLI_SCHEDULE_MIN_VALID_TIME && minute != s_sched.last_minute);
+    struct tm tm_now = {0};
+    if (cron_due)
+    {
+      s_sched.last_minute = minute;
+      localtime_r(&now, &tm_now);
+    }
+
+    cli_lock();
+    for (int i = 0; i < CLI_SCHEDULE_MAX_ENTRIES; i++)
+    {
+      cli_schedule_entry_t *entry = &s_sched.entries[i];
+      if (entry->rec.spec[0] == '\0')
+        continue;
+
+      if (entry->kind == CLI_SCHEDULE_PERIOD && now_us >= entry->next_run_us)
+      {
+        cli_schedule_run(entry);
+        entry->next_run_us += (int64_t)entry->period_s * 1000000;
+        /* Skip missed periods instead of running them back to back */
+        if (entry->next_run_us <= now_us)
+          entry->next_run_us = now_us + (int64_t)entry->period_s * 1000000;
+      }
+      else if (entry->kind == CLI_SCHEDULE_CRON && cron_due && cli_cron_matches(&entry->cron, &tm_now))
+      {
+        cli_schedule_run(entry);
+      }
+    }
+    cli_unlock();
+  }
+}
+
+/* ========================================================================== */
+/*                               COMMANDS                                     */
+/* ========================================================================== */
+
+static int schedule_add(int argc, char **argv)
+{
+  /* Only the specification and the command name go through arg_parse, so options of the scheduled command
+     (schedule_add 10s gpio_capture -m 0x10) are not taken as options of schedule_add. The command line is
+     taken verbatim from argv[2] on. */
+  int nerrors = arg_parse(argc < 3 ? argc : 3, argv, (void **)&schedule_add_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, schedule_add_args.end, argv[0]);
+    return 1;
+  }
+
+  int slot = -1;
+  for (int i = 0; i < CLI_SCHEDULE_MAX_ENTRIES; i++)
+  {
+    if (s_sched.entries[i].rec.spec[0] == '\0')
+    {
+      slot = i;
+      break;
+    }
+  }
+  if (slot < 0)
+  {
+    printf("ERROR: Schedule full (%d entries)\n", CLI_SCHEDULE_MAX_ENTRIES);
+    return 1;
+  }
+
+  cli_schedule_entry_t entry = {0};
+  if (strlcpy(entry.rec.spec, schedule_add_args.spec->sval[0], sizeof(entry.rec.spec)) >= sizeof(entry.rec.spec) ||
+      !cli_join_argv(entry.rec.line, sizeof(entry.rec.line), argc - 2, (const char *const *)&argv[2]))
+  {
+    printf("ERROR: Specification or command line too long\n");
+    return 1;
+  }
+
+  if (cli_schedule_prepare(&entry) != ESP_OK)
+  {
+    printf("ERROR: Invalid schedule '%s'. Use a period (30s, 5m, 2h, 1d) or a quoted cron expression "
+           "(\"*/5 * * * *\")\n",
+           entry.rec.spec);
+    return 1;
+  }
+
+  if (strncmp(entry.argv[0], "schedule_", strlen("schedule_")) == 0)
+  {
+    printf("ERROR: Schedule commands cannot be scheduled\n");
+    return 1;
+  }
+
+  /* Commands registered through cli-api are validated now instead of failing at every run */
+  if (cli_check_argv(entry.argc, entry.argv) == ESP_ERR_INVALID_ARG)
+    return 1;
+
+  s_sched.entries[slot] = entry;
+  esp_err_t err = cli_schedule_save();
+  if (err != ESP_OK)
+    printf("WARNING: Entry not persisted: %s\n", esp_err_to_name(err));
+
+  printf("Entry %d added: [%s] %s\n", slot, entry.rec.spec, entry.rec.line);
+  return 0;
+}
+
+static int schedule_list(int argc, char **argv)
+{
+  int64_t now_us = esp_timer_get_time();
+  bool any = false;
+
+  printf("%-3s %-16s %6s %5s %5s %9s %9s %7s  %s\n",
+         "ID",
+         "Schedule",
+         "Runs",
+         "Fail",
+         "Ret",
+         "Avg ms",
+         "Max ms",
+         "Next s",
+         "Command");
+
+  for (int i = 0; i < CLI_SCHEDULE_MAX_ENTRIES; i++)
+  {
+    const cli_schedule_entry_t *entry = &s_sched.entries[i];
+    if (entry->rec.spec[0] == '\0')
+      continue;
+
+    any = true;
+    uint32_t avg_us = entry->runs ? (uint32_t)(entry->total_us / entry->runs) : 0;
+    char next[12] = "-";
+    if (entry->kind == CLI_SCHEDULE_PERIOD)
+      snprintf(next, sizeof(next), "%" PRId64, (entry->next_run_us - now_us + 999999) / 1000000);
+
+    printf("%-3d %-16s %6" PRIu32 " %5" PRIu32 " %5d %9.2f %9.2f %7s  %s\n",
+           i,
+           entry->rec.spec,
+           entry->runs,
+           entry->failures,
+           entry->last_ret,
+           avg_us / 1000.0,
+           entry->max_us / 1000.0,
+           next,
+           entry->rec.line);
+  }
+
+  if (!any)
+    printf("(no entries)\n");
+
+  return 0;
+}
+
+static int schedule_rm(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&schedule_rm_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, schedule_rm_args.end, argv[0]);
+    return 1;
+  }
+
+  int id = schedule_rm_args.id->ival[0];
+  if (id < 0 || id >= CLI_SCHEDULE_MAX_ENTRIES || s_sched.entries[id].rec.spec[0] == '\0')
+  {
+    printf("ERROR: No entry with ID %d\n", id);
+    return 1;
+  }
+
+  memset(&s_sched.entries[id], 0, sizeof(s_sched.entries[id]));
+
+  esp_err_t err = cli_schedule_save();
+  if (err != ESP_OK)
+  {
+    printf("ERROR: Failed to persist: %s\n", esp_err_to_name(err));
+    return 1;
+  }
+
+  printf("Entry %d removed\n", id);
+  return 0;
+}
+
+static esp_err_t cli_schedule_register_commands(void)
+{
+  schedule_add_args.spec = arg_str1(NULL, NULL, "<period|cron>", "Period (30s, 5m, 2h, 1d) or quoted cron expression");
+  schedule_add_args.command =
+    arg_strn(NULL, NULL, "<command>", 1, CLI_MAX_ARGS - 2, "Command line to execute, options included");
+  schedule_add_args.end = arg_end(2);
+
+  schedule_rm_args.id = arg_int1(NULL, NULL, "<id>", "Entry ID (see schedule_list)");
+  schedule_rm_args.end = arg_end(1);
+
+  const esp_console_cmd_t add_cmd = {.command = "schedule_add",
+                                     .help = "Run a command periodically. Entries persist across reboots.\n"
+                                             "Examples:\n"
+                                             " schedule_add 30s free\n"
+                                             " schedule_add 5m gpio_capture -m 0x10 -n 100\n"
+                                             " schedule_add \"0 */6 * * *\" nvs_list nvs\n",
+                                     .hint = NULL,
+                                     .func = &schedule_add,
+                                     .argtable = &schedule_add_args};
+
+  const esp_console_cmd_t list_cmd = {.command = "schedule_list",
+                                      .help = "List scheduled commands with their run statistics",
+                                      .hint = NULL,
+                                      .func = &schedule_list};
+
+  const esp_console_cmd_t rm_cmd = {.command = "schedule_rm",
+                                    .help = "Remove a scheduled command",
+                                    .hint = NULL,
+                                    .func = &schedule_rm,
+                                    .argtable = &schedule_rm_args};
+
+  esp_err_t err = esp_console_cmd_register(&add_cmd);
+  if (err == ESP_OK)
+    err = esp_console_cmd_register(&list_cmd);
+  if (err == ESP_OK)
+    err = esp_console_cmd_register(&rm_cmd);
+
+  return err;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+esp_err_t cli_schedule_init(void)
+{
+  if (s_sched.task != NULL)
+    return ESP_OK;
+
+  esp_err_t err = cli_schedule_load();
+  if (err != ESP_OK)
+    ESP_LOGW(TAG, "Failed to load persisted entries: %s", esp_err_to_name(err));
+
+  err = cli_schedule_register_commands();
+  if (err != ESP_OK)
+    return err;
+
+  if (xTaskCreate(cli_schedule_task,
+                  "cli_sched",
+                  CLI_SCHEDULE_TASK_STACK,
+                  NULL,
+                  CLI_SCHEDULE_TASK_PRIO,
+                  &s_sched.task) != pdPASS)
+    return ESP_ERR_NO_MEM;
+
+  const esp_timer_create_args_t timer_args = {
+    .callback = cli_schedule_tick,
+    .name = "cli_sched",
+  };
+  err = esp_timer_create(&timer_args, &s_sched.timer);
+  if (err == ESP_OK)
+    err = esp_timer_start_periodic(s_sched.timer, CLI_SCHEDULE_TICK_US);
+
+  if (err != ESP_OK)
+  {
+    cli_schedule_deinit();
+    return err;
+  }
+
+  ESP_LOGI(TAG, "Scheduler started");
+  return ESP_OK;
+}
+
+void cli_schedule_deinit(void)
+{
+  if (s_sched.timer != NULL)
+  {
+    esp_timer_stop(s_sched.timer);
+    esp_timer_delete(s_sched.timer);
+    s_sched.timer = NULL;
+  }
+
+  if (s_sched.task != NULL)
+  {
+    /* Make sure the task is not halfway through an entry */
+    cli_lock();
+    vTaskDelete(s_sched.task);
+    s_sched.task = NULL;
+    cli_unlock();
+  }
+}
@@ -0,0 +1,630 @@
+/**
+ * @file cli-tcp.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief TCP console server: telnet-compatible command sessions over the network.
+ *
+ * One task serves the listening socket and every connection with non-blocking sockets and select(). Each connection
+ * is a session of its own (CLI_SESSION_TCP + slot, "tcp<N>" in the audit trail) with its own line buffer, up to
+ * CLI_TCP_MAX_SESSIONS at once; further connections are told so and closed. Lines go through cli_exec_line() like
+ * console lines, with the task's stdout and stderr sent to the connection ('\n' as "\r\n", IAC doubled). stdout is
+ * per task in ESP-IDF, so the console and other sessions are unaffected.
+ *
+ * Telnet option negotiation is stubbed: every DO is refused with WONT and every WILL with DONT, which leaves the
+ * client in its default line mode with local echo. Any telnet or raw TCP client works (telnet, nc, PuTTY). There is no
+ * line editing or history, and commands that read stdin themselves (rx, tx) still read the local console.
+ *
+ * A command runs in the server task, so a long command delays the other TCP sessions, including new connections.
+ * cli_exec_line() also holds the execution lock shared with the local console for the whole command: a long TCP
+ * command holds up the console's next command and a long console command stalls every TCP session. Output to a peer
+ * that stops reading waits up to CLI_TCP_SEND_TIMEOUT_MS once, with the lock held; the session is then marked failed,
+ * the rest of the output is dropped and the connection is closed after the command.
+ *
+ * 'metrics' exports the transport counters: bytes each way, output dropped after send failures, connections accepted
+ * and refused, and the open sessions.
+ *
+ * The server only uses BSD sockets, FreeRTOS and stdio, so it also runs on the linux target: test_apps/tcp_console
+ * checks it there over 127.0.0.1, with raw sockets and tools/cli_tcp.py.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <esp_console.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <fcntl.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "cli-internal.h"
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+#define CLI_TCP_TASK_STACK 6144
+#define CLI_TCP_TASK_PRIO  2
+#define CLI_TCP_POLL_MS    500 /**< select() timeout, how fast cli_tcp_stop() is noticed */
+#define CLI_TCP_RX_CHUNK   128
+
+/* Telnet commands (RFC 854) */
+#define TELNET_SE   240
+#define TELNET_SB   250
+#define TELNET_WILL 251
+#define TELNET_WONT 252
+#define TELNET_DO   253
+#define TELNET_DONT 254
+#define TELNET_IAC  255
+
+static const char *TAG = "cli-tcp";
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Telnet receive parser state
+ */
+typedef enum
+{
+  CLI_TCP_DATA,   /**< Plain data */
+  CLI_TCP_IAC,    /**< After IAC */
+  CLI_TCP_OPTION, /**< After IAC DO/DONT/WILL/WONT, option byte next */
+  CLI_TCP_SUB,    /**< Inside IAC SB ... IAC SE */
+  CLI_TCP_SUB_IAC /**< IAC inside a subnegotiation */
+} cli_tcp_parse_t;
+
+/**
+ * @brief One connection
+ */
+typedef struct
+{
+  int fd;                            /**< Socket, -1 if the slot is free */
+  char peer[24];                     /**< "a.b.c.d:port" */
+  char line[CLI_MAX_CMDLINE_LENGTH]; /**< Line being received */
+  size_t len;                        /**< Bytes in line */
+  bool overflow;                     /**< Line longer than the buffer, discarded at its end */
+  bool cr;                           /**< Last byte was CR (skip the LF or NUL of CR LF / CR NUL) */
+  cli_tcp_parse_t parse;             /**< Telnet parser state */
+  uint8_t verb;                      /**< DO/DONT/WILL/WONT being parsed */
+  bool failed;                       /**< Send failed or timed out: close after the command */
+  int64_t since_us;                  /**< Connection time */
+  uint32_t commands;                 /**< Lines executed */
+} cli_tcp_session_t;
+
+/**
+ * @brief Server state
+ */
+typedef struct
+{
+  TaskHandle_t task;                                /**< Server task, NULL when stopped */
+  volatile bool stop;                               /**< Asks the task to close everything and exit */
+  int listen_fd;                                    /**< Listening socket */
+  uint16_t port;                                    /**< Listening port */
+  uint32_t accepted;                                /**< Connections accepted */
+  uint32_t rejected;                                /**< Connections refused, all slots busy */
+  uint64_t bytes[2];                                /**< [0] sent, [1] received, telnet commands included */
+  uint64_t dropped;                                 /**< Output bytes dropped after a send failure or timeout */
+  cli_tcp_session_t sessions[CLI_TCP_MAX_SESSIONS]; /**< Connection slots */
+} cli_tcp_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_tcp_t s_tcp = {.listen_fd = -1};
+
+/* ========================================================================== */
+/*                                 OUTPUT                                     */
+/* ========================================================================== */
+
+/**
+ * @brief Send all of buf, waiting up to CLI_TCP_SEND_TIMEOUT_MS whenever the socket buffer is full
+ */
+static bool cli_tcp_send(cli_tcp_session_t *s, const void *buf, size_t len)
+{
+  const uint8_t *p = buf;
+
+  while (len > 0 && !s->failed)
+  {
+    ssize_t n = send(s->fd, p, len, 0);
+    if (n > 0)
+    {
+      p += n;
+      len -= n;
+      s_tcp.bytes[0] += n;
+      continue;
+    }
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+    {
+      s->failed = true;
+      break;
+    }
+
+    fd_set wfds;
+    FD_ZERO(&wfds);
+    FD_SET(s->fd, &wfds);
+    struct timeval tv = {.tv_sec = CLI_TCP_SEND_TIMEOUT_MS / 1000, .tv_usec = (CLI_TCP_SEND_TIMEOUT_MS % 1000) * 1000};
+    if (select(s->fd + 1, NULL, &wfds, NULL, &tv) <= 0)
+      s->failed = true;
+  }
+
+  if (s->failed)
+    s_tcp.dropped += len;
+  return !s->failed;
+}
+
+static int cli_tcp_printf(cli_tcp_session_t *s, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static int cli_tcp_printf(cli_tcp_session_t *s, const char *fmt, ...)
+{
+  char buf[96];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+
+  if (n > (int)sizeof(buf) - 1)
+    n = sizeof(buf) - 1;
+  return (n > 0 && cli_tcp_send(s, buf, n)) ? n : -1;
+}
+
+/**
+ * @brief Command output stream: NVT line endings, IAC escaped; output after a send failure is dropped
+ */
+static ssize_t cli_tcp_write(void *cookie, const char *buf, size_t size)
+{
+  cli_tcp_session_t *s = cookie;
+  char out[2 * CLI_TCP_RX_CHUNK];
+  size_t n = 0;
+
+  for (size_t i = 0; i < size; i++)
+  {
+    if (buf[i] == '\n')
+      out[n++] = '\r';
+    else if ((uint8_t)buf[i] == TELNET_IAC)
+      out[n++] = (char)TELNET_IAC;
+    out[n++] = buf[i];
+
+    if (n >= sizeof(out) - 1)
+    {
+      cli_tcp_send(s, out, n);
+      n = 0;
+    }
+  }
+  if (n > 0)
+    cli_tcp_send(s, out, n);
+
+  return size;
+}
+
+static void cli_tcp_prompt(cli_tcp_session_t *s)
+{
+  cli_tcp_printf(s, "tcp%d> ", (int)(s - s_tcp.sessions) + 1);
+}
+
+/* ========================================================================== */
+/*                                SESSIONS                                    */
+/* ========================================================================== */
+
+static void cli_tcp_close(cli_tcp_session_t *s)
+{
+  ESP_LOGI(TAG, "tcp%d: %s disconnected", (int)(s - s_tcp.sessions) + 1, s->peer);
+  close(s->fd);
+  s->fd = -1;
+}
+
+/**
+ * @brief Run a complete line with stdout and stderr going to the connection
+ */
+static void cli_tcp_exec(cli_tcp_session_t *s)
+{
+  s->line[s->len] = '\0';
+  s->len = 0;
+
+  const cookie_io_functions_t io = {.write = cli_tcp_write};
+  FILE *out = fopencookie(s, "w", io);
+  if (out == NULL)
+  {
+    cli_tcp_printf(s, "ERROR: Out of memory\r\n");
+    return;
+  }
+  setvbuf(out, NULL, _IOLBF, CLI_TCP_RX_CHUNK);
+
+  FILE *saved_out = stdout;
+  FILE *saved_err = stderr;
+  stdout = out;
+  stderr = out;
+
+  int ret;
+  esp_err_t err = cli_exec_line(CLI_SESSION_TCP + (s - s_tcp.sessions), s->line, &ret);
+  if (err == ESP_ERR_NOT_FOUND)
+    printf("Command not recognized\n");
+  else if (err == ESP_OK && ret != ESP_OK)
+    printf("Command returned error: 0x%x (%s)\n", ret, esp_err_to_name(ret));
+  else if (err != ESP_OK && err != ESP_ERR_INVALID_ARG) /* Empty line */
+    printf("Internal error: %s\n", esp_err_to_name(err));
+
+  fflush(out);
+  stdout = saved_out;
+  stderr = saved_err;
+  fclose(out);
+
+  if (err != ESP_ERR_INVALID_ARG)
+    s->commands++;
+}
+
+/**
+ * @brief Telnet parser: refuse every option, hand data bytes to the line buffer
+ *
+ * @return true if the byte is line data
+ */
+static bool cli_tcp_telnet(cli_tcp_session_t *s, uint8_t c)
+{
+  switch (s->parse)
+  {
+  case CLI_TCP_DATA:
+    if (c != TELNET_IAC)
+      return true;
+    s->parse = CLI_TCP_IAC;
+    return false;
+
+  case CLI_TCP_IAC:
+    s->parse = CLI_TCP_DATA;
+    if (c >= TELNET_WILL && c <= TELNET_DONT)
+    {
+      s->verb = c;
+      s->parse = CLI_TCP_OPTION;
+    }
+    else if (c == TELNET_SB)
+      s->parse = CLI_TCP_SUB;
+    return false; /* IAC IAC (0xFF data) is not part of a command line either */
+
+  case CLI_TCP_OPTION:
+    s->parse = CLI_TCP_DATA;
+    /* Options are off and stay off: only requests to turn one on need an answer */
+    if (s->verb == TELNET_DO || s->verb == TELNET_WILL)
+    {
+      const uint8_t reply[3] = {TELNET_IAC, (s->verb == TELNET_DO) ? TELNET_WONT : TELNET_DONT, c};
+      cli_tcp_send(s, reply, sizeof(reply));
+    }
+    return false;
+
+  case CLI_TCP_SUB:
+    if (c == TELNET_IAC)
+      s->parse = CLI_TCP_SUB_IAC;
+    return false;
+
+  case CLI_TCP_SUB_IAC:
+    s->parse = (c == TELNET_SE) ? CLI_TCP_DATA : CLI_TCP_SUB;
+    return false;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Process received bytes
+ *
+ * @return false if the session must be closed
+ */
+static bool cli_tcp_input(cli_tcp_session_t *s, const uint8_t *buf, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    uint8_t c = buf[i];
+    if (!cli_tcp_telnet(s, c))
+      continue;
+
+    bool after_cr = s->cr;
+    s->cr = (c == '\r');
+    if (after_cr && (c == '\n' || c == '\0'))
+      continue;
+
+    if (c == '\r' || c == '\n')
+    {
+      if (s->overflow)
+        cli_tcp_printf(s, "ERROR: Line longer than %d characters\r\n", CLI_MAX_CMDLINE_LENGTH - 1);
+      else
+        cli_tcp_exec(s);
+      s->len = 0;
+      s->overflow = false;
+      if (s->failed)
+        return false;
+      cli_tcp_prompt(s);
+    }
+    else if (c == 0x04 && s->len == 0) /* Ctrl-D on an empty line */
+      return false;
+    else if (c == 0x03) /* Ctrl-C drops the line */
+    {
+      s->len = 0;
+      s->overflow = false;
+      cli_tcp_printf(s, "^C\r\n");
+      cli_tcp_prompt(s);
+    }
+    else if (c == '\b' || c == 0x7F)
+    {
+      if (s->len > 0)
+        s->len--;
+    }
+    else if (c >= 0x20)
+    {
+      if (s->len < sizeof(s->line) - 1)
+        s->line[s->len++] = c;
+      else
+        s->overflow = true;
+    }
+  }
+
+  return !s->failed;
+}
+
+static void cli_tcp_accept(void)
+{
+  struct sockaddr_in addr;
+  socklen_t addr_len = sizeof(addr);
+  int fd = accept(s_tcp.listen_fd, (struct sockaddr *)&addr, &addr_len);
+  if (fd < 0)
+    return;
+
+  cli_tcp_session_t *s = NULL;
+  for (int i = 0; i < CLI_TCP_MAX_SESSIONS && s == NULL; i++)
+    if (s_tcp.sessions[i].fd < 0)
+      s = &s_tcp.sessions[i];
+
+  if (s == NULL)
+  {
+    char busy[64];
+    int n = snprintf(busy, sizeof(busy), "All %d console sessions are in use\r\n", CLI_TCP_MAX_SESSIONS);
+    send(fd, busy, n, MSG_DONTWAIT);
+    close(fd);
+    s_tcp.rejected++;
+    return;
+  }
+
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  *s = (cli_tcp_session_t){.fd = fd, .since_us = esp_timer_get_time()};
+  char ip[INET_ADDRSTRLEN];
+  inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+  snprintf(s->peer, sizeof(s->peer), "%s:%u", ip, ntohs(addr.sin_port));
+  s_tcp.accepted++;
+
+  int id = (int)(s - s_tcp.sessions) + 1;
+  ESP_LOGI(TAG, "tcp%d: %s connected", id, s->peer);
+  cli_tcp_printf(s, "Console session tcp%d. Type 'help' for commands, Ctrl-D to close.\r\n", id);
+  cli_tcp_prompt(s);
+}
+
+/* ========================================================================== */
+/*                                 TASK                                       */
+/* ========================================================================== */
+
+static void cli_tcp_task(void *arg)
+{
+  while (!s_tcp.stop)
+  {
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    FD_SET(s_tcp.listen_fd, &rfds);
+    int max_fd = s_tcp.listen_fd;
+    for (int i = 0; i < CLI_TCP_MAX_SESSIONS; i++)
+    {
+      int fd = s_tcp.sessions[i].fd;
+      if (fd < 0)
+        continue;
+      FD_SET(fd, &rfds);
+      if (fd > max_fd)
+        max_fd = fd;
+    }
+
+    struct timeval tv = {.tv_sec = 0, .tv_usec = CLI_TCP_POLL_MS * 1000};
+    int ready = select(max_fd + 1, &rfds, NULL, NULL, &tv);
+    if (ready < 0)
+    {
+      if (errno != EINTR)
+      {
+        ESP_LOGE(TAG, "select() failed: %s", strerror(errno));
+        vTaskDelay(pdMS_TO_TICKS(CLI_TCP_POLL_MS));
+      }
+      continue;
+    }
+    if (ready == 0)
+      continue;
+
+    if (FD_ISSET(s_tcp.listen_fd, &rfds))
+      cli_tcp_accept();
+
+    for (int i = 0; i < CLI_TCP_MAX_SESSIONS; i++)
+    {
+      cli_tcp_session_t *s = &s_tcp.sessions[i];
+      if (s->fd < 0 || !FD_ISSET(s->fd, &rfds))
+        continue;
+
+      uint8_t buf[CLI_TCP_RX_CHUNK];
+      ssize_t n = recv(s->fd, buf, sizeof(buf), 0);
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        continue;
+      if (n > 0)
+        s_tcp.bytes[1] += n;
+      if (n <= 0 || !cli_tcp_input(s, buf, n))
+        cli_tcp_close(s);
+    }
+  }
+
+  for (int i = 0; i < CLI_TCP_MAX_SESSIONS; i++)
+    if (s_tcp.sessions[i].fd >= 0)
+      cli_tcp_close(&s_tcp.sessions[i]);
+  close(s_tcp.listen_fd);
+  s_tcp.listen_fd = -1;
+
+  s_tcp.task = NULL;
+  vTaskDelete(NULL);
+}
+
+/* ========================================================================== */
+/*                               COMMAND                                      */
+/* ========================================================================== */
+
+static int tcp_sessions_cmd(int argc, char **argv)
+{
+  if (s_tcp.task == NULL)
+  {
+    printf("TCP console server stopped\n");
+    return 0;
+  }
+
+  int64_t now = esp_timer_get_time();
+  printf("Port %u: %" PRIu32 " connections accepted, %" PRIu32 " refused (all %d sessions busy)\n",
+         s_tcp.port,
+         s_tcp.accepted,
+         s_tcp.rejected,
+         CLI_TCP_MAX_SESSIONS);
+
+  uint8_t current = cli_current_session();
+  for (int i = 0; i < CLI_TCP_MAX_SESSIONS; i++)
+  {
+    const cli_tcp_session_t *s = &s_tcp.sessions[i];
+    if (s->fd < 0)
+      continue;
+    printf("  tcp%-2d %-21s %8.1f s  %6" PRIu32 " commands%s\n",
+           i + 1,
+           s->peer,
+           (now - s->since_us) / 1e6,
+           s->commands,
+           (current == CLI_SESSION_TCP + i) ? "  (this session)" : "");
+  }
+
+  return 0;
+}
+
+/* ========================================================================== */
+/*                               METRICS                                      */
+/* ========================================================================== */
+
+static void cli_tcp_metric_bytes(cli_metrics_writer_t *w, void *arg)
+{
+  cli_metrics_sample(w, "direction=\"tx\"", s_tcp.bytes[0]);
+  cli_metrics_sample(w, "direction=\"rx\"", s_tcp.bytes[1]);
+}
+
+static void cli_tcp_metric_dropped(cli_metrics_writer_t *w, void *arg)
+{
+  cli_metrics_sample(w, NULL, s_tcp.dropped);
+}
+
+static void cli_tcp_metric_connections(cli_metrics_writer_t *w, void *arg)
+{
+  cli_metrics_sample(w, "result=\"accepted\"", s_tcp.accepted);
+  cli_metrics_sample(w, "result=\"refused\"", s_tcp.rejected);
+}
+
+static void cli_tcp_metric_sessions(cli_metrics_writer_t *w, void *arg)
+{
+  int open = 0;
+  for (int i = 0; i < CLI_TCP_MAX_SESSIONS; i++)
+    if (s_tcp.sessions[i].fd >= 0)
+      open++;
+  cli_metrics_sample(w, NULL, (s_tcp.task != NULL) ? open : 0);
+}
+
+/* ========================================================================== */
+/*                           PUBLIC INTERFACE                                 */
+/* ========================================================================== */
+
+esp_err_t cli_tcp_start(uint16_t port)
+{
+  if (s_tcp.task != NULL)
+    return ESP_ERR_INVALID_STATE;
+
+  int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0)
+  {
+    ESP_LOGE(TAG, "socket() failed: %s", strerror(errno));
+    return ESP_FAIL;
+  }
+
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr = {
+    .sin_family = AF_INET,
+    .sin_port = htons(port),
+    .sin_addr.s_addr = htonl(INADDR_ANY),
+  };
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 2) != 0)
+  {
+    ESP_LOGE(TAG, "Cannot listen on port %u: %s", port, strerror(errno));
+    close(fd);
+    return ESP_FAIL;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+  static bool registered = false;
+  if (!registered)
+  {
+    const esp_console_cmd_t cmd = {.command = "tcp_sessions",
+                                   .help = "List the TCP console sessions",
+                                   .hint = NULL,
+                                   .func = &tcp_sessions_cmd,
+                                   .argtable = NULL};
+    registered = (esp_console_cmd_register(&cmd) == ESP_OK);
+
+    /* Only scraped when cli_config_t.enable_metrics registered the 'metrics' command */
+    cli_metrics_register("tcp_console_bytes", CLI_METRIC_COUNTER, "TCP console bytes", cli_tcp_metric_bytes, NULL);
+    cli_metrics_register("tcp_console_output_dropped_bytes",
+                         CLI_METRIC_COUNTER,
+                         "TCP console output dropped after a send failure or timeout",
+                         cli_tcp_metric_dropped,
+                         NULL);
+    cli_metrics_register("tcp_console_connections",
+                         CLI_METRIC_COUNTER,
+                         "TCP console connections, accepted or refused (all sessions busy)",
+                         cli_tcp_metric_connections,
+                         NULL);
+    cli_metrics_register(
+      "tcp_console_sessions", CLI_METRIC_GAUGE, "Open TCP console sessions", cli_tcp_metric_sessions, NULL);
+  }
+
+  for (int i = 0; i < CLI_TCP_MAX_SESSIONS; i++)
+    s_tcp.sessions[i].fd = -1;
+  s_tcp.listen_fd = fd;
+  s_tcp.port = port;
+  s_tcp.stop = false;
+
+  if (xTaskCreate(cli_tcp_task, "cli_tcp", CLI_TCP_TASK_STACK, NULL, CLI_TCP_TASK_PRIO, &s_tcp.task) != pdPASS)
+  {
+    close(fd);
+    s_tcp.listen_fd = -1;
+    return ESP_ERR_NO_MEM;
+  }
+
+  ESP_LOGI(TAG, "TCP console listening on port %u", port);
+  return ESP_OK;
+}
+
+void cli_tcp_stop(void)
+{
+  if (s_tcp.task == NULL)
+    return;
+
+  s_tcp.stop = true;
+  while (s_tcp.task != NULL)
+    vTaskDelay(pdMS_TO_TICKS(10));
+}
@@ -0,0 +1,213 @@
+/**
+ * @file cli-time.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief 'time' prefix command: runs a command and reports what that one execution cost.
+ *
+ * The command goes through cli_exec_nested(), the same dispatch path as a typed line, so argument parsing is part of
+ * the measurement. Reported:
+ *
+ *   - wall time (esp_timer)
+ *   - CPU cycles of the executing core (cycle counter, only if the task stayed on one core and it did not wrap)
+ *   - running vs. blocked time, from the task's FreeRTOS run time counter (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS);
+ *     "blocked" is everything else: waiting, or ready but preempted. The counter is updated at context switches, so
+ *     the split is accurate to one scheduler slice
+ *   - heap: net change of the free heap and the peak in use (local minimum of the free heap, all tasks)
+ *   - bytes written to stdout, counted by a pass-through stream (stdout is per task, so only this command's output)
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <esp_console.h>
+#include <esp_cpu.h>
+#include <esp_heap_caps.h>
+#include <esp_private/esp_clk.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+#include <sdkconfig.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cli-internal.h"
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && CONFIG_FREERTOS_RUN_TIME_STATS_USING_CPU_CLK
+#include <esp_rom_sys.h>
+#endif
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Pass-through stdout that counts the bytes written
+ */
+typedef struct
+{
+  FILE *out;      /**< Real stdout */
+  size_t written; /**< Bytes passed through */
+} cli_time_counter_t;
+
+/**
+ * @brief Measurements taken before and after the command
+ */
+typedef struct
+{
+  int64_t wall_us;   /**< esp_timer_get_time() */
+  uint32_t cycles;   /**< Cycle counter of the executing core */
+  int core;          /**< Core the task runs on */
+  uint64_t run_time; /**< Task run time counter, 0 without run time stats */
+  size_t heap_free;  /**< Free heap, all capabilities */
+} cli_time_snapshot_t;
+
+/* ========================================================================== */
+/*                               MEASUREMENT                                  */
+/* ========================================================================== */
+
+static ssize_t cli_time_write(void *cookie, const char *buf, size_t size)
+{
+  cli_time_counter_t *c = cookie;
+
+  size_t n = fwrite(buf, 1, size, c->out);
+  c->written += n;
+  return n;
+}
+
+static void cli_time_snapshot(cli_time_snapshot_t *s)
+{
+  s->core = esp_cpu_get_core_id();
+  s->heap_free = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  s->run_time = ulTaskGetRunTimeCounter(NULL);
+#else
+  s->run_time = 0;
+#endif
+  s->wall_us = esp_timer_get_time();
+  s->cycles = esp_cpu_get_cycle_count();
+}
+
+/**
+ * @brief Run time counter ticks per microsecond
+ */
+static double cli_time_run_time_per_us(void)
+{
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && CONFIG_FREERTOS_RUN_TIME_STATS_USING_CPU_CLK
+  return esp_rom_get_cpu_ticks_per_us();
+#else
+  return 1.0; /* esp_timer microseconds */
+#endif
+}
+
+static void cli_time_report(const cli_time_snapshot_t *a, const cli_time_snapshot_t *b, size_t peak_used, size_t out)
+{
+  int64_t wall_us = b->wall_us - a->wall_us;
+  uint32_t cycles = b->cycles - a->cycles;
+
+  printf("\nreal     %10.3f ms\n", wall_us / 1000.0);
+
+  if (a->core != b->core)
+    printf("cycles   %10s    (moved from core %d to core %d)\n", "n/a", a->core, b->core);
+  else if ((uint64_t)wall_us * (esp_clk_cpu_freq() / 1000000) > UINT32_MAX)
+    printf("cycles   %10s    (counter wrapped, run shorter commands)\n", "n/a");
+  else
+    printf("cycles   %10" PRIu32 "    (core %d)\n", cycles, a->core);
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  double running_us = (b->run_time - a->run_time) / cli_time_run_time_per_us();
+  if (running_us > wall_us)
+    running_us = wall_us;
+  printf("running  %10.3f ms (%.1f%%)\n", running_us / 1000.0, wall_us ? 100.0 * running_us / wall_us : 0.0);
+  printf("blocked  %10.3f ms (waiting or preempted)\n", (wall_us - running_us) / 1000.0);
+#else
+  printf("running  %10s    (needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)\n", "n/a");
+#endif
+
+  printf("heap     %+10d B  net, %u B peak in use\n", (int)(a->heap_free - b->heap_free), (unsigned)peak_used);
+  printf("output   %10u B\n", (unsigned)out);
+}
+
+/* ========================================================================== */
+/*                               COMMAND                                      */
+/* ========================================================================== */
+
+static int time_cmd(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    printf("Usage: time <command> [args...]\n");
+    return 1;
+  }
+  if (strcmp(argv[1], argv[0]) == 0)
+  {
+    printf("ERROR: time cannot be nested\n");
+    return 1;
+  }
+
+  cli_time_counter_t counter = {.out = stdout, .written = 0};
+  const cookie_io_functions_t io = {.write = cli_time_write};
+  FILE *counted = fopencookie(&counter, "w", io);
+  if (counted == NULL)
+    return 1;
+  setvbuf(counted, NULL, _IOLBF, 128);
+
+  fflush(stdout);
+  bool monitor = (heap_caps_monitor_local_minimum_free_size_start() == ESP_OK);
+
+  cli_time_snapshot_t before;
+  cli_time_snapshot_t after;
+  int ret = 0;
+
+  /* stdout is per task, so only output of this command is counted */
+  stdout = counted;
+  cli_time_snapshot(&before);
+  esp_err_t err = cli_exec_nested(argc - 1, &argv[1], &ret);
+  fflush(counted);
+  cli_time_snapshot(&after);
+  stdout = counter.out;
+  fclose(counted);
+
+  size_t peak_used = 0;
+  if (monitor)
+  {
+    size_t local_min = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+    heap_caps_monitor_local_minimum_free_size_stop();
+    if (before.heap_free > local_min)
+      peak_used = before.heap_free - local_min;
+  }
+
+  if (err == ESP_ERR_NOT_FOUND)
+  {
+    printf("Unrecognized command\n");
+    return 1;
+  }
+  if (err != ESP_OK)
+  {
+    printf("Command failed: %s\n", esp_err_to_name(err));
+    return 1;
+  }
+
+  cli_time_report(&before, &after, peak_used, counter.written);
+  return ret;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+esp_err_t cli_time_init(void)
+{
+  const esp_console_cmd_t cmd = {.command = "time",
+                                 .help = "Run a command and report its wall time, CPU cycles, running vs. blocked "
+                                         "time, heap use and output bytes.\n"
+                                         "Example: time part_hash nvs",
+                                 .hint = "<command> [args...]",
+                                 .func = &time_cmd,
+                                 .argtable = NULL};
+
+  return esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,265 @@
+/**
+ * @file cli-trace.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Command lifecycle trace points and the 'trace' command.
+ *
+ * Every stage of the console pipeline (byte received, line complete, dispatch, tokenized, lookup, parsed, callback
+ * start/end, done, output flushed) records an 8-byte timestamped event. Each core has its own ring of
+ * CLI_TRACE_RING_SIZE events; a slot is claimed with one atomic increment, so recording takes no lock and never
+ * blocks, and the oldest events are overwritten. 'trace dump' merges the rings by time and prints one event per line;
+ * tools/cli_trace.py turns the dump into Chrome trace / Perfetto JSON.
+ *
+ * Bytes are traced as linenoise takes them from the input buffer (cli-input.c), so the input stage starts at the
+ * first key of a line.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <argtable3/argtable3.h>
+#include <esp_console.h>
+#include <esp_cpu.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cli-internal.h"
+
+/* ========================================================================== */
+/*                           INTERNAL CONSTANTS                               */
+/* ========================================================================== */
+
+/** Dump format version, first field of the "TRACE" header line */
+#define CLI_TRACE_FORMAT 1
+
+_Static_assert((CLI_TRACE_RING_SIZE & (CLI_TRACE_RING_SIZE - 1)) == 0, "ring slots are indexed with a mask");
+
+static const char *const s_event_names[CLI_TRACE_EVENT_MAX] = {
+  [CLI_TRACE_RX] = "rx",
+  [CLI_TRACE_LINE] = "line",
+  [CLI_TRACE_EXEC] = "exec",
+  [CLI_TRACE_TOKENIZED] = "tokenized",
+  [CLI_TRACE_LOOKUP] = "lookup",
+  [CLI_TRACE_PARSED] = "parsed",
+  [CLI_TRACE_CB_START] = "cb_start",
+  [CLI_TRACE_CB_END] = "cb_end",
+  [CLI_TRACE_DONE] = "done",
+  [CLI_TRACE_FLUSHED] = "flushed",
+};
+
+/* ========================================================================== */
+/*                           INTERNAL TYPES                                   */
+/* ========================================================================== */
+
+/**
+ * @brief One trace event (8 bytes)
+ */
+typedef struct
+{
+  uint32_t ts_us;  /**< Low 32 bits of esp_timer_get_time() */
+  uint8_t event;   /**< cli_trace_event_t */
+  uint8_t session; /**< CLI_SESSION_* of the event */
+  uint16_t arg;    /**< Event specific: byte, length, command index, result */
+} cli_trace_rec_t;
+
+/**
+ * @brief Event ring of one core
+ */
+typedef struct
+{
+  uint32_t head;                             /**< Events ever written, next slot is head % CLI_TRACE_RING_SIZE */
+  cli_trace_rec_t recs[CLI_TRACE_RING_SIZE]; /**< Events */
+} cli_trace_ring_t;
+
+/* ========================================================================== */
+/*                           INTERNAL VARIABLES                               */
+/* ========================================================================== */
+
+static cli_trace_ring_t *s_rings = NULL; /**< portNUM_PROCESSORS rings, NULL until cli_trace_init() */
+static volatile bool s_recording = false;
+
+static struct
+{
+  struct arg_str *action;
+  struct arg_end *end;
+} trace_args;
+
+/* ========================================================================== */
+/*                               RECORDING                                    */
+/* ========================================================================== */
+
+void cli_trace(cli_trace_event_t event, uint16_t arg)
+{
+  if (!s_recording)
+    return;
+
+  cli_trace_ring_t *ring = &s_rings[esp_cpu_get_core_id()];
+  uint32_t slot = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED) & (CLI_TRACE_RING_SIZE - 1);
+
+  ring->recs[slot] = (cli_trace_rec_t){
+    .ts_us = (uint32_t)esp_timer_get_time(),
+    .event = event,
+    .session = cli_current_session(),
+    .arg = arg,
+  };
+}
+
+void cli_trace_flush(void)
+{
+  fflush(stdout);
+  if (!s_recording)
+    return;
+
+  /* Wait for the driver to send the output so "flushed" marks the last byte on the wire */
+  fsync(fileno(stdout));
+  cli_trace(CLI_TRACE_FLUSHED, 0);
+}
+
+/* ========================================================================== */
+/*                                  DUMP                                      */
+/* ========================================================================== */
+
+/**
+ * @brief Oldest event of a ring and the number of events it holds
+ */
+static uint32_t cli_trace_ring_span(const cli_trace_ring_t *ring, uint32_t *count)
+{
+  uint32_t head = ring->head;
+  *count = (head < CLI_TRACE_RING_SIZE) ? head : CLI_TRACE_RING_SIZE;
+  return head - *count;
+}
+
+static void cli_trace_dump(void)
+{
+  uint32_t next[portNUM_PROCESSORS];
+  uint32_t left[portNUM_PROCESSORS];
+  uint32_t total = 0;
+
+  for (int core = 0; core < portNUM_PROCESSORS; core++)
+  {
+    next[core] = cli_trace_ring_span(&s_rings[core], &left[core]);
+    total += left[core];
+  }
+
+  printf("TRACE %d %d %" PRIu32 " %" PRIu32 "\n",
+         CLI_TRACE_FORMAT,
+         portNUM_PROCESSORS,
+         total,
+         (uint32_t)esp_timer_get_time());
+
+  const char *name;
+  for (uint16_t i = 0; (name = cli_command_name(i)) != NULL; i++)
+    printf("CMD %u %s\n", i, name);
+
+  /* Merge the rings by timestamp (wrap-safe comparison) */
+  while (true)
+  {
+    int pick = -1;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+      if (left[core] == 0)
+        continue;
+      const cli_trace_rec_t *r = &s_rings[core].recs[next[core] & (CLI_TRACE_RING_SIZE - 1)];
+      const cli_trace_rec_t *p = (pick < 0) ? NULL : &s_rings[pick].recs[next[pick] & (CLI_TRACE_RING_SIZE - 1)];
+      if (p == NULL || (int32_t)(r->ts_us - p->ts_us) < 0)
+        pick = core;
+    }
+    if (pick < 0)
+      break;
+
+    const cli_trace_rec_t *r = &s_rings[pick].recs[next[pick] & (CLI_TRACE_RING_SIZE - 1)];
+    printf("%" PRIu32 " %d %s %u %u\n",
+           r->ts_us,
+           pick,
+           (r->event < CLI_TRACE_EVENT_MAX) ? s_event_names[r->event] : "?",
+           r->session,
+           r->arg);
+    next[pick]++;
+    left[pick]--;
+  }
+
+  printf("TRACE END\n");
+}
+
+/* ========================================================================== */
+/*                               COMMAND                                      */
+/* ========================================================================== */
+
+static int trace_cmd(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&trace_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, trace_args.end, argv[0]);
+    return 1;
+  }
+
+  const char *action = trace_args.action->sval[0];
+  bool was_recording = s_recording;
+
+  /* The command's own events would only interleave with what is being dumped or cleared */
+  s_recording = false;
+
+  if (strcmp(action, "dump") == 0)
+  {
+    cli_trace_dump();
+  }
+  else if (strcmp(action, "clear") == 0)
+  {
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+      s_rings[core].head = 0;
+    printf("Trace cleared\n");
+  }
+  else if (strcmp(action, "on") == 0 || strcmp(action, "off") == 0)
+  {
+    was_recording = (strcmp(action, "on") == 0);
+    printf("Tracing %s\n", was_recording ? "on" : "off");
+  }
+  else
+  {
+    printf("ERROR: Action '%s' invalid. Use: dump, clear, on, off\n", action);
+    s_recording = was_recording;
+    return 1;
+  }
+
+  s_recording = was_recording;
+  return 0;
+}
+
+/* ========================================================================== */
+/*                          INTERNAL INTERFACE                                */
+/* ========================================================================== */
+
+esp_err_t cli_trace_init(void)
+{
+  if (s_rings == NULL)
+  {
+    s_rings = calloc(portNUM_PROCESSORS, sizeof(cli_trace_ring_t));
+    if (s_rings == NULL)
+      return ESP_ERR_NO_MEM;
+  }
+
+  trace_args.action = arg_str1(NULL, NULL, "<dump|clear|on|off>", "Action");
+  trace_args.end = arg_end(1);
+
+  const esp_console_cmd_t cmd = {.command = "trace",
+                                 .help = "Console pipeline trace: dump the recorded events (convert with "
+                                         "tools/cli_trace.py), clear them, or pause and resume recording",
+                                 .hint = NULL,
+                                 .func = &trace_cmd,
+                                 .argtable = &trace_args};
+
+  esp_err_t err = esp_console_cmd_register(&cmd);
+  if (err == ESP_OK)
+    s_recording = true;
+
+  return err;
+}
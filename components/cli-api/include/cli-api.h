@@ -17,6 +17,7 @@
 #include <stdint.h>
 
 #include "esp_err.h"
+#include "wear_levelling.h"
 
 /* ========================================================================== */
 /*                              CONFIGURATION                                 */
@@ -32,21 +33,131 @@
  */
 #define CLI_MAX_COMMANDS 32
 
+/**
+ * @brief Maximum number of commands registered through cli_register_lazy_command()
+ */
+#define CLI_MAX_LAZY_COMMANDS 48
+
 /**
  * @brief Maximum command line length
  */
 #define CLI_MAX_CMDLINE_LENGTH 256
 
 /**
- * @brief Maximum prompt size
+ * @brief Maximum prompt size, after expanding template tokens and adding colors
+ */
+#define CLI_PROMPT_MAX_LEN 96
+
+/**
+ * @brief Prompt template tokens that can be registered, built-in ones included
  */
-#define CLI_PROMPT_MAX_LEN 64
+#define CLI_PROMPT_MAX_TOKENS 8
+
+/**
+ * @brief Maximum text of one prompt token (longer output is truncated)
+ */
+#define CLI_PROMPT_TOKEN_MAX_LEN 16
 
 /**
  * @brief Command history size
  */
 #define CLI_HISTORY_SIZE 100
 
+/**
+ * @brief Label of the data partition mounted as the FATFS volume (see cli_get_storage())
+ */
+#define CLI_STORAGE_PARTITION "storage"
+
+/**
+ * @brief Console input bytes taken from the driver in one read
+ */
+#define CLI_INPUT_BUFFER_SIZE 128
+
+/**
+ * @brief Maximum number of scheduled command entries
+ */
+#define CLI_SCHEDULE_MAX_ENTRIES 8
+
+/**
+ * @brief Maximum length of a schedule specification (period or cron expression)
+ */
+#define CLI_SCHEDULE_SPEC_MAX_LEN 32
+
+/**
+ * @brief Maximum length of a scheduled command line
+ */
+#define CLI_SCHEDULE_LINE_MAX_LEN 96
+
+/**
+ * @brief Number of records kept in the RTC memory audit ring
+ */
+#define CLI_AUDIT_MAX_ENTRIES 32
+
+/**
+ * @brief Command line bytes stored per audit record (longer lines are truncated)
+ */
+#define CLI_AUDIT_LINE_MAX_LEN 40
+
+/**
+ * @brief Block size of the 'compress' command, also its LZSS window (max 4096, RAM use is about 5x this)
+ */
+#define CLI_COMPRESS_BLOCK_SIZE 4096
+
+/**
+ * @brief Time the console stays awake after the last command or key before automatic light sleep is allowed
+ */
+#define CLI_IDLE_SLEEP_DELAY_MS 5000
+
+/**
+ * @brief Time light sleep stays blocked after the last received key when only the CPU boost is enabled
+ */
+#define CLI_INPUT_AWAKE_MS 1000
+
+/**
+ * @brief Idle time after which the next line editor refresh is sent in full, not as a diff (enable_diff_redraw)
+ */
+#define CLI_REDRAW_REFRESH_MS 2000
+
+/**
+ * @brief Concurrent TCP console sessions (cli_tcp_start()), further connections are refused
+ */
+#define CLI_TCP_MAX_SESSIONS 4
+
+/**
+ * @brief Time a TCP session may stay unable to take output before it is closed
+ */
+#define CLI_TCP_SEND_TIMEOUT_MS 2000
+
+/**
+ * @brief Metric families the 'metrics' registry can hold, built-in ones included
+ */
+#define CLI_METRICS_MAX_FAMILIES 32
+
+/**
+ * @brief Distinct commands with execution statistics (further commands are not counted)
+ */
+#define CLI_METRICS_MAX_COMMANDS 48
+
+/**
+ * @brief Distinct program counters one 'profile' run can count (power of two, 8 bytes each)
+ */
+#define CLI_PROFILE_MAX_PCS 1024
+
+/**
+ * @brief Highest 'profile' sampling rate
+ */
+#define CLI_PROFILE_MAX_HZ 10000
+
+/**
+ * @brief Trace events kept per core (power of two, 8 bytes each)
+ */
+#define CLI_TRACE_RING_SIZE 256
+
+/**
+ * @brief First byte of an interned help text reference (see cli_help_set_table())
+ */
+#define CLI_HELP_REF_MARK "\x01"
+
 /* ========================================================================== */
 /*                           TYPES AND STRUCTURES                             */
 /* ========================================================================== */
@@ -117,26 +228,116 @@ typedef struct
   uint8_t arg_count;            /**< Number of arguments in args[] */
 } cli_command_t;
 
+/**
+ * @brief Builds the arg_* members of a lazily registered command's argument struct (ex: join_args.ssid = arg_str1(...))
+ */
+typedef void (*cli_argtable_build_t)(void);
+
+/**
+ * @brief esp_console command whose argtable is built on first use (cli_register_lazy_command())
+ */
+typedef struct
+{
+  const char *command;                /**< Command name */
+  const char *help;                   /**< Help text */
+  const char *hint;                   /**< Hint, NULL = generated from the argtable once it is built */
+  int (*func)(int argc, char **argv); /**< Command function, parses argtable with arg_parse() as usual */
+  void *argtable;                     /**< Argument struct ending with an arg_end (ex: &join_args), NULL if none */
+  size_t argtable_len;                /**< Members of argtable, arg_end included: CLI_ARGTABLE_LEN(join_args) */
+  cli_argtable_build_t build;         /**< Fills argtable, NULL if there is no argtable */
+} cli_lazy_command_t;
+
+/** Number of arg_* members of an argument struct, for cli_lazy_command_t.argtable_len */
+#define CLI_ARGTABLE_LEN(args) (sizeof(args) / sizeof(void *))
+
+/**
+ * @brief Interned help text table, generated by tools/cli_helpgen.py (do not fill by hand)
+ */
+typedef struct
+{
+  const uint8_t *data;       /**< Blocks back to back, each LZSS-compressed or stored as is */
+  const uint32_t *block_pos; /**< Offset of each block in data, block_count + 1 entries */
+  const uint32_t *block_raw; /**< Offset of each block in the decompressed table, block_count + 1 entries */
+  const uint32_t *str_raw;   /**< Offset of each string in the decompressed table */
+  uint16_t block_count;      /**< Number of blocks */
+  uint16_t str_count;        /**< Number of distinct strings */
+} cli_help_table_t;
+
+/**
+ * @brief Metric family type, as in OpenMetrics
+ */
+typedef enum
+{
+  CLI_METRIC_COUNTER, /**< Monotonic total, samples get the "_total" suffix */
+  CLI_METRIC_GAUGE,   /**< Current value, may go up and down */
+} cli_metric_type_t;
+
+/**
+ * @brief Output handle passed to metric callbacks (opaque)
+ */
+typedef struct cli_metrics_writer cli_metrics_writer_t;
+
+/**
+ * @brief Metric callback: writes the current samples of one family with cli_metrics_sample()
+ *
+ * @param w Output handle
+ * @param arg User argument given at registration
+ */
+typedef void (*cli_metric_cb_t)(cli_metrics_writer_t *w, void *arg);
+
+/**
+ * @brief Prompt token provider: writes the current text of a "{name}" token
+ *
+ * @param buf Output, NUL-terminated
+ * @param size Size of buf (CLI_PROMPT_TOKEN_MAX_LEN)
+ * @param arg User argument given at registration
+ */
+typedef void (*cli_prompt_token_cb_t)(char *buf, size_t size, void *arg);
+
 /**
  * @brief CLI console configuration
  */
 typedef struct
 {
-  const char *prompt; /**< Console prompt (ex: "esp32>"). NULL uses default */
-  const char *banner; /**< Welcome message. NULL uses default */
-  bool register_help; /**< true = automatically register 'help' command */
-  bool store_history; /**< true = save history to filesystem (requires "storage" partition) */
+  const char *prompt;      /**< Console prompt (ex: "esp32>"), may contain "{token}"s. NULL uses default */
+  const char *banner;      /**< Welcome message. NULL uses default */
+  bool register_help;      /**< true = automatically register 'help' command */
+  bool store_history;      /**< true = save history to filesystem (requires "storage" partition) */
+  bool enable_scheduler;   /**< true = register 'schedule_*' commands and run persisted schedules */
+  bool enable_audit;       /**< true = record executed commands in RTC memory and register 'audit' */
+  bool enable_compress;    /**< true = register the 'compress <command>' output compression prefix */
+  bool enable_idle_sleep;  /**< true = light sleep while the prompt is idle, wake on UART input (needs PM) */
+  bool enable_cpu_boost;   /**< true = max CPU frequency while commands run, no light sleep while typing (needs PM) */
+  bool enable_metrics;     /**< true = count command executions and register 'metrics' (OpenMetrics text) */
+  bool enable_profiler;    /**< true = register the 'profile' sampling profiler */
+  bool enable_trace;       /**< true = record console pipeline trace events and register 'trace' */
+  bool enable_time;        /**< true = register the 'time <command>' measurement prefix */
+  bool enable_diff_redraw; /**< true = line editor refreshes send only the changed tail, register 'redraw_stats' */
+  bool enable_record;      /**< true = register 'record' / 'replay' of the console input stream */
+  bool lazy_argtables;     /**< true = build command argtables on first use or 'help', not at registration */
 } cli_config_t;
 
 /**
  * @brief Macro to initialize cli_config_t with default values
  */
-#define CLI_CONFIG_DEFAULT() \
-  {                          \
-    .prompt = NULL,          \
-    .banner = NULL,          \
-    .register_help = true,   \
-    .store_history = false,  \
+#define CLI_CONFIG_DEFAULT()     \
+  {                              \
+    .prompt = NULL,              \
+    .banner = NULL,              \
+    .register_help = true,       \
+    .store_history = false,      \
+    .enable_scheduler = false,   \
+    .enable_audit = false,       \
+    .enable_compress = false,    \
+    .enable_idle_sleep = false,  \
+    .enable_cpu_boost = false,   \
+    .enable_metrics = false,     \
+    .enable_profiler = false,    \
+    .enable_trace = false,       \
+    .enable_time = false,        \
+    .enable_diff_redraw = false, \
+    .enable_record = false,      \
+    .lazy_argtables = false,     \
   }
 
 /* ========================================================================== */
@@ -172,12 +373,29 @@ esp_err_t cli_run(void);
 void cli_deinit(void);
 
 /**
- * @brief Returns the current prompt
+ * @brief Returns the current prompt, with template tokens expanded
  *
  * @return const char* Pointer to the prompt
  */
 const char *cli_get_prompt(void);
 
+/**
+ * @brief Returns the FATFS volume mounted for history persistence, on the CLI_STORAGE_PARTITION partition
+ *
+ * @param[out] wl_handle Wear-levelling handle of the volume, WL_INVALID_HANDLE if not mounted (may be NULL)
+ * @return const char* Mount path, or NULL if no volume is mounted
+ */
+const char *cli_get_storage(wl_handle_t *wl_handle);
+
+/**
+ * @brief Returns when the console first became ready for input
+ *
+ * Used to measure boot and wakeup latency up to the prompt.
+ *
+ * @return int64_t esp_timer_get_time() when cli_run() showed its first prompt, 0 if it has not yet
+ */
+int64_t cli_get_ready_time_us(void);
+
 /* ========================================================================== */
 /*                       COMMAND REGISTRATION FUNCTIONS                       */
 /* ========================================================================== */
@@ -185,7 +403,10 @@ const char *cli_get_prompt(void);
 /**
  * @brief Register a command in the console
  *
- * @param cmd Pointer to struct describing the command
+ * With cli_config_t.lazy_argtables, only the descriptor pointer is kept: the argtable is allocated when the command
+ * first runs or 'help' describes it, and until then typing the command shows cmd->hint only.
+ *
+ * @param cmd Pointer to struct describing the command, must stay valid
  * @return esp_err_t
  *         - ESP_OK: Success
  *         - ESP_ERR_INVALID_ARG: Invalid parameter
@@ -215,4 +436,159 @@ esp_err_t cli_register_simple_command(const char *name, const char *description,
  */
 esp_err_t cli_register_commands(const cli_command_t *commands, size_t count);
 
+/**
+ * @brief Register an esp_console command whose argtable is built the first time it is needed
+ *
+ * With cli_config_t.lazy_argtables, cmd->build() runs when the command is first invoked or 'help' describes it
+ * ("help <command>", or a plain "help"), and the command is registered again with its argtable so the argument
+ * glossary and the generated hint appear from then on. Without it, build() runs now, as with
+ * esp_console_cmd_register(). A command without arguments leaves argtable and build NULL; it is registered here so
+ * its help can be an interned reference (cli_help_set_table()). Up to CLI_MAX_LAZY_COMMANDS commands can be
+ * registered this way.
+ *
+ * @param cmd Command descriptor, must stay valid (static const)
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM (command limit or allocation failure)
+ */
+esp_err_t cli_register_lazy_command(const cli_lazy_command_t *cmd);
+
+/* ========================================================================== */
+/*                            OUTPUT HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Print a canonical hexdump (address, 16 bytes in hex, ASCII column) to stdout
+ *
+ * Large ranges can be streamed by calling it repeatedly with consecutive chunks whose size is a multiple of 16.
+ *
+ * @param addr Address printed for the first byte
+ * @param data Bytes to dump (must be byte-addressable memory)
+ * @param len Number of bytes
+ */
+void cli_hexdump(uint32_t addr, const void *data, size_t len);
+
+/**
+ * @brief Switch the console between text mode and binary-safe mode
+ *
+ * Text mode translates line endings (CR to LF on input, LF to CRLF on output). Binary mode passes bytes through
+ * unchanged so commands can exchange raw data with a host tool. Always switch back before returning to the prompt.
+ *
+ * @param enable true = binary mode, false = text mode
+ */
+void cli_set_binary_mode(bool enable);
+
+/**
+ * @brief Take console input that was already read from the driver but not consumed by the line editor
+ *
+ * The console reads input in batches, so bytes sent right after a command line (a pasted script, or data a host tool
+ * sends without waiting) may already be buffered when the command starts. Commands that read stdin themselves must
+ * take these first. The bytes are returned as received, without line ending conversion.
+ *
+ * @param buf Output buffer
+ * @param size Size of buf
+ * @return size_t Bytes copied, 0 if nothing is buffered
+ */
+size_t cli_input_read(void *buf, size_t size);
+
+/* ========================================================================== */
+/*                                 PROMPT                                     */
+/* ========================================================================== */
+
+/**
+ * @brief Register a "{name}" token for prompt templates
+ *
+ * The provider output is cached and the provider is called again only after cli_prompt_invalidate(name) or when the
+ * cache is older than max_age_ms, at most once per prompt. Built-in tokens: "heap" (free heap, e.g. "212K", refreshed
+ * every second) and "rc" (return code of the last console command, 127 if not found).
+ *
+ * @param name Token name without braces; must stay valid
+ * @param max_age_ms Refresh period, 0 = only when invalidated
+ * @param cb Provider
+ * @param arg Passed to cb
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if the name is taken, ESP_ERR_NO_MEM if CLI_PROMPT_MAX_TOKENS are used
+ */
+esp_err_t cli_prompt_register_token(const char *name, uint32_t max_age_ms, cli_prompt_token_cb_t cb, void *arg);
+
+/**
+ * @brief Mark a token as changed so the next prompt calls its provider again
+ *
+ * Only sets a flag: safe to call from any task, e.g. an event handler.
+ *
+ * @param name Token name
+ */
+void cli_prompt_invalidate(const char *name);
+
+/* ========================================================================== */
+/*                                METRICS                                     */
+/* ========================================================================== */
+
+/**
+ * @brief Add a metric family to the 'metrics' command
+ *
+ * The callback runs at every scrape, from the console task, and should only read counters. Families are printed in
+ * registration order. Can be called before or after cli_init().
+ *
+ * @param name Family name (ex: "wifi_rssi_dbm"), without "_total" for counters; must stay valid
+ * @param type CLI_METRIC_COUNTER or CLI_METRIC_GAUGE
+ * @param help HELP text, NULL for none; must stay valid
+ * @param cb Callback writing the samples
+ * @param arg Passed to cb
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if the name is taken, ESP_ERR_NO_MEM if the registry is full
+ */
+esp_err_t cli_metrics_register(
+  const char *name, cli_metric_type_t type, const char *help, cli_metric_cb_t cb, void *arg);
+
+/**
+ * @brief Write one sample of the family being rendered (call from a metric callback)
+ *
+ * @param w Output handle received by the callback
+ * @param labels Label pairs without braces (ex: "iface=\"sta\",dir=\"rx\""), NULL for none
+ * @param value Sample value
+ */
+void cli_metrics_sample(cli_metrics_writer_t *w, const char *labels, double value);
+
+/* ========================================================================== */
+/*                              HELP TEXT                                     */
+/* ========================================================================== */
+
+/**
+ * @brief Install the application's interned help text table
+ *
+ * tools/cli_helpgen.py generates the table and a header of references (CLI_HELP_REF_MARK and an index) from a text
+ * file. The references go in place of the description of cli_command_t, cli_arg_t and cli_lazy_command_t (also the
+ * glossary given to arg_*() in a build function), so the texts are stored once, compressed, in flash. 'help'
+ * decompresses the texts it prints into a scratch buffer freed when it returns. Argument data types and hints are
+ * printed outside 'help' and stay plain strings.
+ *
+ * @param table Generated table, must stay valid; NULL removes it (references then print as unavailable)
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG if the table has more blocks than supported
+ */
+esp_err_t cli_help_set_table(const cli_help_table_t *table);
+
+/* ========================================================================== */
+/*                              TCP CONSOLE                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Start the TCP console server
+ *
+ * Accepts up to CLI_TCP_MAX_SESSIONS telnet or raw TCP connections, each a console session of its own running the
+ * registered commands. Call once the network stack is up (esp_netif_init()); the server keeps listening across
+ * network reconnections. There is no authentication: anyone who can reach the port can run every registered command,
+ * so only enable it on trusted networks.
+ *
+ * Commands from all sessions and the local console run one at a time (the execution lock of cli_exec_line()): a long
+ * command in one session delays the others, and a peer that stops reading can hold the lock for up to
+ * CLI_TCP_SEND_TIMEOUT_MS before its output is dropped.
+ *
+ * @param port TCP port (23 for telnet)
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if already running, ESP_FAIL if the port cannot be opened,
+ *         ESP_ERR_NO_MEM if the server task cannot be created
+ */
+esp_err_t cli_tcp_start(uint16_t port);
+
+/**
+ * @brief Close every TCP session and stop listening (waits up to one poll period)
+ */
+void cli_tcp_stop(void);
+
 #endif /* CLI_API_H */
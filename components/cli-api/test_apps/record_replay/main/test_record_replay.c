@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/* Host test app of console recording and replay
+ *
+ * cli-record.c and cli-input.c run unchanged: lines are read with linenoise through the cli-input read function, as
+ * in cli_run(), so a replay goes through cli_record_replay() exactly as on a chip. Recordings are kept in a fresh
+ * directory under /tmp, printed at startup. The 'mark' command prints the time it ran, for pytest_record_replay.py
+ * to check the order and pacing of the replayed lines.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cli-internal.h"
+#include "esp_console.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "linenoise/linenoise.h"
+
+static char s_dir[] = "/tmp/cli_record_XXXXXX";
+
+/* ========================================================================== */
+/*                        CLI-API STAND-INS                                   */
+/* ========================================================================== */
+
+const char *cli_get_storage(wl_handle_t *wl_handle)
+{
+  return s_dir;
+}
+
+void cli_trace(cli_trace_event_t event, uint16_t arg)
+{
+}
+
+void cli_power_input(void)
+{
+}
+
+/* ========================================================================== */
+/*                              COMMANDS                                      */
+/* ========================================================================== */
+
+/** 'mark <tag>' prints the tag and the time in ms */
+static int mark_cmd(int argc, char **argv)
+{
+  printf("MARK %s %" PRId64 "\n", (argc > 1) ? argv[1] : "-", esp_timer_get_time() / 1000);
+  return 0;
+}
+
+void app_main(void)
+{
+  /* stdout may be a pipe: hand out every line as it is printed */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  if (mkdtemp(s_dir) == NULL)
+  {
+    printf("ERROR: No recording directory\n");
+    return;
+  }
+
+  esp_console_config_t config = ESP_CONSOLE_CONFIG_DEFAULT();
+  ESP_ERROR_CHECK(esp_console_init(&config));
+  ESP_ERROR_CHECK(cli_record_init());
+  const esp_console_cmd_t mark = {.command = "mark", .help = "Print <tag> and the time in ms", .func = &mark_cmd};
+  ESP_ERROR_CHECK(esp_console_cmd_register(&mark));
+
+  linenoiseSetDumbMode(1);
+  cli_input_init();
+  printf("Record test ready in %s\n", s_dir);
+
+  /* Same loop as cli_run(), without the rest of cli-api */
+  while (true)
+  {
+    cli_record_prompt();
+    char *line = linenoise("rec> ");
+    if (line == NULL)
+      break;
+
+    int ret;
+    if (esp_console_run(line, &ret) == ESP_ERR_NOT_FOUND)
+      printf("Command not recognized\n");
+    linenoiseFree(line);
+  }
+}
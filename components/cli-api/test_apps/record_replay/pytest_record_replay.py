@@ -0,0 +1,90 @@
+# SPDX-License-Identifier: MIT
+"""Console recording and replay (cli-record.c, cli-input.c) on the linux target: a scripted recording replayed at its
+pace, scaled by --speed and with --max; a live recording replayed with its own timing; and tools/cli_replay.py -e
+replaying the scripted recording against a second instance of the executable."""
+
+import os
+import re
+import struct
+import subprocess
+import sys
+import time
+
+import pytest
+from pytest_embedded import Dut
+from pytest_embedded_idf.utils import idf_parametrize
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', '..', '..')
+CLI_REPLAY = os.path.join(ROOT, 'tools', 'cli_replay.py')
+
+MAGIC = b'CLIREC1\n'
+CHUNK = struct.Struct('<IH')  # delta_us, len
+
+# Three lines, 200 ms and 300 ms apart
+SCRIPT = [(0, b'mark a\r'), (200000, b'mark b\r'), (300000, b'mark c\r')]
+TOLERANCE_MS = 60
+
+
+def write_recording(path, chunks):
+    with open(path, 'wb') as f:
+        f.write(MAGIC)
+        for delta_us, data in chunks:
+            f.write(CHUNK.pack(delta_us, len(data)) + data)
+
+
+def marks(dut, tags):
+    """Times in ms of the 'mark' lines, which must run in this order."""
+    return [int(dut.expect(r'MARK %s (\d+)' % tag).group(1)) for tag in tags]
+
+
+def gaps(times):
+    return [b - a for a, b in zip(times, times[1:])]
+
+
+def check_scripted(dut, name):
+    sent = sum(len(data) for _, data in SCRIPT)
+    for args, expected in (('', [200, 300]), ('--speed 2', [100, 150]), ('--max', [0, 0])):
+        dut.write(f'replay {name} {args}')
+        times = marks(dut, 'abc')
+        dut.expect(r'Replayed %d bytes, 3 lines in [\d.]+ s \(recorded over 0\.500 s\)' % sent)
+        for gap, want in zip(gaps(times), expected):
+            assert abs(gap - want) <= TOLERANCE_MS, (args, times)
+
+
+def check_live(dut):
+    dut.write('record start live.rec')
+    dut.expect_exact("stop with 'record stop'")
+    dut.expect_exact('rec> ')
+    dut.write('mark x')
+    x = marks(dut, 'x')[0]
+    time.sleep(0.4)
+    dut.write('mark y')
+    y = marks(dut, 'y')[0]
+    dut.write('record stop')
+    dut.expect(r'Recorded \d+ bytes')
+
+    # The recorded gap is replayed: only the two mark lines, 'record stop' is cut
+    dut.write('replay live.rec')
+    times = marks(dut, 'xy')
+    dut.expect(r'Replayed \d+ bytes, 2 lines')
+    assert abs(gaps(times)[0] - (y - x)) <= TOLERANCE_MS, (x, y, times)
+
+
+def check_tool(dut, path):
+    run = subprocess.run([sys.executable, CLI_REPLAY, path, '--max', '--boot', '1', '-e', dut.app.elf_file],
+                         capture_output=True, timeout=60)
+    out = run.stdout.decode(errors='replace')
+    assert re.search(r'MARK a \d+.*MARK b \d+.*MARK c \d+', out, re.S), out
+    assert 'replayed 21 bytes, 3 lines' in run.stderr.decode(), run.stderr
+
+
+@pytest.mark.host_test
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_record_replay(dut: Dut) -> None:
+    directory = dut.expect(r'Record test ready in (\S+)').group(1).decode()
+    write_recording(os.path.join(directory, 'scripted.rec'), SCRIPT)
+    dut.expect_exact('rec> ')
+
+    check_scripted(dut, 'scripted.rec')
+    check_live(dut)
+    check_tool(dut, os.path.join(directory, 'scripted.rec'))
@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/* Host test app of the TCP console server
+ *
+ * cli-tcp.c runs unchanged; cli_exec_line() is replaced by a plain esp_console_run(), which is all the server needs
+ * from the rest of cli-api, and the metric registry by a table that the 'metrics' command prints in the same text
+ * format. pytest_tcp_console.py connects over 127.0.0.1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli-internal.h"
+#include "esp_console.h"
+#include "esp_err.h"
+
+#define TEST_TCP_PORT        2323
+#define TEST_METRIC_FAMILIES 8
+
+struct cli_metrics_writer
+{
+  const char *name;   /**< Family being printed */
+  const char *suffix; /**< "_total" for counters */
+};
+
+static uint8_t s_session = CLI_SESSION_CONSOLE;
+
+static struct
+{
+  const char *name;
+  cli_metric_type_t type;
+  cli_metric_cb_t cb;
+  void *arg;
+} s_families[TEST_METRIC_FAMILIES];
+static int s_family_count;
+
+/* ========================================================================== */
+/*                        CLI-API STAND-INS                                   */
+/* ========================================================================== */
+
+esp_err_t cli_exec_line(uint8_t session, const char *line, int *ret)
+{
+  s_session = session;
+  esp_err_t err = esp_console_run(line, ret);
+  s_session = CLI_SESSION_CONSOLE;
+  return err;
+}
+
+uint8_t cli_current_session(void)
+{
+  return s_session;
+}
+
+esp_err_t cli_metrics_register(
+  const char *name, cli_metric_type_t type, const char *help, cli_metric_cb_t cb, void *arg)
+{
+  if (s_family_count >= TEST_METRIC_FAMILIES)
+    return ESP_ERR_NO_MEM;
+  s_families[s_family_count].name = name;
+  s_families[s_family_count].type = type;
+  s_families[s_family_count].cb = cb;
+  s_families[s_family_count].arg = arg;
+  s_family_count++;
+  return ESP_OK;
+}
+
+void cli_metrics_sample(cli_metrics_writer_t *w, const char *labels, double value)
+{
+  if (labels != NULL)
+    printf("%s%s{%s} %.0f\n", w->name, w->suffix, labels, value);
+  else
+    printf("%s%s %.0f\n", w->name, w->suffix, value);
+}
+
+/* ========================================================================== */
+/*                              COMMANDS                                      */
+/* ========================================================================== */
+
+/** 'echo' prints its arguments, prefixed by the session they came from */
+static int echo_cmd(int argc, char **argv)
+{
+  printf("[tcp%d]", cli_current_session() - CLI_SESSION_TCP + 1);
+  for (int i = 1; i < argc; i++) printf(" %s", argv[i]);
+  printf("\n");
+  return 0;
+}
+
+/** 'lines <n>' prints n numbered lines, more than the socket buffers hold */
+static int lines_cmd(int argc, char **argv)
+{
+  int n = (argc > 1) ? atoi(argv[1]) : 1;
+  for (int i = 0; i < n; i++) printf("line %06d abcdefghijklmnopqrstuvwxyz\n", i);
+  return 0;
+}
+
+/** 'iac' prints a 0xFF byte, which must reach the client doubled */
+static int iac_cmd(int argc, char **argv)
+{
+  printf("a\xff" "b\n");
+  return 0;
+}
+
+/** 'metrics' prints the registered families */
+static int metrics_cmd(int argc, char **argv)
+{
+  for (int i = 0; i < s_family_count; i++)
+  {
+    cli_metrics_writer_t w = {.name = s_families[i].name,
+                              .suffix = (s_families[i].type == CLI_METRIC_COUNTER) ? "_total" : ""};
+    s_families[i].cb(&w, s_families[i].arg);
+  }
+  return 0;
+}
+
+/** 'fail' returns an error */
+static int fail_cmd(int argc, char **argv)
+{
+  return ESP_ERR_INVALID_STATE;
+}
+
+void app_main(void)
+{
+  esp_console_config_t config = ESP_CONSOLE_CONFIG_DEFAULT();
+  ESP_ERROR_CHECK(esp_console_init(&config));
+
+  const esp_console_cmd_t cmds[] = {
+    {.command = "echo", .help = "Print the arguments", .func = &echo_cmd},
+    {.command = "lines", .help = "Print <n> numbered lines", .func = &lines_cmd},
+    {.command = "iac", .help = "Print a 0xFF byte", .func = &iac_cmd},
+    {.command = "fail", .help = "Return an error", .func = &fail_cmd},
+    {.command = "metrics", .help = "Print the metrics", .func = &metrics_cmd},
+  };
+  for (size_t i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++) ESP_ERROR_CHECK(esp_console_cmd_register(&cmds[i]));
+
+  ESP_ERROR_CHECK(cli_tcp_start(TEST_TCP_PORT));
+  printf("TCP console test ready on port %d\n", TEST_TCP_PORT);
+}
@@ -0,0 +1,158 @@
+# SPDX-License-Identifier: MIT
+"""TCP console server (cli-tcp.c) on the linux target, over 127.0.0.1: telnet negotiation replies, concurrent
+sessions, refusal past CLI_TCP_MAX_SESSIONS, a command output much larger than the socket buffers, a peer that stops
+reading, and the transport metrics they leave behind."""
+
+import os
+import re
+import socket
+import subprocess
+import sys
+import time
+
+import pytest
+from pytest_embedded import Dut
+from pytest_embedded_idf.utils import idf_parametrize
+
+HOST = '127.0.0.1'
+PORT = 2323  # TEST_TCP_PORT in main/test_tcp_console.c
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', '..', '..')
+CLI_TCP = os.path.join(ROOT, 'tools', 'cli_tcp.py')
+TIMEOUT = 10.0
+
+IAC, DONT, DO, WONT, WILL, SB, SE = b'\xff', b'\xfe', b'\xfd', b'\xfc', b'\xfb', b'\xfa', b'\xf0'
+ECHO, SGA, NAWS = b'\x01', b'\x03', b'\x1f'
+
+
+def api_define(name):
+    with open(os.path.join(ROOT, 'components', 'cli-api', 'include', 'cli-api.h')) as f:
+        return int(re.search(r'#define %s (\d+)' % name, f.read()).group(1))
+
+
+def max_sessions():
+    return api_define('CLI_TCP_MAX_SESSIONS')
+
+
+def connect():
+    return socket.create_connection((HOST, PORT), timeout=TIMEOUT)
+
+
+def read_until(sock, pattern):
+    """Read until pattern (a regex on bytes) matches, or the peer closes; return everything read."""
+    buf = b''
+    deadline = time.monotonic() + TIMEOUT
+    while not re.search(pattern, buf):
+        assert time.monotonic() < deadline, f'no {pattern!r} in {buf[-200:]!r}'
+        data = sock.recv(65536)
+        if not data:
+            break
+        buf += data
+    return buf
+
+
+def prompt(n):
+    return rb'tcp%d> $' % n
+
+
+def check_negotiation():
+    with connect() as s:
+        read_until(s, prompt(1))
+        # Requests to enable options are refused, DONT/WONT need no answer, subnegotiations are skipped
+        s.sendall(IAC + DO + ECHO + IAC + WILL + NAWS + IAC + SB + NAWS + b'\x00\x50\x00\x18' + IAC + SE)
+        s.sendall(IAC + DONT + SGA + IAC + WONT + SGA + b'echo hi\r\n')
+        out = read_until(s, prompt(1))
+        assert out.startswith(IAC + WONT + ECHO + IAC + DONT + NAWS), out
+        assert out.count(IAC) == 2, out
+        assert b'[tcp1] hi\r\n' in out
+
+        # Output bytes equal to IAC are doubled, CR NUL ends a line like CR LF
+        s.sendall(b'iac\r\0')
+        assert b'a' + IAC + IAC + b'b\r\n' in read_until(s, prompt(1))
+
+
+def check_sessions():
+    with connect() as a, connect() as b:
+        read_until(a, prompt(1))
+        read_until(b, prompt(2))
+        # Each session assembles its own line
+        a.sendall(b'echo fr')
+        b.sendall(b'echo two\r\n')
+        assert b'[tcp2] two\r\n' in read_until(b, prompt(2))
+        a.sendall(b'om one\r\n')
+        assert b'[tcp1] from one\r\n' in read_until(a, prompt(1))
+
+        b.sendall(b'tcp_sessions\r\n')
+        out = read_until(b, prompt(2))
+        assert re.search(rb'tcp1 .*\r\n', out) and re.search(rb'tcp2 .*\(this session\)', out), out
+
+
+def check_refusal():
+    limit = max_sessions()
+    socks = [connect() for _ in range(limit)]
+    try:
+        for i, s in enumerate(socks, 1):
+            read_until(s, prompt(i))
+        with connect() as extra:
+            out = read_until(extra, rb'in use\r\n')
+            assert out == b'All %d console sessions are in use\r\n' % limit, out
+            assert extra.recv(16) == b''
+
+        # A closed session frees its slot
+        socks[0].sendall(b'\x04')
+        assert socks[0].recv(16) == b''
+        socks[0].close()
+        socks[0] = connect()
+        read_until(socks[0], prompt(1))
+    finally:
+        for s in socks:
+            s.close()
+
+
+def check_large_output():
+    count = 20000  # ~900 KB with CR LF
+    run = subprocess.run([sys.executable, CLI_TCP, HOST, '-P', str(PORT), f'lines {count}', 'fail', '--check'],
+                         capture_output=True, timeout=120)
+    lines = run.stdout.decode().splitlines()
+    assert lines[:count] == [f'line {i:06d} abcdefghijklmnopqrstuvwxyz' for i in range(count)]
+    assert lines[count].startswith('Command returned error')
+    assert run.returncode == 1  # --check: 'fail' reported an error
+
+
+def check_stalled_peer():
+    # A peer that stops reading: the output is dropped after CLI_TCP_SEND_TIMEOUT_MS and the session closed
+    s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    s.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+    s.settimeout(TIMEOUT)
+    s.connect((HOST, PORT))
+    with s:
+        read_until(s, prompt(1))
+        s.sendall(b'lines 200000\r\n')
+        time.sleep(api_define('CLI_TCP_SEND_TIMEOUT_MS') / 1000 + 1)
+        while s.recv(65536):
+            pass
+
+
+def check_metrics():
+    with connect() as s:
+        read_until(s, prompt(1))
+        s.sendall(b'metrics\r\n')
+        out = read_until(s, prompt(1)).decode()
+    values = {m.group(1): int(m.group(2)) for m in re.finditer(r'^(tcp_console\S+) (\d+)\r$', out, re.M)}
+    assert values['tcp_console_bytes_total{direction="tx"}'] > 900000, out  # check_large_output
+    assert values['tcp_console_bytes_total{direction="rx"}'] > 0, out
+    assert values['tcp_console_output_dropped_bytes_total'] > 0, out  # check_stalled_peer
+    assert values['tcp_console_connections_total{result="refused"}'] == 1, out  # check_refusal
+    assert values['tcp_console_connections_total{result="accepted"}'] >= max_sessions() + 4, out
+    assert values['tcp_console_sessions'] == 1, out
+
+
+@pytest.mark.host_test
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_tcp_console(dut: Dut) -> None:
+    dut.expect_exact(f'TCP console test ready on port {PORT}')
+    check_negotiation()
+    check_sessions()
+    check_refusal()
+    check_large_output()
+    check_stalled_peer()
+    check_metrics()
@@ -0,0 +1,429 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Console example — file commands for the cli-api FATFS volume
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include "cmd_fs.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "argtable3/argtable3.h"
+#include "cli-api.h"
+#include "diskio_wl.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "ff.h"
+#include "help_text.h"
+
+static const char *TAG = "cmd_fs";
+
+#define FS_PATH_MAX 128
+
+static struct
+{
+  struct arg_str *path;
+  struct arg_end *end;
+} ls_args;
+
+static struct
+{
+  struct arg_str *file;
+  struct arg_end *end;
+} file_args;
+
+static struct
+{
+  struct arg_str *src;
+  struct arg_str *dst;
+  struct arg_end *end;
+} mv_args;
+
+static struct
+{
+  struct arg_str *file;
+  struct arg_int *offset;
+  struct arg_int *length;
+  struct arg_end *end;
+} hexdump_args;
+
+/**
+ * @brief Resolve a name relative to the mount point ("log.txt" -> "/data/log.txt"), absolute paths are kept
+ *
+ * @return false if the volume is not mounted or the path is too long
+ */
+static bool fs_path(const char *name, char *out, size_t size)
+{
+  const char *mount = cli_get_storage(NULL);
+  if (mount == NULL)
+  {
+    printf("ERROR: No filesystem mounted (history storage disabled)\n");
+    return false;
+  }
+
+  int len = (name[0] == '/') ? snprintf(out, size, "%s", name) : snprintf(out, size, "%s/%s", mount, name);
+  if (len < 0 || (size_t)len >= size)
+  {
+    printf("ERROR: Path too long\n");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Allocate a transfer buffer of one wear-levelling sector
+ *
+ * Reads of whole, sector-aligned blocks let FATFS copy straight from flash into the buffer instead of going through
+ * its own per-file sector cache.
+ */
+static uint8_t *fs_buffer(size_t *size)
+{
+  wl_handle_t wl;
+  cli_get_storage(&wl);
+  *size = wl_sector_size(wl);
+
+  uint8_t *buf = malloc(*size);
+  if (buf == NULL)
+    ESP_LOGE(TAG, "No memory for a %u byte buffer", (unsigned)*size);
+  return buf;
+}
+
+/** 'ls' command lists a directory */
+
+static int fs_ls(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&ls_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, ls_args.end, argv[0]);
+    return 1;
+  }
+
+  char dir_path[FS_PATH_MAX];
+  if (!fs_path((ls_args.path->count > 0) ? ls_args.path->sval[0] : "", dir_path, sizeof(dir_path)))
+    return 1;
+
+  DIR *dir = opendir(dir_path);
+  if (dir == NULL)
+  {
+    printf("ERROR: Cannot open '%s': %s\n", dir_path, strerror(errno));
+    return 1;
+  }
+
+  int files = 0;
+  long total = 0;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL)
+  {
+    char path[FS_PATH_MAX];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+
+    if (entry->d_type == DT_DIR)
+    {
+      printf("%10s  %s/\n", "<DIR>", entry->d_name);
+    }
+    else if (stat(path, &st) != 0)
+    {
+      printf("%10s  %s\n", "?", entry->d_name);
+      files++;
+    }
+    else
+    {
+      printf("%10ld  %s\n", (long)st.st_size, entry->d_name);
+      files++;
+      total += st.st_size;
+    }
+  }
+  closedir(dir);
+
+  printf("%d file(s), %ld bytes\n", files, total);
+  return 0;
+}
+
+/** 'cat' command prints a file */
+
+static int fs_cat(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&file_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, file_args.end, argv[0]);
+    return 1;
+  }
+
+  char path[FS_PATH_MAX];
+  if (!fs_path(file_args.file->sval[0], path, sizeof(path)))
+    return 1;
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    printf("ERROR: Cannot open '%s': %s\n", path, strerror(errno));
+    return 1;
+  }
+
+  size_t size;
+  uint8_t *buf = fs_buffer(&size);
+  if (buf == NULL)
+  {
+    close(fd);
+    return 1;
+  }
+
+  ssize_t n;
+  while ((n = read(fd, buf, size)) > 0) fwrite(buf, 1, n, stdout);
+  if (n < 0)
+    printf("ERROR: Cannot read '%s': %s\n", path, strerror(errno));
+
+  free(buf);
+  close(fd);
+  return (n < 0) ? 1 : 0;
+}
+
+/** 'hexdump' command dumps a file, or part of it */
+
+static int fs_hexdump(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&hexdump_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, hexdump_args.end, argv[0]);
+    return 1;
+  }
+
+  char path[FS_PATH_MAX];
+  if (!fs_path(hexdump_args.file->sval[0], path, sizeof(path)))
+    return 1;
+
+  int offset = (hexdump_args.offset->count > 0) ? hexdump_args.offset->ival[0] : 0;
+  int remaining = (hexdump_args.length->count > 0) ? hexdump_args.length->ival[0] : INT32_MAX;
+  if (offset < 0 || remaining <= 0)
+  {
+    printf("ERROR: Offset must be >= 0 and length > 0\n");
+    return 1;
+  }
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    printf("ERROR: Cannot open '%s': %s\n", path, strerror(errno));
+    return 1;
+  }
+  if (lseek(fd, offset, SEEK_SET) < 0)
+  {
+    printf("ERROR: Cannot seek to %d\n", offset);
+    close(fd);
+    return 1;
+  }
+
+  size_t size;
+  uint8_t *buf = fs_buffer(&size);
+  if (buf == NULL)
+  {
+    close(fd);
+    return 1;
+  }
+
+  ssize_t n = 0;
+  while (remaining > 0 && (n = read(fd, buf, (size_t)remaining < size ? (size_t)remaining : size)) > 0)
+  {
+    cli_hexdump((uint32_t)offset, buf, n);
+    offset += n;
+    remaining -= n;
+  }
+  if (n < 0)
+    printf("ERROR: Cannot read '%s' at %d: %s\n", path, offset, strerror(errno));
+
+  free(buf);
+  close(fd);
+  return (n < 0) ? 1 : 0;
+}
+
+/** 'rm' command deletes a file */
+
+static int fs_rm(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&file_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, file_args.end, argv[0]);
+    return 1;
+  }
+
+  char path[FS_PATH_MAX];
+  if (!fs_path(file_args.file->sval[0], path, sizeof(path)))
+    return 1;
+
+  if (unlink(path) != 0)
+  {
+    printf("ERROR: Cannot remove '%s': %s\n", path, strerror(errno));
+    return 1;
+  }
+  return 0;
+}
+
+/** 'mv' command renames or moves a file */
+
+static int fs_mv(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&mv_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, mv_args.end, argv[0]);
+    return 1;
+  }
+
+  char src[FS_PATH_MAX], dst[FS_PATH_MAX];
+  if (!fs_path(mv_args.src->sval[0], src, sizeof(src)) || !fs_path(mv_args.dst->sval[0], dst, sizeof(dst)))
+    return 1;
+
+  if (rename(src, dst) != 0)
+  {
+    printf("ERROR: Cannot move '%s' to '%s': %s\n", src, dst, strerror(errno));
+    return 1;
+  }
+  return 0;
+}
+
+/** 'df' command reports FAT and wear-levelling usage */
+
+static int fs_df(int argc, char **argv)
+{
+  wl_handle_t wl;
+  const char *mount = cli_get_storage(&wl);
+  if (mount == NULL)
+  {
+    printf("ERROR: No filesystem mounted (history storage disabled)\n");
+    return 1;
+  }
+
+  char drive[3] = {(char)('0' + ff_diskio_get_pdrv_wl(wl)), ':', '\0'};
+  FATFS *fs;
+  DWORD free_clusters;
+  FRESULT res = f_getfree(drive, &free_clusters, &fs);
+  if (res != FR_OK)
+  {
+    printf("ERROR: f_getfree failed (%d)\n", res);
+    return 1;
+  }
+
+  static const char *const fat_types[] = {"?", "FAT12", "FAT16", "FAT32", "exFAT"};
+  size_t sector = wl_sector_size(wl);
+  size_t usable = wl_size(wl);
+  uint32_t cluster = fs->csize * sector;
+  uint32_t total_clusters = fs->n_fatent - 2;
+  const esp_partition_t *part =
+    esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_FAT, CLI_STORAGE_PARTITION);
+
+  printf("Mount:       %s (%s)\n", mount, fat_types[fs->fs_type <= 4 ? fs->fs_type : 0]);
+  if (part != NULL)
+  {
+    printf("Partition:   %s, %" PRIu32 " bytes\n", part->label, part->size);
+    printf("Wear level:  %u byte sectors, %u usable, %" PRIu32 " reserved for WL state\n",
+           (unsigned)sector,
+           (unsigned)usable,
+           part->size - (uint32_t)usable);
+  }
+  printf("Clusters:    %" PRIu32 " x %" PRIu32 " bytes, %" PRIu32 " free\n",
+         total_clusters,
+         cluster,
+         (uint32_t)free_clusters);
+  printf("Used:        %" PRIu32 " / %" PRIu32 " bytes (%" PRIu32 "%%)\n",
+         (total_clusters - (uint32_t)free_clusters) * cluster,
+         total_clusters * cluster,
+         total_clusters ? (total_clusters - (uint32_t)free_clusters) * 100 / total_clusters : 0);
+
+  return 0;
+}
+
+/* Argument tables are built on first use (cli_register_lazy_command()) */
+
+static void build_ls_args(void)
+{
+  ls_args.path = arg_str0(NULL, NULL, "<dir>", HELP_LS_DIR);
+  ls_args.end = arg_end(1);
+}
+
+static void build_file_args(void)
+{
+  /* Shared by cat and rm: built by whichever is used first */
+  if (file_args.end != NULL)
+    return;
+  file_args.file = arg_str1(NULL, NULL, "<file>", HELP_FS_FILE);
+  file_args.end = arg_end(1);
+}
+
+static void build_mv_args(void)
+{
+  mv_args.src = arg_str1(NULL, NULL, "<src>", HELP_MV_SRC);
+  mv_args.dst = arg_str1(NULL, NULL, "<dst>", HELP_MV_DST);
+  mv_args.end = arg_end(2);
+}
+
+static void build_hexdump_args(void)
+{
+  hexdump_args.file = arg_str1(NULL, NULL, "<file>", HELP_FS_FILE_NAME);
+  hexdump_args.offset = arg_int0("o", "offset", "<offset>", HELP_HEXDUMP_OFFSET);
+  hexdump_args.length = arg_int0("n", "len", "<len>", HELP_HEXDUMP_LEN);
+  hexdump_args.end = arg_end(3);
+}
+
+void register_fs(void)
+{
+  static const cli_lazy_command_t cmds[] = {
+    {.command = "ls",
+     .help = HELP_LS,
+     .func = &fs_ls,
+     .argtable = &ls_args,
+     .argtable_len = CLI_ARGTABLE_LEN(ls_args),
+     .build = build_ls_args},
+    {.command = "cat",
+     .help = HELP_CAT,
+     .func = &fs_cat,
+     .argtable = &file_args,
+     .argtable_len = CLI_ARGTABLE_LEN(file_args),
+     .build = build_file_args},
+    {.command = "hexdump",
+     .help = HELP_HEXDUMP,
+     .func = &fs_hexdump,
+     .argtable = &hexdump_args,
+     .argtable_len = CLI_ARGTABLE_LEN(hexdump_args),
+     .build = build_hexdump_args},
+    {.command = "rm",
+     .help = HELP_RM,
+     .func = &fs_rm,
+     .argtable = &file_args,
+     .argtable_len = CLI_ARGTABLE_LEN(file_args),
+     .build = build_file_args},
+    {.command = "mv",
+     .help = HELP_MV,
+     .func = &fs_mv,
+     .argtable = &mv_args,
+     .argtable_len = CLI_ARGTABLE_LEN(mv_args),
+     .build = build_mv_args},
+    {.command = "df", .help = HELP_DF, .func = &fs_df},
+  };
+
+  for (size_t i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++) ESP_ERROR_CHECK(cli_register_lazy_command(&cmds[i]));
+
+  register_fs_bench();
+  register_fs_xfer();
+}
@@ -0,0 +1,18 @@
+/* Console example — declarations of command registration functions.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+// Register file commands for the cli-api FATFS volume: "ls", "cat", "rm", "mv", "df", "hexdump"
+void register_fs(void);
+
+// Register the "fsbench" filesystem benchmark (called by register_fs)
+void register_fs_bench(void);
+
+// Register the "rx" and "tx" file transfer commands (called by register_fs)
+void register_fs_xfer(void);
@@ -0,0 +1,359 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Console example — filesystem benchmark for the cli-api FATFS volume
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "argtable3/argtable3.h"
+#include "cli-api.h"
+#include "cmd_fs.h"
+#include "esp_console.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "help_text.h"
+
+/* Limited by max_files of the cli-api mount; the history file is only open while it is being saved */
+#define FSBENCH_MAX_FILES 4
+
+#define FSBENCH_MAX_BLOCKS    4
+#define FSBENCH_DEFAULT_KB    64
+#define FSBENCH_APPEND_SIZE   64 /* Size of one history-like record for the append+fsync test */
+#define FSBENCH_APPEND_ROUNDS 16
+
+static const int s_default_blocks[] = {512, 4096, 16384};
+
+/**
+ * @brief Accumulated timing of one benchmark phase
+ */
+typedef struct
+{
+  int64_t total_us; /**< Sum of the individual operation times */
+  int64_t max_us;   /**< Slowest operation */
+  uint32_t ops;     /**< Number of operations */
+  size_t bytes;     /**< Bytes transferred */
+} fsbench_stat_t;
+
+static struct
+{
+  struct arg_int *size_kb;
+  struct arg_int *block;
+  struct arg_int *files;
+  struct arg_lit *json;
+  struct arg_end *end;
+} fsbench_args;
+
+static void fsbench_account(fsbench_stat_t *st, int64_t start_us, size_t bytes)
+{
+  int64_t dt = esp_timer_get_time() - start_us;
+  st->total_us += dt;
+  if (dt > st->max_us)
+    st->max_us = dt;
+  st->ops++;
+  st->bytes += bytes;
+}
+
+static void fsbench_report(const char *test, int block, int files, const fsbench_stat_t *st, bool json)
+{
+  uint32_t kbps = st->total_us > 0 ? (uint32_t)((int64_t)st->bytes * 1000000 / 1024 / st->total_us) : 0;
+  uint32_t avg_us = st->ops > 0 ? (uint32_t)(st->total_us / st->ops) : 0;
+
+  if (json)
+    printf("{\"test\":\"%s\",\"block\":%d,\"files\":%d,\"bytes\":%u,\"ops\":%" PRIu32 ",\"us\":%" PRId64
+           ",\"kbps\":%" PRIu32 ",\"lat_avg_us\":%" PRIu32 ",\"lat_max_us\":%" PRId64 "}\n",
+           test,
+           block,
+           files,
+           (unsigned)st->bytes,
+           st->ops,
+           st->total_us,
+           kbps,
+           avg_us,
+           st->max_us);
+  else
+    printf("%-12s %6d %5d %8" PRIu32 " %10" PRIu32 " %10" PRId64 "\n", test, block, files, kbps, avg_us, st->max_us);
+}
+
+static void fsbench_close_all(int *fds, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    if (fds[i] >= 0)
+      close(fds[i]);
+    fds[i] = -1;
+  }
+}
+
+/**
+ * @brief Timed fsync; a failed flush is reported and ends the run, its timing would not mean anything
+ */
+static bool fsbench_sync(int fd, fsbench_stat_t *st)
+{
+  int64_t t0 = esp_timer_get_time();
+  if (fsync(fd) != 0)
+  {
+    printf("ERROR: fsync failed: %s\n", strerror(errno));
+    return false;
+  }
+  fsbench_account(st, t0, 0);
+  return true;
+}
+
+static bool fsbench_open_all(int *fds, int count, int flags, char paths[][32])
+{
+  for (int i = 0; i < count; i++)
+  {
+    fds[i] = open(paths[i], flags, 0666);
+    if (fds[i] < 0)
+    {
+      printf("ERROR: Cannot open '%s': %s\n", paths[i], strerror(errno));
+      fsbench_close_all(fds, i);
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Run all phases for one block size
+ *
+ * Sequential phases interleave blocks round-robin over all scratch files, so each open file competes for the FATFS
+ * sector cache like concurrent writers would. Random phases use the first file only.
+ */
+static bool fsbench_run_block(uint8_t *buf, int block, int files, size_t per_file, char paths[][32], bool json)
+{
+  int fds[FSBENCH_MAX_FILES];
+  uint32_t blocks_per_file = per_file / block;
+  fsbench_stat_t st;
+  int64_t t0;
+
+  /* Sequential write, then the cost of flushing it */
+  if (!fsbench_open_all(fds, files, O_WRONLY | O_CREAT | O_TRUNC, paths))
+    return false;
+  memset(&st, 0, sizeof(st));
+  for (uint32_t i = 0; i < blocks_per_file * files; i++)
+  {
+    t0 = esp_timer_get_time();
+    if (write(fds[i % files], buf, block) != block)
+    {
+      printf("ERROR: Write failed: %s\n", strerror(errno));
+      fsbench_close_all(fds, files);
+      return false;
+    }
+    fsbench_account(&st, t0, block);
+  }
+  fsbench_report("seq_write", block, files, &st, json);
+
+  memset(&st, 0, sizeof(st));
+  for (int i = 0; i < files; i++)
+  {
+    if (!fsbench_sync(fds[i], &st))
+    {
+      fsbench_close_all(fds, files);
+      return false;
+    }
+  }
+  fsbench_report("fsync", block, files, &st, json);
+  fsbench_close_all(fds, files);
+
+  /* Sequential read */
+  if (!fsbench_open_all(fds, files, O_RDONLY, paths))
+    return false;
+  memset(&st, 0, sizeof(st));
+  for (uint32_t i = 0; i < blocks_per_file * files; i++)
+  {
+    t0 = esp_timer_get_time();
+    if (read(fds[i % files], buf, block) != block)
+      break;
+    fsbench_account(&st, t0, block);
+  }
+  fsbench_report("seq_read", block, files, &st, json);
+  fsbench_close_all(fds, files);
+
+  /* Random, block-aligned reads and writes; the seek is part of the measured operation */
+  if (!fsbench_open_all(fds, 1, O_RDWR, paths))
+    return false;
+  memset(&st, 0, sizeof(st));
+  for (uint32_t i = 0; i < blocks_per_file; i++)
+  {
+    off_t offset = (off_t)(esp_random() % blocks_per_file) * block;
+    t0 = esp_timer_get_time();
+    if (lseek(fds[0], offset, SEEK_SET) < 0 || read(fds[0], buf, block) != block)
+      break;
+    fsbench_account(&st, t0, block);
+  }
+  fsbench_report("rand_read", block, 1, &st, json);
+
+  memset(&st, 0, sizeof(st));
+  for (uint32_t i = 0; i < blocks_per_file; i++)
+  {
+    off_t offset = (off_t)(esp_random() % blocks_per_file) * block;
+    t0 = esp_timer_get_time();
+    if (lseek(fds[0], offset, SEEK_SET) < 0 || write(fds[0], buf, block) != block)
+      break;
+    fsbench_account(&st, t0, block);
+  }
+  if (!fsbench_sync(fds[0], &st))
+  {
+    fsbench_close_all(fds, 1);
+    return false;
+  }
+  fsbench_report("rand_write", block, 1, &st, json);
+  fsbench_close_all(fds, 1);
+
+  return true;
+}
+
+/**
+ * @brief Small appends each followed by fsync, the access pattern of saving console history or a log line
+ */
+static bool fsbench_run_append(uint8_t *buf, char paths[][32], bool json)
+{
+  int fd = open(paths[0], O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+  {
+    printf("ERROR: Cannot open '%s': %s\n", paths[0], strerror(errno));
+    return false;
+  }
+
+  fsbench_stat_t st = {0};
+  for (int i = 0; i < FSBENCH_APPEND_ROUNDS; i++)
+  {
+    int64_t t0 = esp_timer_get_time();
+    if (write(fd, buf, FSBENCH_APPEND_SIZE) != FSBENCH_APPEND_SIZE)
+    {
+      printf("ERROR: Write failed: %s\n", strerror(errno));
+      close(fd);
+      return false;
+    }
+    if (fsync(fd) != 0)
+    {
+      printf("ERROR: fsync failed: %s\n", strerror(errno));
+      close(fd);
+      return false;
+    }
+    fsbench_account(&st, t0, FSBENCH_APPEND_SIZE);
+  }
+  close(fd);
+
+  fsbench_report("append_sync", FSBENCH_APPEND_SIZE, 1, &st, json);
+  return true;
+}
+
+/** 'fsbench' command measures throughput and latency of the storage volume */
+
+static int fsbench(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&fsbench_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, fsbench_args.end, argv[0]);
+    return 1;
+  }
+
+  const char *mount = cli_get_storage(NULL);
+  if (mount == NULL)
+  {
+    printf("ERROR: No filesystem mounted (history storage disabled)\n");
+    return 1;
+  }
+
+  int size_kb = (fsbench_args.size_kb->count > 0) ? fsbench_args.size_kb->ival[0] : FSBENCH_DEFAULT_KB;
+  int files = (fsbench_args.files->count > 0) ? fsbench_args.files->ival[0] : 1;
+  bool json = fsbench_args.json->count > 0;
+  if (size_kb <= 0 || files < 1 || files > FSBENCH_MAX_FILES)
+  {
+    printf("ERROR: Size must be > 0 KB and files between 1 and %d\n", FSBENCH_MAX_FILES);
+    return 1;
+  }
+
+  const int *blocks = s_default_blocks;
+  int block_count = sizeof(s_default_blocks) / sizeof(s_default_blocks[0]);
+  if (fsbench_args.block->count > 0)
+  {
+    blocks = fsbench_args.block->ival;
+    block_count = fsbench_args.block->count;
+  }
+
+  int max_block = FSBENCH_APPEND_SIZE;
+  for (int i = 0; i < block_count; i++)
+  {
+    if (blocks[i] <= 0)
+    {
+      printf("ERROR: Block sizes must be > 0\n");
+      return 1;
+    }
+    if (blocks[i] > max_block)
+      max_block = blocks[i];
+  }
+
+  uint8_t *buf = malloc(max_block);
+  if (buf == NULL)
+  {
+    printf("ERROR: No memory for a %d byte buffer\n", max_block);
+    return 1;
+  }
+  for (int i = 0; i < max_block; i++) buf[i] = (uint8_t)i;
+
+  char paths[FSBENCH_MAX_FILES][32];
+  for (int i = 0; i < files; i++) snprintf(paths[i], sizeof(paths[i]), "%s/fsbench%d.tmp", mount, i);
+
+  size_t per_file = (size_t)size_kb * 1024 / files;
+  if (!json)
+    printf("%-12s %6s %5s %8s %10s %10s\n", "Test", "Block", "Files", "KB/s", "Avg us", "Max us");
+
+  bool ok = true;
+  for (int i = 0; ok && i < block_count; i++)
+  {
+    if ((size_t)blocks[i] > per_file)
+    {
+      printf("Skipping block %d: larger than the %u bytes per file\n", blocks[i], (unsigned)per_file);
+      continue;
+    }
+    ok = fsbench_run_block(buf, blocks[i], files, per_file, paths, json);
+  }
+  if (ok)
+    ok = fsbench_run_append(buf, paths, json);
+
+  for (int i = 0; i < files; i++) unlink(paths[i]);
+  free(buf);
+
+  return ok ? 0 : 1;
+}
+
+static void build_fsbench_args(void)
+{
+  fsbench_args.size_kb = arg_int0("s", "size", "<KB>", HELP_FSBENCH_SIZE);
+  fsbench_args.block = arg_intn("b", "block", "<bytes>", 0, FSBENCH_MAX_BLOCKS, HELP_FSBENCH_BLOCK);
+  fsbench_args.files = arg_int0("f", "files", "<N>", HELP_FSBENCH_FILES);
+  fsbench_args.json = arg_lit0("j", "json", HELP_FSBENCH_JSON);
+  fsbench_args.end = arg_end(4);
+}
+
+void register_fs_bench(void)
+{
+  static const cli_lazy_command_t cmd = {.command = "fsbench",
+                                         .help = HELP_FSBENCH,
+                                         .hint = NULL,
+                                         .func = &fsbench,
+                                         .argtable = &fsbench_args,
+                                         .argtable_len = CLI_ARGTABLE_LEN(fsbench_args),
+                                         .build = build_fsbench_args};
+
+  ESP_ERROR_CHECK(cli_register_lazy_command(&cmd));
+}
@@ -0,0 +1,626 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Console example — binary file transfer over the console
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+
+   Frame layout (little endian), CRC32 (zlib polynomial) over type..payload:
+
+     0xA5 | type | seq | len (2) | offset (4) | payload (len) | crc32 (4)
+
+   The sender keeps up to XFER_WINDOW data frames in flight. The receiver only accepts the frame at the next expected
+   offset and answers with a cumulative ACK, or a NAK carrying the offset it expects (go-back-N). Offsets instead of
+   sequence numbers make resume trivial: both sides start from the size of the partially received file.
+
+   A partial file is only resumed if it holds the beginning of this very file: START carries the CRC32 of the prefix
+   the receiver already has, and a mismatch (another file, or an older version of it) restarts from offset 0. END
+   carries the CRC32 of the whole file, which the receiver checks before the partial file takes the final name.
+
+   The host counterpart is tools/cli_xfer.py.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "argtable3/argtable3.h"
+#include "cli-api.h"
+#include "cmd_fs.h"
+#include "esp_console.h"
+#include "esp_rom_crc.h"
+#include "help_text.h"
+#include "sdkconfig.h"
+
+#define XFER_SOF              0xA5
+#define XFER_BLOCK_SIZE       1024 /* Payload of one data frame; a full window fills one 4 KB sector */
+#define XFER_WINDOW           4
+#define XFER_HDR_SIZE         9
+#define XFER_CRC_SIZE         4
+#define XFER_FRAME_MAX        (XFER_HDR_SIZE + XFER_BLOCK_SIZE + XFER_CRC_SIZE)
+#define XFER_TIMEOUT_MS       2000
+#define XFER_START_TIMEOUT_MS 30000
+#define XFER_MAX_RETRIES      10
+#define XFER_PART_SUFFIX      ".part"
+#define XFER_PATH_MAX         128
+
+/* Window the device accepts when receiving, advertised in the ACK to START. A UART console has no flow control and a
+ * small driver buffer, so bytes arriving while a flash write blocks would be lost: use stop-and-wait there. */
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+#define XFER_RX_WINDOW 1
+#else
+#define XFER_RX_WINDOW XFER_WINDOW
+#endif
+
+typedef enum
+{
+  XFER_START = 'S', /**< Handshake, offset = partial file size; payload: [total size (u32), rx only] prefix CRC32 */
+  XFER_DATA = 'D',  /**< File bytes at offset */
+  XFER_ACK = 'A',   /**< All bytes before offset received; the ACK to START gives the resume offset (rx: + window) */
+  XFER_NAK = 'N',   /**< Resend from offset */
+  XFER_END = 'E',   /**< Transfer complete, offset = total size; payload: file CRC32 */
+  XFER_ABORT = 'X', /**< Give up */
+} xfer_type_t;
+
+/**
+ * @brief One decoded frame (payload points into the receive buffer)
+ */
+typedef struct
+{
+  uint8_t type;           /**< xfer_type_t */
+  uint8_t seq;            /**< Frame counter, informational */
+  uint16_t len;           /**< Payload length */
+  uint32_t offset;        /**< File offset the frame refers to */
+  const uint8_t *payload; /**< Payload bytes */
+} xfer_frame_t;
+
+/**
+ * @brief Transfer buffers, allocated once per command
+ */
+typedef struct
+{
+  uint8_t rx[XFER_FRAME_MAX * 2]; /**< Raw bytes from the console, holds a frame plus the start of the next */
+  size_t rx_len;                  /**< Valid bytes in rx */
+  uint8_t tx[XFER_FRAME_MAX];     /**< Outgoing frame */
+  uint8_t seq;                    /**< Next outgoing sequence number */
+} xfer_t;
+
+static struct
+{
+  struct arg_str *path;
+  struct arg_end *end;
+} xfer_args;
+
+/* Link counters since boot, exported through 'metrics' */
+static struct
+{
+  uint64_t bytes[2];    /**< [0] sent, [1] received, frame bytes on the console */
+  uint32_t dropped;     /**< Frames discarded: bad CRC, or out of order while waiting for a resend */
+  uint32_t retransmits; /**< Sender rewinds after a NAK or an ACK timeout */
+} s_xfer_stats;
+
+/* ========================================================================== */
+/*                              FRAMING                                       */
+/* ========================================================================== */
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+  for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void xfer_send(xfer_t *x, uint8_t type, uint32_t offset, const void *payload, uint16_t len)
+{
+  uint8_t *p = x->tx;
+  p[0] = XFER_SOF;
+  p[1] = type;
+  p[2] = x->seq++;
+  put_le16(&p[3], len);
+  put_le32(&p[5], offset);
+  if (len > 0)
+    memcpy(&p[XFER_HDR_SIZE], payload, len);
+  put_le32(&p[XFER_HDR_SIZE + len], esp_rom_crc32_le(0, &p[1], XFER_HDR_SIZE - 1 + len));
+
+  fwrite(p, 1, XFER_HDR_SIZE + len + XFER_CRC_SIZE, stdout);
+  fflush(stdout);
+  s_xfer_stats.bytes[0] += XFER_HDR_SIZE + len + XFER_CRC_SIZE;
+}
+
+/**
+ * @brief Try to decode a frame at the start of the receive buffer, skipping garbage and corrupted frames
+ *
+ * @return true if a frame was decoded; it stays valid until the next xfer_recv() call
+ */
+static bool xfer_parse(xfer_t *x, xfer_frame_t *f, size_t *consumed)
+{
+  for (;;)
+  {
+    uint8_t *sof = memchr(x->rx, XFER_SOF, x->rx_len);
+    if (sof == NULL)
+    {
+      x->rx_len = 0;
+      return false;
+    }
+    if (sof != x->rx)
+    {
+      x->rx_len -= sof - x->rx;
+      memmove(x->rx, sof, x->rx_len);
+    }
+    if (x->rx_len < XFER_HDR_SIZE)
+      return false;
+
+    uint16_t len = x->rx[3] | (x->rx[4] << 8);
+    if (len > XFER_BLOCK_SIZE)
+    {
+      /* Not a real header: drop the SOF byte and resynchronize */
+      memmove(x->rx, x->rx + 1, --x->rx_len);
+      continue;
+    }
+    size_t total = XFER_HDR_SIZE + len + XFER_CRC_SIZE;
+    if (x->rx_len < total)
+      return false;
+
+    if (esp_rom_crc32_le(0, &x->rx[1], XFER_HDR_SIZE - 1 + len) != get_le32(&x->rx[XFER_HDR_SIZE + len]))
+    {
+      s_xfer_stats.dropped++;
+      memmove(x->rx, x->rx + 1, --x->rx_len);
+      continue;
+    }
+
+    f->type = x->rx[1];
+    f->seq = x->rx[2];
+    f->len = len;
+    f->offset = get_le32(&x->rx[5]);
+    f->payload = &x->rx[XFER_HDR_SIZE];
+    *consumed = total;
+    return true;
+  }
+}
+
+/**
+ * @brief Wait for the next valid frame
+ *
+ * @return true if a frame arrived, false on timeout
+ */
+static bool xfer_recv(xfer_t *x, xfer_frame_t *f, int timeout_ms, size_t *pending)
+{
+  /* Drop the frame returned by the previous call */
+  if (*pending > 0)
+  {
+    x->rx_len -= *pending;
+    memmove(x->rx, x->rx + *pending, x->rx_len);
+    *pending = 0;
+  }
+
+  int fd = fileno(stdin);
+  for (;;)
+  {
+    if (xfer_parse(x, f, pending))
+      return true;
+
+    /* Bytes the console read ahead together with the command line come first */
+    size_t taken = cli_input_read(x->rx + x->rx_len, sizeof(x->rx) - x->rx_len);
+    if (taken > 0)
+    {
+      x->rx_len += taken;
+      s_xfer_stats.bytes[1] += taken;
+      continue;
+    }
+
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    FD_SET(fd, &rfds);
+    struct timeval tv = {.tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000};
+    if (select(fd + 1, &rfds, NULL, NULL, &tv) <= 0)
+      return false;
+
+    ssize_t n = read(fd, x->rx + x->rx_len, sizeof(x->rx) - x->rx_len);
+    if (n > 0)
+    {
+      x->rx_len += n;
+      s_xfer_stats.bytes[1] += n;
+    }
+  }
+}
+
+/**
+ * @brief CRC32 of the first prefix bytes of a file and of its first size bytes, in one pass
+ */
+static bool xfer_file_crc(int fd, uint32_t size, uint32_t prefix, uint8_t *block, uint32_t *prefix_crc, uint32_t *crc)
+{
+  *crc = 0;
+  *prefix_crc = 0;
+  if (lseek(fd, 0, SEEK_SET) < 0)
+    return false;
+
+  for (uint32_t pos = 0; pos < size;)
+  {
+    uint32_t len = (size - pos < XFER_BLOCK_SIZE) ? size - pos : XFER_BLOCK_SIZE;
+    if (pos < prefix && pos + len > prefix)
+      len = prefix - pos;
+    if (read(fd, block, len) != (ssize_t)len)
+      return false;
+    *crc = esp_rom_crc32_le(*crc, block, len);
+    pos += len;
+    if (pos == prefix)
+      *prefix_crc = *crc;
+  }
+
+  return true;
+}
+
+/* ========================================================================== */
+/*                          DEVICE -> HOST ('tx')                             */
+/* ========================================================================== */
+
+static bool xfer_send_file(xfer_t *x, int fd, uint32_t size, uint8_t *block)
+{
+  xfer_frame_t f;
+  size_t pending = 0;
+
+  /* The host starts with the size and CRC of its partial copy */
+  for (;;)
+  {
+    if (!xfer_recv(x, &f, XFER_START_TIMEOUT_MS, &pending))
+      return false;
+    if (f.type == XFER_ABORT)
+      return false;
+    if (f.type == XFER_START && f.len >= 4)
+      break;
+  }
+
+  /* Resume only if the host's partial copy is the beginning of this file */
+  uint32_t prefix = (f.offset <= size) ? f.offset : 0;
+  uint32_t prefix_crc, file_crc;
+  if (!xfer_file_crc(fd, size, prefix, block, &prefix_crc, &file_crc))
+    return false;
+  const uint32_t start = (prefix_crc == get_le32(f.payload)) ? prefix : 0;
+  xfer_send(x, XFER_ACK, start, NULL, 0);
+
+  uint32_t acked = start;
+  uint32_t next = acked;
+  int retries = 0;
+  lseek(fd, next, SEEK_SET);
+
+  while (acked < size)
+  {
+    while (next < size && next - acked < XFER_WINDOW * XFER_BLOCK_SIZE)
+    {
+      uint32_t len = (size - next < XFER_BLOCK_SIZE) ? size - next : XFER_BLOCK_SIZE;
+      if (read(fd, block, len) != (ssize_t)len)
+        return false;
+      xfer_send(x, XFER_DATA, next, block, len);
+      next += len;
+    }
+
+    bool rewind = false;
+    if (!xfer_recv(x, &f, XFER_TIMEOUT_MS, &pending))
+    {
+      rewind = true;
+    }
+    else if (f.type == XFER_ABORT)
+    {
+      return false;
+    }
+    else if (f.type == XFER_START)
+    {
+      /* The ACK to START was lost */
+      xfer_send(x, XFER_ACK, start, NULL, 0);
+    }
+    else if ((f.type == XFER_ACK || f.type == XFER_NAK) && f.offset >= acked && f.offset <= next)
+    {
+      if (f.offset > acked)
+        retries = 0;
+      acked = f.offset;
+      rewind = (f.type == XFER_NAK);
+    }
+
+    if (rewind)
+    {
+      if (++retries > XFER_MAX_RETRIES)
+        return false;
+      s_xfer_stats.retransmits++;
+      next = acked;
+      lseek(fd, next, SEEK_SET);
+    }
+  }
+
+  uint8_t crc[4];
+  put_le32(crc, file_crc);
+  for (retries = 0; retries <= XFER_MAX_RETRIES; retries++)
+  {
+    xfer_send(x, XFER_END, size, crc, sizeof(crc));
+    if (xfer_recv(x, &f, XFER_TIMEOUT_MS, &pending) && f.type == XFER_ACK && f.offset == size)
+      return true;
+  }
+  return false;
+}
+
+/** 'tx' command sends a file to the host */
+
+static int xfer_tx(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&xfer_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, xfer_args.end, argv[0]);
+    return 1;
+  }
+
+  const char *mount = cli_get_storage(NULL);
+  const char *name = xfer_args.path->sval[0];
+  char path[XFER_PATH_MAX];
+  if (mount == NULL || snprintf(path, sizeof(path), "%s/%s", mount, name) >= (int)sizeof(path))
+  {
+    printf("ERROR: Invalid path or no filesystem mounted\n");
+    return 1;
+  }
+
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0)
+  {
+    printf("ERROR: Cannot open '%s': %s\n", path, strerror(errno));
+    if (fd >= 0)
+      close(fd);
+    return 1;
+  }
+
+  xfer_t *x = calloc(1, sizeof(xfer_t));
+  uint8_t *block = malloc(XFER_BLOCK_SIZE);
+  bool ok = false;
+  if (x && block)
+  {
+    /* Announce in text mode so the host can find the start of the binary stream */
+    printf("XFER TX %ld\n", (long)st.st_size);
+    cli_set_binary_mode(true);
+    ok = xfer_send_file(x, fd, (uint32_t)st.st_size, block);
+    if (!ok)
+      xfer_send(x, XFER_ABORT, 0, NULL, 0);
+    cli_set_binary_mode(false);
+  }
+
+  free(block);
+  free(x);
+  close(fd);
+
+  printf("\n%s\n", ok ? "XFER OK" : "XFER FAILED");
+  return ok ? 0 : 1;
+}
+
+/* ========================================================================== */
+/*                          HOST -> DEVICE ('rx')                             */
+/* ========================================================================== */
+
+static bool xfer_recv_file(xfer_t *x, int fd, uint32_t resume, uint32_t *total, uint8_t *block)
+{
+  xfer_frame_t f;
+  size_t pending = 0;
+
+  uint32_t part_crc, crc;
+  if (!xfer_file_crc(fd, resume, resume, block, &part_crc, &crc))
+    return false;
+
+  for (;;)
+  {
+    if (!xfer_recv(x, &f, XFER_START_TIMEOUT_MS, &pending) || f.type == XFER_ABORT)
+      return false;
+    if (f.type == XFER_START && f.len >= 8)
+      break;
+  }
+  *total = get_le32(f.payload);
+
+  /* The partial file is resumed only if the host's file starts with the same bytes; otherwise it belongs to another
+   * file or to an older version of this one */
+  uint32_t expected = 0;
+  if (f.offset == resume && resume <= *total && get_le32(&f.payload[4]) == part_crc)
+    expected = resume;
+  crc = (expected > 0) ? part_crc : 0;
+  if (ftruncate(fd, expected) != 0 || lseek(fd, expected, SEEK_SET) < 0)
+    return false;
+  const uint8_t window = XFER_RX_WINDOW;
+  xfer_send(x, XFER_ACK, expected, &window, 1);
+
+  bool nak_sent = false;
+  int retries = 0;
+  for (;;)
+  {
+    if (!xfer_recv(x, &f, XFER_TIMEOUT_MS, &pending))
+    {
+      if (++retries > XFER_MAX_RETRIES)
+        return false;
+      xfer_send(x, XFER_NAK, expected, NULL, 0);
+      continue;
+    }
+
+    switch (f.type)
+    {
+      case XFER_DATA:
+        if (f.offset == expected && expected + f.len <= *total)
+        {
+          if (write(fd, f.payload, f.len) != f.len)
+            return false;
+          crc = esp_rom_crc32_le(crc, f.payload, f.len);
+          expected += f.len;
+          xfer_send(x, XFER_ACK, expected, NULL, 0);
+          nak_sent = false;
+          retries = 0;
+        }
+        else if (f.offset > expected)
+        {
+          /* A frame was lost: ask once, the sender rewinds and everything after it is discarded meanwhile */
+          s_xfer_stats.dropped++;
+          if (!nak_sent)
+            xfer_send(x, XFER_NAK, expected, NULL, 0);
+          nak_sent = true;
+        }
+        else if (f.offset < expected)
+        {
+          /* Retransmission after a lost ACK */
+          xfer_send(x, XFER_ACK, expected, NULL, 0);
+        }
+        break;
+
+      case XFER_START:
+        xfer_send(x, XFER_ACK, expected, &window, 1);
+        break;
+
+      case XFER_END:
+        if (expected != *total)
+        {
+          xfer_send(x, XFER_NAK, expected, NULL, 0);
+          break;
+        }
+        if (f.len < 4 || get_le32(f.payload) != crc)
+        {
+          /* Corrupted despite the frame CRCs: do not let the next attempt resume from it */
+          ftruncate(fd, 0);
+          return false;
+        }
+        xfer_send(x, XFER_ACK, expected, NULL, 0);
+        return true;
+
+      case XFER_ABORT:
+        return false;
+
+      default:
+        break;
+    }
+  }
+}
+
+/** 'rx' command receives a file from the host */
+
+static int xfer_rx(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&xfer_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, xfer_args.end, argv[0]);
+    return 1;
+  }
+
+  const char *mount = cli_get_storage(NULL);
+  const char *name = xfer_args.path->sval[0];
+  char path[XFER_PATH_MAX], part_path[XFER_PATH_MAX];
+  if (mount == NULL || snprintf(path, sizeof(path), "%s/%s", mount, name) >= (int)sizeof(path) ||
+      snprintf(part_path, sizeof(part_path), "%s" XFER_PART_SUFFIX, path) >= (int)sizeof(part_path))
+  {
+    printf("ERROR: Invalid path or no filesystem mounted\n");
+    return 1;
+  }
+
+  /* Data goes to <path>.part, whose size is the resume point of an interrupted transfer */
+  int fd = open(part_path, O_RDWR | O_CREAT, 0666);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0)
+  {
+    printf("ERROR: Cannot open '%s': %s\n", part_path, strerror(errno));
+    if (fd >= 0)
+      close(fd);
+    return 1;
+  }
+
+  xfer_t *x = calloc(1, sizeof(xfer_t));
+  uint8_t *block = malloc(XFER_BLOCK_SIZE);
+  uint32_t total = 0;
+  bool ok = false;
+  if (x && block)
+  {
+    printf("XFER RX %ld\n", (long)st.st_size);
+    cli_set_binary_mode(true);
+    ok = xfer_recv_file(x, fd, (uint32_t)st.st_size, &total, block);
+    if (!ok)
+      xfer_send(x, XFER_ABORT, 0, NULL, 0);
+    cli_set_binary_mode(false);
+  }
+  free(block);
+  free(x);
+  close(fd);
+
+  if (ok)
+  {
+    unlink(path);
+    ok = (rename(part_path, path) == 0);
+  }
+
+  printf("\n%s\n", ok ? "XFER OK" : "XFER FAILED");
+  if (ok)
+    printf("Received %" PRIu32 " bytes into %s\n", total, path);
+  return ok ? 0 : 1;
+}
+
+static void xfer_metric_bytes(cli_metrics_writer_t *w, void *arg)
+{
+  cli_metrics_sample(w, "direction=\"tx\"", s_xfer_stats.bytes[0]);
+  cli_metrics_sample(w, "direction=\"rx\"", s_xfer_stats.bytes[1]);
+}
+
+static void xfer_metric_dropped(cli_metrics_writer_t *w, void *arg)
+{
+  cli_metrics_sample(w, NULL, s_xfer_stats.dropped);
+}
+
+static void xfer_metric_retransmits(cli_metrics_writer_t *w, void *arg)
+{
+  cli_metrics_sample(w, NULL, s_xfer_stats.retransmits);
+}
+
+static void build_xfer_args(void)
+{
+  /* Shared by tx and rx: built by whichever is used first */
+  if (xfer_args.end != NULL)
+    return;
+  xfer_args.path = arg_str1(NULL, NULL, "<file>", HELP_XFER_FILE);
+  xfer_args.end = arg_end(1);
+}
+
+void register_fs_xfer(void)
+{
+  static const cli_lazy_command_t tx_cmd = {.command = "tx",
+                                            .help = HELP_TX,
+                                            .hint = NULL,
+                                            .func = &xfer_tx,
+                                            .argtable = &xfer_args,
+                                            .argtable_len = CLI_ARGTABLE_LEN(xfer_args),
+                                            .build = build_xfer_args};
+
+  static const cli_lazy_command_t rx_cmd = {.command = "rx",
+                                            .help = HELP_RX,
+                                            .hint = NULL,
+                                            .func = &xfer_rx,
+                                            .argtable = &xfer_args,
+                                            .argtable_len = CLI_ARGTABLE_LEN(xfer_args),
+                                            .build = build_xfer_args};
+
+  ESP_ERROR_CHECK(cli_register_lazy_command(&tx_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&rx_cmd));
+
+  cli_metrics_register("xfer_bytes", CLI_METRIC_COUNTER, "rx/tx frame bytes on the console", xfer_metric_bytes, NULL);
+  cli_metrics_register(
+    "xfer_frames_dropped", CLI_METRIC_COUNTER, "rx/tx frames discarded (CRC, order)", xfer_metric_dropped, NULL);
+  cli_metrics_register(
+    "xfer_retransmits", CLI_METRIC_COUNTER, "tx rewinds after a NAK or timeout", xfer_metric_retransmits, NULL);
+}
@@ -0,0 +1,663 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Console example — GPIO bus commands working on pin masks
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include "cmd_gpio.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "argtable3/argtable3.h"
+#include "cli-api.h"
+#include "driver/gpio.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "help_text.h"
+#include "nvs.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+
+static const char *TAG = "cmd_gpio";
+
+/* Pins 0-31 live in the first set of GPIO registers, 32 and up in the second */
+#if SOC_GPIO_PIN_COUNT > 32
+#define GPIO_BANKS 2
+#else
+#define GPIO_BANKS 1
+#endif
+
+typedef struct
+{
+  uint32_t out;    /**< Output latch */
+  uint32_t w1ts;   /**< Write 1 to set output bits */
+  uint32_t w1tc;   /**< Write 1 to clear output bits */
+  uint32_t enable; /**< Output enable */
+  uint32_t in;     /**< Input level */
+} gpio_bank_regs_t;
+
+static const gpio_bank_regs_t s_banks[GPIO_BANKS] = {
+  {GPIO_OUT_REG, GPIO_OUT_W1TS_REG, GPIO_OUT_W1TC_REG, GPIO_ENABLE_REG, GPIO_IN_REG},
+#if GPIO_BANKS > 1
+  {GPIO_OUT1_REG, GPIO_OUT1_W1TS_REG, GPIO_OUT1_W1TC_REG, GPIO_ENABLE1_REG, GPIO_IN1_REG},
+#endif
+};
+
+static portMUX_TYPE s_gpio_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const struct
+{
+  const char *name;
+  gpio_mode_t mode;
+} s_modes[] = {
+  {"in", GPIO_MODE_INPUT},
+  {"out", GPIO_MODE_OUTPUT},
+  {"od", GPIO_MODE_OUTPUT_OD},
+  {"inout", GPIO_MODE_INPUT_OUTPUT},
+  {"inout_od", GPIO_MODE_INPUT_OUTPUT_OD},
+};
+
+static const char *const s_pulls[] = {
+  [GPIO_PULLUP_ONLY] = "up",
+  [GPIO_PULLDOWN_ONLY] = "down",
+  [GPIO_PULLUP_PULLDOWN] = "both",
+  [GPIO_FLOATING] = "none",
+};
+
+/* ========================================================================== */
+/*                              PIN STATE                                     */
+/* ========================================================================== */
+
+typedef struct
+{
+  uint8_t mode;    /**< gpio_mode_t */
+  uint8_t pull;    /**< gpio_pull_mode_t */
+  uint8_t level;   /**< Last level written (outputs) */
+  bool configured; /**< Set by a command since boot, or by a restored profile */
+} gpio_pin_state_t;
+
+static gpio_pin_state_t s_pins[SOC_GPIO_PIN_COUNT];
+
+/* ========================================================================== */
+/*                              PROFILES                                      */
+/* ========================================================================== */
+
+#define GPIO_PROFILE_NAMESPACE "gpio_prof"
+#define GPIO_PROFILE_VERSION   1
+
+/**
+ * @brief One configured pin in a saved profile, 2 bytes
+ *
+ * A profile blob is one version byte followed by one entry per configured pin.
+ */
+typedef struct __attribute__((packed))
+{
+  uint16_t pin : 6;      /**< GPIO number */
+  uint16_t mode : 3;     /**< gpio_mode_t (input/output/open-drain bits) */
+  uint16_t pull : 2;     /**< gpio_pull_mode_t */
+  uint16_t level : 1;    /**< Output level */
+  uint16_t reserved : 4; /**< Zero */
+} gpio_profile_entry_t;
+
+_Static_assert(sizeof(gpio_profile_entry_t) == 2, "profile entries are stored packed");
+_Static_assert(SOC_GPIO_PIN_COUNT <= 64, "pin numbers are stored in 6 bits");
+
+static struct
+{
+  struct arg_str *mask;
+  struct arg_str *value;
+  struct arg_end *end;
+} write_args;
+
+static struct
+{
+  struct arg_str *mask;
+  struct arg_end *end;
+} read_args;
+
+static struct
+{
+  struct arg_str *mask;
+  struct arg_str *mode;
+  struct arg_str *pull;
+  struct arg_str *value;
+  struct arg_end *end;
+} config_args;
+
+static struct
+{
+  struct arg_str *action;
+  struct arg_str *name;
+  struct arg_end *end;
+} profile_args;
+
+/** @brief Parse a hex number, with or without the 0x prefix */
+static bool parse_hex(const char *str, uint64_t *out)
+{
+  char *end;
+  *out = strtoull(str, &end, 16);
+  if (end == str || *end != '\0')
+  {
+    printf("ERROR: '%s' is not a hex number\n", str);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Parse a hex pin mask ("0xff0", "ff0") and check it only names pins present on this chip
+ *
+ * @param valid SOC_GPIO_VALID_GPIO_MASK or SOC_GPIO_VALID_OUTPUT_GPIO_MASK
+ */
+static bool parse_mask(const char *str, uint64_t valid, uint64_t *out)
+{
+  if (!parse_hex(str, out))
+    return false;
+  if (*out == 0 || (*out & ~valid) != 0)
+  {
+    printf("ERROR: Mask 0x%" PRIx64 " is empty or includes pins not usable here (valid: 0x%" PRIx64 ")\n", *out, valid);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Drive the masked output pins to value, one register write per bank
+ *
+ * When all masked pins go the same way, a single W1TS or W1TC write does it atomically. A mix of rising and falling
+ * pins is written to the output latch in one store instead, so the bus never shows an intermediate value; the
+ * read-modify-write is done in a critical section so other tasks on this core cannot interleave.
+ */
+static void gpio_bus_write(uint64_t mask, uint64_t value)
+{
+  for (int b = 0; b < GPIO_BANKS; b++)
+  {
+    uint32_t m = (uint32_t)(mask >> (32 * b));
+    uint32_t set = (uint32_t)(value >> (32 * b)) & m;
+    uint32_t clr = ~(uint32_t)(value >> (32 * b)) & m;
+
+    if (m == 0)
+      continue;
+    if (clr == 0)
+    {
+      REG_WRITE(s_banks[b].w1ts, set);
+    }
+    else if (set == 0)
+    {
+      REG_WRITE(s_banks[b].w1tc, clr);
+    }
+    else
+    {
+      portENTER_CRITICAL(&s_gpio_lock);
+      REG_WRITE(s_banks[b].out, (REG_READ(s_banks[b].out) & ~m) | set);
+      portEXIT_CRITICAL(&s_gpio_lock);
+    }
+  }
+}
+
+/** @brief Read the input levels (or the output enables) of every bank into one pin mask */
+static uint64_t gpio_bus_read(bool output_enable)
+{
+  uint64_t bits = 0;
+  for (int b = 0; b < GPIO_BANKS; b++)
+    bits |= (uint64_t)REG_READ(output_enable ? s_banks[b].enable : s_banks[b].in) << (32 * b);
+  return bits;
+}
+
+/** @brief Print the masked pins as "pin=level" pairs */
+static void print_pins(uint64_t mask, uint64_t levels)
+{
+  for (int pin = 0; pin < SOC_GPIO_PIN_COUNT; pin++)
+  {
+    if (mask & (1ULL << pin))
+      printf(" %d=%d", pin, (int)((levels >> pin) & 1));
+  }
+  printf("\n");
+}
+
+void gpio_state_record(int pin, gpio_mode_t mode, gpio_pull_mode_t pull, int level)
+{
+  if (pin < 0 || pin >= SOC_GPIO_PIN_COUNT)
+    return;
+  s_pins[pin] = (gpio_pin_state_t){.mode = mode, .pull = pull, .level = level ? 1 : 0, .configured = true};
+}
+
+bool gpio_state_get(int pin, gpio_mode_t *mode, gpio_pull_mode_t *pull, int *level)
+{
+  if (pin < 0 || pin >= SOC_GPIO_PIN_COUNT || !s_pins[pin].configured)
+    return false;
+  *mode = s_pins[pin].mode;
+  *pull = s_pins[pin].pull;
+  *level = s_pins[pin].level;
+  return true;
+}
+
+/** 'gpio_write' command drives several output pins at once */
+
+static int gpio_write(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&write_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, write_args.end, argv[0]);
+    return 1;
+  }
+
+  uint64_t mask, value;
+  if (!parse_mask(write_args.mask->sval[0], SOC_GPIO_VALID_OUTPUT_GPIO_MASK, &mask))
+    return 1;
+
+  if (!parse_hex(write_args.value->sval[0], &value))
+    return 1;
+  if (value & ~mask)
+    printf("WARNING: Value bits outside the mask are ignored\n");
+
+  uint64_t not_output = mask & ~gpio_bus_read(true);
+  if (not_output)
+    printf("WARNING: Output not enabled on 0x%" PRIx64 " (see gpio_config), only the latch changes\n", not_output);
+
+  gpio_bus_write(mask, value);
+  for (int pin = 0; pin < SOC_GPIO_PIN_COUNT; pin++)
+  {
+    if ((mask & (1ULL << pin)) && s_pins[pin].configured)
+      s_pins[pin].level = (value >> pin) & 1;
+  }
+
+  printf("OUT 0x%" PRIx64 ":", mask);
+  print_pins(mask, value);
+  return 0;
+}
+
+/** 'gpio_read' command samples several input pins at once */
+
+static int gpio_read(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&read_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, read_args.end, argv[0]);
+    return 1;
+  }
+
+  uint64_t mask = SOC_GPIO_VALID_GPIO_MASK;
+  if (read_args.mask->count > 0 && !parse_mask(read_args.mask->sval[0], SOC_GPIO_VALID_GPIO_MASK, &mask))
+    return 1;
+
+  /* One snapshot of the input registers, so all pins are sampled at (almost) the same instant */
+  uint64_t levels = gpio_bus_read(false) & mask;
+
+  printf("IN 0x%" PRIx64 " = 0x%" PRIx64 "\n", mask, levels);
+  if (read_args.mask->count > 0)
+  {
+    printf("  ");
+    print_pins(mask, levels);
+  }
+  return 0;
+}
+
+/**
+ * @brief Configure every pin of mask the same way and record it
+ *
+ * For outputs the latch is preloaded with levels first, so the pins come up at their initial level instead of the
+ * previous one.
+ */
+static esp_err_t gpio_apply(uint64_t mask, gpio_mode_t mode, gpio_pull_mode_t pull, uint64_t levels)
+{
+  bool output = (mode & GPIO_MODE_DEF_OUTPUT) != 0;
+  if (output)
+    gpio_bus_write(mask, levels);
+
+  const gpio_config_t io_conf = {
+    .pin_bit_mask = mask,
+    .mode = mode,
+    .pull_up_en = (pull == GPIO_PULLUP_ONLY || pull == GPIO_PULLUP_PULLDOWN) ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
+    .pull_down_en =
+      (pull == GPIO_PULLDOWN_ONLY || pull == GPIO_PULLUP_PULLDOWN) ? GPIO_PULLDOWN_ENABLE : GPIO_PULLDOWN_DISABLE,
+    .intr_type = GPIO_INTR_DISABLE,
+  };
+  esp_err_t err = gpio_config(&io_conf);
+  if (err != ESP_OK)
+    return err;
+
+  for (int pin = 0; pin < SOC_GPIO_PIN_COUNT; pin++)
+  {
+    if (mask & (1ULL << pin))
+      gpio_state_record(pin, mode, pull, output ? (int)((levels >> pin) & 1) : 0);
+  }
+  return ESP_OK;
+}
+
+/** 'gpio_config' command applies one configuration to every pin of a mask */
+
+static int gpio_config_mask(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&config_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, config_args.end, argv[0]);
+    return 1;
+  }
+
+  const char *mode_str = config_args.mode->sval[0];
+  size_t m = 0;
+  while (m < sizeof(s_modes) / sizeof(s_modes[0]) && strcmp(mode_str, s_modes[m].name) != 0) m++;
+  if (m == sizeof(s_modes) / sizeof(s_modes[0]))
+  {
+    printf("ERROR: Mode '%s' invalid. Use: in, out, od, inout, inout_od\n", mode_str);
+    return 1;
+  }
+  gpio_mode_t mode = s_modes[m].mode;
+
+  const char *pull_str = (config_args.pull->count > 0) ? config_args.pull->sval[0] : "none";
+  int pull = 0;
+  while (pull < GPIO_FLOATING && strcmp(pull_str, s_pulls[pull]) != 0) pull++;
+  if (strcmp(pull_str, s_pulls[pull]) != 0)
+  {
+    printf("ERROR: Pull '%s' invalid. Use: up, down, both, none\n", pull_str);
+    return 1;
+  }
+
+  uint64_t mask;
+  uint64_t valid = (mode & GPIO_MODE_DEF_OUTPUT) ? SOC_GPIO_VALID_OUTPUT_GPIO_MASK : SOC_GPIO_VALID_GPIO_MASK;
+  if (!parse_mask(config_args.mask->sval[0], valid, &mask))
+    return 1;
+
+  uint64_t value = 0;
+  if (config_args.value->count > 0 && !parse_hex(config_args.value->sval[0], &value))
+    return 1;
+
+  esp_err_t err = gpio_apply(mask, mode, (gpio_pull_mode_t)pull, value);
+  if (err != ESP_OK)
+  {
+    printf("ERROR: gpio_config failed: %s\n", esp_err_to_name(err));
+    return 1;
+  }
+
+  printf("Configured 0x%" PRIx64 " as %s, pull %s\n", mask, mode_str, pull_str);
+  return 0;
+}
+
+/**
+ * @brief Apply a profile in one pass over its entries
+ *
+ * Pins are grouped by (mode, pull) so each group takes one gpio_config() call, with its output levels preloaded in
+ * one latch write per bank.
+ */
+static esp_err_t gpio_profile_apply(const gpio_profile_entry_t *entries, size_t count)
+{
+  uint64_t groups[8][4] = {0}; /* [mode][pull] -> pin mask */
+  uint64_t levels = 0;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    const gpio_profile_entry_t *e = &entries[i];
+    if (e->pin >= SOC_GPIO_PIN_COUNT)
+      return ESP_ERR_INVALID_ARG;
+    groups[e->mode][e->pull] |= 1ULL << e->pin;
+    levels |= (uint64_t)e->level << e->pin;
+  }
+
+  for (int mode = 0; mode < 8; mode++)
+  {
+    for (int pull = 0; pull < 4; pull++)
+    {
+      if (groups[mode][pull] == 0)
+        continue;
+      esp_err_t err = gpio_apply(groups[mode][pull], (gpio_mode_t)mode, (gpio_pull_mode_t)pull, levels);
+      if (err != ESP_OK)
+        return err;
+    }
+  }
+  return ESP_OK;
+}
+
+esp_err_t gpio_profile_save(const char *name)
+{
+  gpio_profile_entry_t entries[SOC_GPIO_PIN_COUNT];
+  size_t count = 0;
+  for (int pin = 0; pin < SOC_GPIO_PIN_COUNT; pin++)
+  {
+    if (!s_pins[pin].configured)
+      continue;
+    entries[count++] = (gpio_profile_entry_t){
+      .pin = pin,
+      .mode = s_pins[pin].mode,
+      .pull = s_pins[pin].pull,
+      .level = s_pins[pin].level,
+    };
+  }
+  if (count == 0)
+    return ESP_ERR_INVALID_STATE;
+
+  uint8_t blob[1 + sizeof(entries)];
+  blob[0] = GPIO_PROFILE_VERSION;
+  memcpy(&blob[1], entries, count * sizeof(gpio_profile_entry_t));
+
+  nvs_handle_t nvs;
+  esp_err_t err = nvs_open(GPIO_PROFILE_NAMESPACE, NVS_READWRITE, &nvs);
+  if (err != ESP_OK)
+    return err;
+  err = nvs_set_blob(nvs, name, blob, 1 + count * sizeof(gpio_profile_entry_t));
+  if (err == ESP_OK)
+    err = nvs_commit(nvs);
+  nvs_close(nvs);
+  return err;
+}
+
+esp_err_t gpio_profile_load(const char *name)
+{
+  nvs_handle_t nvs;
+  esp_err_t err = nvs_open(GPIO_PROFILE_NAMESPACE, NVS_READONLY, &nvs);
+  if (err != ESP_OK)
+    return err;
+
+  uint8_t blob[1 + SOC_GPIO_PIN_COUNT * sizeof(gpio_profile_entry_t)];
+  size_t len = sizeof(blob);
+  err = nvs_get_blob(nvs, name, blob, &len);
+  nvs_close(nvs);
+  if (err != ESP_OK)
+    return err;
+  if (len < 1 || blob[0] != GPIO_PROFILE_VERSION || (len - 1) % sizeof(gpio_profile_entry_t) != 0)
+    return ESP_ERR_INVALID_VERSION;
+
+  gpio_profile_entry_t entries[SOC_GPIO_PIN_COUNT];
+  size_t count = (len - 1) / sizeof(gpio_profile_entry_t);
+  memcpy(entries, &blob[1], len - 1);
+  return gpio_profile_apply(entries, count);
+}
+
+esp_err_t gpio_profile_restore_boot(void)
+{
+  esp_err_t err = gpio_profile_load(GPIO_PROFILE_BOOT);
+  if (err == ESP_ERR_NVS_NOT_FOUND)
+    return ESP_OK;
+  if (err == ESP_OK)
+    ESP_LOGI(TAG, "GPIO profile '" GPIO_PROFILE_BOOT "' restored");
+  else
+    ESP_LOGW(TAG, "GPIO profile '" GPIO_PROFILE_BOOT "' not restored: %s", esp_err_to_name(err));
+  return err;
+}
+
+/** @brief Print saved profiles with their pin count */
+static int gpio_profile_list(void)
+{
+  nvs_iterator_t it = NULL;
+  esp_err_t err = nvs_entry_find(NVS_DEFAULT_PART_NAME, GPIO_PROFILE_NAMESPACE, NVS_TYPE_BLOB, &it);
+  if (err == ESP_ERR_NVS_NOT_FOUND)
+  {
+    printf("No saved profiles\n");
+    return 0;
+  }
+
+  nvs_handle_t nvs;
+  if (err != ESP_OK || nvs_open(GPIO_PROFILE_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK)
+  {
+    nvs_release_iterator(it);
+    printf("ERROR: Cannot read profiles\n");
+    return 1;
+  }
+
+  while (err == ESP_OK)
+  {
+    nvs_entry_info_t info;
+    nvs_entry_info(it, &info);
+    size_t len = 0;
+    nvs_get_blob(nvs, info.key, NULL, &len);
+    printf("  %-15s %u pin(s)%s\n",
+           info.key,
+           (unsigned)((len > 0) ? (len - 1) / sizeof(gpio_profile_entry_t) : 0),
+           strcmp(info.key, GPIO_PROFILE_BOOT) == 0 ? "  (restored at boot)" : "");
+    err = nvs_entry_next(&it);
+  }
+
+  nvs_release_iterator(it);
+  nvs_close(nvs);
+  return 0;
+}
+
+/** 'gpio_profile' command saves, loads, lists and removes pin configuration sets */
+
+static int gpio_profile(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&profile_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, profile_args.end, argv[0]);
+    return 1;
+  }
+
+  const char *action = profile_args.action->sval[0];
+  if (strcmp(action, "list") == 0)
+    return gpio_profile_list();
+
+  const char *name = (profile_args.name->count > 0) ? profile_args.name->sval[0] : GPIO_PROFILE_BOOT;
+  if (strlen(name) >= NVS_KEY_NAME_MAX_SIZE)
+  {
+    printf("ERROR: Profile name longer than %d characters\n", NVS_KEY_NAME_MAX_SIZE - 1);
+    return 1;
+  }
+
+  esp_err_t err;
+  if (strcmp(action, "save") == 0)
+  {
+    err = gpio_profile_save(name);
+    if (err == ESP_ERR_INVALID_STATE)
+    {
+      printf("ERROR: No pins configured yet\n");
+      return 1;
+    }
+  }
+  else if (strcmp(action, "load") == 0)
+  {
+    err = gpio_profile_load(name);
+  }
+  else if (strcmp(action, "rm") == 0)
+  {
+    nvs_handle_t nvs;
+    err = nvs_open(GPIO_PROFILE_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK)
+    {
+      err = nvs_erase_key(nvs, name);
+      if (err == ESP_OK)
+        err = nvs_commit(nvs);
+      nvs_close(nvs);
+    }
+  }
+  else
+  {
+    printf("ERROR: Action '%s' invalid. Use: save, load, list, rm\n", action);
+    return 1;
+  }
+
+  if (err == ESP_ERR_NVS_NOT_FOUND)
+  {
+    printf("ERROR: No profile '%s'\n", name);
+    return 1;
+  }
+  if (err != ESP_OK)
+  {
+    printf("ERROR: %s\n", esp_err_to_name(err));
+    return 1;
+  }
+
+  printf("Profile '%s': %s OK\n", name, action);
+  return 0;
+}
+
+/* Argument tables are built on first use (cli_register_lazy_command()) */
+
+static void build_write_args(void)
+{
+  write_args.mask = arg_str1("m", "mask", "<hex>", HELP_GPIO_WRITE_MASK);
+  write_args.value = arg_str1("v", "value", "<hex>", HELP_GPIO_WRITE_VALUE);
+  write_args.end = arg_end(2);
+}
+
+static void build_read_args(void)
+{
+  read_args.mask = arg_str0("m", "mask", "<hex>", HELP_GPIO_READ_MASK);
+  read_args.end = arg_end(1);
+}
+
+static void build_config_args(void)
+{
+  config_args.mask = arg_str1("m", "mask", "<hex>", HELP_GPIO_CONFIG_MASK);
+  config_args.mode = arg_str1(NULL, "mode", "<in|out|od|inout|inout_od>", HELP_GPIO_CONFIG_MODE);
+  config_args.pull = arg_str0(NULL, "pull", "<up|down|both|none>", HELP_GPIO_CONFIG_PULL);
+  config_args.value = arg_str0("v", "value", "<hex>", HELP_GPIO_CONFIG_VALUE);
+  config_args.end = arg_end(4);
+}
+
+static void build_profile_args(void)
+{
+  profile_args.action = arg_str1(NULL, NULL, "<save|load|list|rm>", HELP_GPIO_PROFILE_ACTION);
+  profile_args.name = arg_str0(NULL, NULL, "<name>", HELP_GPIO_PROFILE_NAME);
+  profile_args.end = arg_end(2);
+}
+
+void register_gpio(void)
+{
+  static const cli_lazy_command_t cmds[] = {
+    {.command = "gpio_write",
+     .help = HELP_GPIO_WRITE,
+     .func = &gpio_write,
+     .argtable = &write_args,
+     .argtable_len = CLI_ARGTABLE_LEN(write_args),
+     .build = build_write_args},
+    {.command = "gpio_read",
+     .help = HELP_GPIO_READ,
+     .func = &gpio_read,
+     .argtable = &read_args,
+     .argtable_len = CLI_ARGTABLE_LEN(read_args),
+     .build = build_read_args},
+    {.command = "gpio_config",
+     .help = HELP_GPIO_CONFIG,
+     .func = &gpio_config_mask,
+     .argtable = &config_args,
+     .argtable_len = CLI_ARGTABLE_LEN(config_args),
+     .build = build_config_args},
+    {.command = "gpio_profile",
+     .help = HELP_GPIO_PROFILE,
+     .func = &gpio_profile,
+     .argtable = &profile_args,
+     .argtable_len = CLI_ARGTABLE_LEN(profile_args),
+     .build = build_profile_args},
+  };
+
+  for (size_t i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++) ESP_ERROR_CHECK(cli_register_lazy_command(&cmds[i]));
+
+  register_gpio_capture();
+}
@@ -0,0 +1,34 @@
+/* Console example — declarations of command registration functions.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include "cmd_gpio_capture.h"
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+// Name of the profile restored by gpio_profile_restore_boot()
+#define GPIO_PROFILE_BOOT "boot"
+
+// Register GPIO bus commands working on pin masks: "gpio_write", "gpio_read", "gpio_config", "gpio_profile"
+void register_gpio(void);
+
+// Record a pin configured outside cmd_gpio (e.g. by the "gpio" command) so that profiles include it
+void gpio_state_record(int pin, gpio_mode_t mode, gpio_pull_mode_t pull, int level);
+
+// Last recorded configuration of a pin, false if it was not configured since boot
+bool gpio_state_get(int pin, gpio_mode_t *mode, gpio_pull_mode_t *pull, int *level);
+
+// Save all recorded pins as one NVS blob (ESP_ERR_INVALID_STATE if none), and apply a saved profile
+esp_err_t gpio_profile_save(const char *name);
+esp_err_t gpio_profile_load(const char *name);
+
+// Apply the "boot" profile if one was saved; call once NVS is initialized, before the console starts
+esp_err_t gpio_profile_restore_boot(void);
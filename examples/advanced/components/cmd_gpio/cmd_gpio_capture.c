@@ -0,0 +1,439 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Console example — GPIO logic capture
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "argtable3/argtable3.h"
+#include "cli-api.h"
+#include "cmd_gpio_capture.h"
+#include "esp_attr.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "help_text.h"
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_sys.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+#endif
+
+static const char *TAG = "cmd_gpio_capture";
+
+/* Longest capture: interrupts are only masked in short slices, but the console task never yields in between */
+#define CAPTURE_MAX_MS 2000
+
+/* Longest stretch with interrupts masked; the slot waits between slices run with them enabled */
+#define CAPTURE_SLICE_US 1000
+
+/* Below this many CPU cycles per sample the loop cannot keep up (register read + store + pacing) */
+#define CAPTURE_MIN_PERIOD_CYCLES 24
+
+/**
+ * @brief One capture: the sampled register slice and the sample buffer
+ *
+ * Samples store (GPIO_IN >> shift) & bits, in 1, 2 or 4 bytes depending on the span of the mask.
+ */
+typedef struct
+{
+  uint32_t reg;      /**< GPIO_IN_REG or GPIO_IN1_REG (bank 0 or 1 on the linux target) */
+  uint32_t bits;     /**< Mask after the shift */
+  uint8_t shift;     /**< Lowest captured bit of the register */
+  uint8_t first_pin; /**< GPIO number of bit 0 of a sample */
+  uint8_t width;     /**< Bytes per sample */
+  void *buf;         /**< samples * width bytes */
+  size_t samples;    /**< Number of samples */
+  uint32_t rate;     /**< Requested sample rate in Hz */
+  uint32_t period;   /**< CPU cycles between samples */
+  uint32_t late;     /**< Samples taken more than one period after their slot */
+  uint32_t elapsed;  /**< CPU cycles from first to last sample */
+} capture_t;
+
+static portMUX_TYPE s_capture_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static struct
+{
+  struct arg_str *mask;
+  struct arg_int *rate;
+  struct arg_int *samples;
+  struct arg_str *format;
+  struct arg_end *end;
+} capture_args;
+
+/* ========================================================================== */
+/*                              SAMPLE SOURCE                                 */
+/* ========================================================================== */
+
+/* On chips the sampling loop reads the input register, paced by the CPU cycle counter. The linux target has no GPIO:
+ * sample i is the level the application's gpio_capture_sim_read() scripts for its slot time, the cycle counter is the
+ * monotonic clock at a nominal CAPTURE_SIM_CPU_HZ, and the buffer comes from the plain heap. */
+#if CONFIG_IDF_TARGET_LINUX
+
+#define CAPTURE_SIM_CPU_HZ 1000000000 /**< One "cycle" per ns */
+#define CAPTURE_PIN_COUNT  48         /**< Two banks, so both register paths are exercised */
+#define CAPTURE_VALID_MASK ((1ULL << CAPTURE_PIN_COUNT) - 1)
+#define CAPTURE_IN_REG     0
+#define CAPTURE_IN1_REG    1
+
+static inline uint32_t capture_cpu_hz(void)
+{
+  return CAPTURE_SIM_CPU_HZ;
+}
+
+static inline uint32_t capture_cycles(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+static inline uint32_t capture_read(const capture_t *c, size_t i)
+{
+  return gpio_capture_sim_read(c->reg, (uint64_t)i * 1000000000u / c->rate);
+}
+
+static inline void *capture_alloc(size_t size)
+{
+  return malloc(size);
+}
+
+static inline void capture_free(void *buf)
+{
+  free(buf);
+}
+
+#else
+
+#define CAPTURE_PIN_COUNT  SOC_GPIO_PIN_COUNT
+#define CAPTURE_VALID_MASK SOC_GPIO_VALID_GPIO_MASK
+#define CAPTURE_IN_REG     GPIO_IN_REG
+#if SOC_GPIO_PIN_COUNT > 32
+#define CAPTURE_IN1_REG GPIO_IN1_REG
+#endif
+
+static inline uint32_t capture_cpu_hz(void)
+{
+  return esp_rom_get_cpu_ticks_per_us() * 1000000;
+}
+
+FORCE_INLINE_ATTR uint32_t capture_cycles(void)
+{
+  return esp_cpu_get_cycle_count();
+}
+
+FORCE_INLINE_ATTR uint32_t capture_read(const capture_t *c, size_t i)
+{
+  return REG_READ(c->reg);
+}
+
+/* PSRAM first, it is the larger pool */
+static inline void *capture_alloc(size_t size)
+{
+  return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_8BIT);
+}
+
+static inline void capture_free(void *buf)
+{
+  heap_caps_free(buf);
+}
+
+#endif
+
+/* ========================================================================== */
+/*                                CAPTURE                                     */
+/* ========================================================================== */
+
+static inline uint32_t capture_get(const capture_t *c, size_t i)
+{
+  switch (c->width)
+  {
+  case 1:
+    return ((const uint8_t *)c->buf)[i];
+  case 2:
+    return ((const uint16_t *)c->buf)[i];
+  default:
+    return ((const uint32_t *)c->buf)[i];
+  }
+}
+
+/**
+ * @brief Sample the input register on a CPU-cycle grid
+ *
+ * Samples are taken in slices that span at most CAPTURE_SLICE_US. The wait for the first slot of a slice runs with
+ * interrupts enabled; the rest of the slice is busy-waited on the cycle counter with them masked, so the sampling
+ * jitter is a few cycles. At rates below 1 / CAPTURE_SLICE_US a slice is one sample and interrupts are only masked
+ * around its read. A sample delayed by an interrupt between slices is counted as late, and the following ones go back
+ * onto the grid.
+ */
+static void IRAM_ATTR capture_run(capture_t *c, uint32_t cpu_hz)
+{
+  size_t slice = (uint64_t)cpu_hz * CAPTURE_SLICE_US / 1000000 / c->period;
+  if (slice == 0)
+    slice = 1;
+  uint32_t next = capture_cycles() + c->period;
+  uint32_t start = next;
+
+  for (size_t i = 0; i < c->samples;)
+  {
+    size_t end = (c->samples - i > slice) ? i + slice : c->samples;
+
+    while ((int32_t)(capture_cycles() - next) < 0)
+    {
+    }
+    portENTER_CRITICAL(&s_capture_lock);
+    for (; i < end; i++)
+    {
+      uint32_t now;
+      while ((int32_t)((now = capture_cycles()) - next) < 0)
+      {
+      }
+      uint32_t v = (capture_read(c, i) >> c->shift) & c->bits;
+
+      if (c->width == 1)
+        ((uint8_t *)c->buf)[i] = v;
+      else if (c->width == 2)
+        ((uint16_t *)c->buf)[i] = v;
+      else
+        ((uint32_t *)c->buf)[i] = v;
+
+      if (now - next >= c->period)
+        c->late++;
+      next += c->period;
+    }
+    portEXIT_CRITICAL(&s_capture_lock);
+  }
+
+  c->elapsed = next - c->period - start;
+}
+
+/** @brief Bytes of a LEB128-encoded run length */
+static size_t leb128_size(uint32_t v)
+{
+  size_t n = 1;
+  while (v >= 0x80)
+  {
+    v >>= 7;
+    n++;
+  }
+  return n;
+}
+
+/**
+ * @brief Walk the runs of equal samples, optionally writing them
+ *
+ * Each run is the sample value (width bytes, little endian) followed by its length as LEB128.
+ *
+ * @return Size of the encoding in bytes
+ */
+static size_t capture_rle(const capture_t *c, FILE *out)
+{
+  size_t bytes = 0;
+  for (size_t i = 0; i < c->samples;)
+  {
+    uint32_t v = capture_get(c, i);
+    size_t run = 1;
+    while (i + run < c->samples && capture_get(c, i + run) == v) run++;
+    i += run;
+
+    bytes += c->width + leb128_size(run);
+    if (out == NULL)
+      continue;
+
+    uint8_t rec[4 + 5];
+    size_t n = 0;
+    for (int b = 0; b < c->width; b++) rec[n++] = (v >> (8 * b)) & 0xFF;
+    for (uint32_t r = run;; r >>= 7)
+    {
+      rec[n++] = (r & 0x7F) | (r >= 0x80 ? 0x80 : 0);
+      if (r < 0x80)
+        break;
+    }
+    fwrite(rec, 1, n, out);
+  }
+  return bytes;
+}
+
+/**
+ * @brief Write the capture as a Value Change Dump, one wire per pin, 1 ns timescale
+ */
+static void capture_vcd(const capture_t *c, FILE *out)
+{
+  fprintf(out, "$timescale 1 ns $end\n$scope module gpio $end\n");
+  for (int bit = 0; bit < 32; bit++)
+  {
+    if (c->bits & (1u << bit))
+      fprintf(out, "$var wire 1 %c gpio%d $end\n", '!' + bit, c->first_pin + bit);
+  }
+  fprintf(out, "$upscope $end\n$enddefinitions $end\n");
+
+  uint32_t prev = ~capture_get(c, 0);
+  for (size_t i = 0; i < c->samples; i++)
+  {
+    uint32_t v = capture_get(c, i);
+    uint32_t changed = (v ^ prev) & c->bits;
+    if (changed == 0)
+      continue;
+
+    fprintf(out, "#%" PRIu64 "\n", (uint64_t)i * 1000000000u / c->rate);
+    for (int bit = 0; bit < 32; bit++)
+    {
+      if (changed & (1u << bit))
+        fprintf(out, "%d%c\n", (int)((v >> bit) & 1), '!' + bit);
+    }
+    prev = v;
+  }
+  fprintf(out, "#%" PRIu64 "\n", (uint64_t)c->samples * 1000000000u / c->rate);
+}
+
+/** 'gpio_capture' command samples input pins into RAM and dumps the result */
+
+static int gpio_capture(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&capture_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, capture_args.end, argv[0]);
+    return 1;
+  }
+
+  char *end;
+  uint64_t mask = strtoull(capture_args.mask->sval[0], &end, 16);
+  if (end == capture_args.mask->sval[0] || *end != '\0' || mask == 0 || (mask & ~CAPTURE_VALID_MASK) != 0)
+  {
+    printf("ERROR: Invalid pin mask '%s'\n", capture_args.mask->sval[0]);
+    return 1;
+  }
+
+  capture_t c = {.reg = CAPTURE_IN_REG};
+#if CAPTURE_PIN_COUNT > 32
+  if ((mask >> 32) != 0)
+  {
+    if ((uint32_t)mask != 0)
+    {
+      printf("ERROR: Pins must all be in GPIO 0-31 or all in GPIO 32+ (one input register)\n");
+      return 1;
+    }
+    c.reg = CAPTURE_IN1_REG;
+    c.first_pin = 32;
+    mask >>= 32;
+  }
+#endif
+
+  uint32_t m = (uint32_t)mask;
+  c.shift = __builtin_ctz(m);
+  c.bits = m >> c.shift;
+  c.first_pin += c.shift;
+  int span = 32 - __builtin_clz(c.bits);
+  c.width = (span <= 8) ? 1 : (span <= 16) ? 2 : 4;
+
+  bool vcd = true;
+  if (capture_args.format->count > 0)
+  {
+    if (strcmp(capture_args.format->sval[0], "rle") == 0)
+      vcd = false;
+    else if (strcmp(capture_args.format->sval[0], "vcd") != 0)
+    {
+      printf("ERROR: Format must be vcd or rle\n");
+      return 1;
+    }
+  }
+
+  int rate = capture_args.rate->ival[0];
+  int samples = capture_args.samples->ival[0];
+  uint32_t cpu_hz = capture_cpu_hz();
+  if (rate <= 0 || cpu_hz / rate < CAPTURE_MIN_PERIOD_CYCLES)
+  {
+    printf("ERROR: Rate must be 1-%" PRIu32 " Hz at this CPU clock\n", cpu_hz / CAPTURE_MIN_PERIOD_CYCLES);
+    return 1;
+  }
+  if (samples <= 0 || (uint64_t)samples * 1000 / rate > CAPTURE_MAX_MS)
+  {
+    printf("ERROR: Samples must be > 0 and the capture at most %d ms\n", CAPTURE_MAX_MS);
+    return 1;
+  }
+  c.rate = rate;
+  c.samples = samples;
+  c.period = cpu_hz / rate;
+
+  /* Allocated up front so the sampling loop only stores */
+  c.buf = capture_alloc(c.samples * c.width);
+  if (c.buf == NULL)
+  {
+    printf("ERROR: No memory for %u x %u byte samples\n", (unsigned)c.samples, c.width);
+    return 1;
+  }
+
+  capture_run(&c, cpu_hz);
+
+  ESP_LOGI(TAG,
+           "%u samples in %" PRIu32 " us (%" PRIu32 " late), pins %d-%d",
+           (unsigned)c.samples,
+           c.elapsed / (cpu_hz / 1000000),
+           c.late,
+           c.first_pin,
+           c.first_pin + span - 1);
+
+  if (vcd)
+  {
+    capture_vcd(&c, stdout);
+  }
+  else
+  {
+    size_t bytes = capture_rle(&c, NULL);
+    printf("GPIOCAP RLE %" PRIu32 " %d %u %u %u\n", c.rate, c.first_pin, (unsigned)c.bits, c.width, (unsigned)bytes);
+    fflush(stdout);
+    cli_set_binary_mode(true);
+    capture_rle(&c, stdout);
+    fflush(stdout);
+    cli_set_binary_mode(false);
+    printf("\nGPIOCAP END\n");
+  }
+
+  if (c.late > 0)
+    printf("WARNING: %" PRIu32 " samples were late (interrupt slices or too high a rate)\n", c.late);
+
+  capture_free(c.buf);
+  return 0;
+}
+
+static void build_capture_args(void)
+{
+  capture_args.mask = arg_str1("m", "mask", "<hex>", HELP_GPIO_CAPTURE_MASK);
+  capture_args.rate = arg_int1("r", "rate", "<hz>", HELP_GPIO_CAPTURE_RATE);
+  capture_args.samples = arg_int1("n", "samples", "<n>", HELP_GPIO_CAPTURE_N);
+  capture_args.format = arg_str0("f", "format", "<vcd|rle>", HELP_GPIO_CAPTURE_FORMAT);
+  capture_args.end = arg_end(4);
+}
+
+void register_gpio_capture(void)
+{
+  static const cli_lazy_command_t cmd = {.command = "gpio_capture",
+                                         .help = HELP_GPIO_CAPTURE,
+                                         .hint = NULL,
+                                         .func = &gpio_capture,
+                                         .argtable = &capture_args,
+                                         .argtable_len = CLI_ARGTABLE_LEN(capture_args),
+                                         .build = build_capture_args};
+
+  ESP_ERROR_CHECK(cli_register_lazy_command(&cmd));
+}
@@ -0,0 +1,27 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Console example — GPIO logic capture declarations.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+// Register the "gpio_capture" logic capture command (called by register_gpio)
+void register_gpio_capture(void);
+
+#if CONFIG_IDF_TARGET_LINUX
+// The linux target has no input register: gpio_capture samples this instead. Provided by the application, it returns
+// the levels of GPIO 0-31 (bank 0) or GPIO 32-47 (bank 1) ns nanoseconds after the first sample.
+uint32_t gpio_capture_sim_read(uint32_t bank, uint64_t ns);
+#endif
@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Host test app of gpio_capture
+
+   cmd_gpio_capture.c runs unchanged and samples the waveform scripted below instead of the input register.
+   pytest_gpio_capture.py checks the VCD and RLE dumps of the captures run by app_main().
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "cli-api.h"
+#include "cmd_gpio_capture.h"
+#include "esp_console.h"
+#include "esp_err.h"
+
+/* ========================================================================== */
+/*                              WAVEFORM                                      */
+/* ========================================================================== */
+
+/**
+ * Bank 0: GPIO 4-7 count up every 10 us (GPIO 4 is bit 0 of the count), GPIO 8 is high from 2.5 ms to 5.5 ms.
+ * Bank 1: GPIO 33 is high from 15 us to 35 us.
+ */
+uint32_t gpio_capture_sim_read(uint32_t bank, uint64_t ns)
+{
+  if (bank == 0)
+    return (uint32_t)((ns / 10000) & 0xF) << 4 | ((ns >= 2500000 && ns < 5500000) ? (1u << 8) : 0);
+  return (ns >= 15000 && ns < 35000) ? (1u << 1) : 0;
+}
+
+/* ========================================================================== */
+/*                        CLI-API STAND-INS                                   */
+/* ========================================================================== */
+
+void cli_set_binary_mode(bool enable)
+{
+}
+
+/* Builds the argtable now, as cli-api does without lazy_argtables */
+esp_err_t cli_register_lazy_command(const cli_lazy_command_t *cmd)
+{
+  cmd->build();
+  const esp_console_cmd_t esp_cmd = {
+    .command = cmd->command,
+    .help = cmd->help,
+    .hint = cmd->hint,
+    .func = cmd->func,
+    .argtable = cmd->argtable,
+  };
+
+  return esp_console_cmd_register(&esp_cmd);
+}
+
+/* ========================================================================== */
+/*                              CAPTURES                                      */
+/* ========================================================================== */
+
+static const char *const s_captures[] = {
+  "gpio_capture -m 0xf0 -r 1000000 -n 50",
+  "gpio_capture -m 0xf0 -r 1000000 -n 50 -f rle",
+  "gpio_capture -m 0x200000000 -r 100000 -n 10 -f rle",
+  /* One sample per slice: the slot waits run with interrupts enabled */
+  "gpio_capture -m 0x100 -r 1000 -n 8",
+};
+
+void app_main(void)
+{
+  esp_console_config_t config = ESP_CONSOLE_CONFIG_DEFAULT();
+  ESP_ERROR_CHECK(esp_console_init(&config));
+  register_gpio_capture();
+
+  for (size_t i = 0; i < sizeof(s_captures) / sizeof(s_captures[0]); i++)
+  {
+    int ret = 0;
+    printf("CAPTURE %u BEGIN\n", (unsigned)i);
+    esp_err_t err = esp_console_run(s_captures[i], &ret);
+    printf("CAPTURE %u END %s %d\n", (unsigned)i, esp_err_to_name(err), ret);
+  }
+  fflush(stdout);
+}
@@ -0,0 +1,116 @@
+# SPDX-License-Identifier: Unlicense OR CC0-1.0
+"""gpio_capture (cmd_gpio_capture.c) on the linux target, sampling the waveform scripted in main/test_gpio_capture.c:
+the VCD dump, and the RLE dump decoded by tools/cli_capture.py, must both describe that waveform exactly."""
+
+import io
+import os
+import re
+import sys
+
+import pytest
+from pytest_embedded import Dut
+from pytest_embedded_idf.utils import idf_parametrize
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', '..', '..', '..', '..')
+sys.path.insert(0, os.path.join(ROOT, 'tools'))
+import cli_capture  # noqa: E402
+
+# GPIO 4-7 counting up every 10 us, sampled at 1 MHz for 50 us
+COUNTER_VCD = '''$timescale 1 ns $end
+$scope module gpio $end
+$var wire 1 ! gpio4 $end
+$var wire 1 " gpio5 $end
+$var wire 1 # gpio6 $end
+$var wire 1 $ gpio7 $end
+$upscope $end
+$enddefinitions $end
+#0
+0!
+0"
+0#
+0$
+#10000
+1!
+#20000
+0!
+1"
+#30000
+1!
+#40000
+0!
+0"
+1#
+#50000
+'''
+
+# GPIO 33 high from 15 us to 35 us, sampled at 100 kHz for 100 us
+PULSE_VCD = '''$timescale 1 ns $end
+$scope module gpio $end
+$var wire 1 ! gpio33 $end
+$upscope $end
+$enddefinitions $end
+#0
+0!
+#20000
+1!
+#40000
+0!
+#100000
+'''
+
+# GPIO 8 high from 2.5 ms to 5.5 ms, sampled at 1 kHz (one sample per slice) for 8 ms
+SLOW_VCD = '''$timescale 1 ns $end
+$scope module gpio $end
+$var wire 1 ! gpio8 $end
+$upscope $end
+$enddefinitions $end
+#0
+0!
+#3000000
+1!
+#6000000
+0!
+#8000000
+'''
+
+
+def capture(dut, n):
+    """Console output of capture n, as bytes."""
+    dut.expect_exact(f'CAPTURE {n} BEGIN')
+    return dut.expect(re.compile(rb'(.*?)CAPTURE %d END ESP_OK 0' % n, re.S)).group(1)
+
+
+def vcd_text(out):
+    """The VCD lines of a text capture, without the log line before it and a late-samples warning after it."""
+    lines = out.decode().replace('\r\n', '\n').split('\n')
+    vcd = []
+    for line in lines[lines.index('$timescale 1 ns $end'):]:
+        if not re.match(r'[$#01]', line):
+            break
+        vcd.append(line)
+    return '\n'.join(vcd) + '\n'
+
+
+def rle_to_vcd(out):
+    (rate, first_pin, bits, width), payload = cli_capture.parse_capture(out)
+    vcd = io.StringIO()
+    cli_capture.write_vcd(vcd, rate, first_pin, bits, width, payload)
+    return (rate, first_pin, bits, width), payload, vcd.getvalue()
+
+
+@pytest.mark.host_test
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_gpio_capture(dut: Dut) -> None:
+    assert vcd_text(capture(dut, 0)) == COUNTER_VCD
+
+    fields, payload, vcd = rle_to_vcd(capture(dut, 1))
+    assert fields == (1000000, 4, 0xF, 1)
+    assert payload == bytes([0, 10, 1, 10, 2, 10, 3, 10, 4, 10])
+    assert vcd == COUNTER_VCD
+
+    fields, payload, vcd = rle_to_vcd(capture(dut, 2))
+    assert fields == (100000, 33, 1, 1)
+    assert payload == bytes([0, 2, 1, 2, 0, 6])
+    assert vcd == PULSE_VCD
+
+    assert vcd_text(capture(dut, 3)) == SLOW_VCD
@@ -16,11 +16,13 @@
 #include <string.h>
 
 #include "argtable3/argtable3.h"
+#include "cli-api.h"
 #include "esp_console.h"
 #include "esp_err.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "help_text.h"
 #include "nvs.h"
 
 typedef struct
@@ -44,7 +46,6 @@ static const type_str_pair_t type_str_pair[] = {
 };
 
 static const size_t TYPE_STR_PAIR_SIZE = sizeof(type_str_pair) / sizeof(type_str_pair[0]);
-static const char *ARG_TYPE_STR = "type can be: i8, u8, i16, u16 i32, u32 i64, u64, str, blob";
 static char current_namespace[16] = "storage";
 static const char *TAG = "cmd_nvs";
 
@@ -611,6 +612,7 @@ static int set_namespace(int argc, char **argv)
 
   const char *namespace = namespace_args.namespace->sval[0];
   strlcpy(current_namespace, namespace, sizeof(current_namespace));
+  cli_prompt_invalidate("ns");
   ESP_LOGI(TAG, "Namespace set to '%s'", current_namespace);
   return 0;
 }
@@ -635,82 +637,111 @@ static int list_entries(int argc, char **argv)
   return list(part, name, type);
 }
 
-void register_nvs(void)
+/** {ns} prompt token: the namespace nvs_set/nvs_get/nvs_erase work on */
+static void prompt_namespace(char *buf, size_t size, void *arg)
 {
-  set_args.key = arg_str1(NULL, NULL, "<key>", "key of the value to be set");
-  set_args.type = arg_str1(NULL, NULL, "<type>", ARG_TYPE_STR);
+  strlcpy(buf, current_namespace, size);
+}
+
+/* Argument tables are built on first use (cli_register_lazy_command()) */
 
-  set_args.value = arg_str1("v", "value", "<value>", "value to be stored");
+static void build_set_args(void)
+{
+  set_args.key = arg_str1(NULL, NULL, "<key>", HELP_NVS_SET_KEY);
+  set_args.type = arg_str1(NULL, NULL, "<type>", HELP_NVS_TYPE);
+  set_args.value = arg_str1("v", "value", "<value>", HELP_NVS_SET_VALUE);
   set_args.end = arg_end(2);
+}
 
-  get_args.key = arg_str1(NULL, NULL, "<key>", "key of the value to be read");
-  get_args.type = arg_str1(NULL, NULL, "<type>", ARG_TYPE_STR);
+static void build_get_args(void)
+{
+  get_args.key = arg_str1(NULL, NULL, "<key>", HELP_NVS_GET_KEY);
+  get_args.type = arg_str1(NULL, NULL, "<type>", HELP_NVS_TYPE);
   get_args.end = arg_end(2);
+}
 
-  erase_args.key = arg_str1(NULL, NULL, "<key>", "key of the value to be erased");
+static void build_erase_args(void)
+{
+  erase_args.key = arg_str1(NULL, NULL, "<key>", HELP_NVS_ERASE_KEY);
   erase_args.end = arg_end(2);
+}
 
-  erase_all_args.namespace = arg_str1(NULL, NULL, "<namespace>", "namespace to be erased");
+static void build_erase_all_args(void)
+{
+  erase_all_args.namespace = arg_str1(NULL, NULL, "<namespace>", HELP_NVS_ERASE_NS_NAME);
   erase_all_args.end = arg_end(2);
+}
 
-  namespace_args.namespace = arg_str1(NULL, NULL, "<namespace>", "namespace of the partition to be selected");
+static void build_namespace_args(void)
+{
+  namespace_args.namespace = arg_str1(NULL, NULL, "<namespace>", HELP_NVS_NAMESPACE_NAME);
   namespace_args.end = arg_end(2);
+}
 
-  list_args.partition = arg_str1(NULL, NULL, "<partition>", "partition name");
-  list_args.namespace = arg_str0("n", "namespace", "<namespace>", "namespace name");
-  list_args.type = arg_str0("t", "type", "<type>", ARG_TYPE_STR);
+static void build_list_args(void)
+{
+  list_args.partition = arg_str1(NULL, NULL, "<partition>", HELP_NVS_LIST_PARTITION);
+  list_args.namespace = arg_str0("n", "namespace", "<namespace>", HELP_NVS_LIST_NAMESPACE);
+  list_args.type = arg_str0("t", "type", "<type>", HELP_NVS_TYPE);
   list_args.end = arg_end(2);
+}
 
-  const esp_console_cmd_t set_cmd = {.command = "nvs_set",
-                                     .help = "Set key-value pair in selected namespace.\n"
-                                             "Examples:\n"
-                                             " nvs_set VarName i32 -v 123 \n"
-                                             " nvs_set VarName str -v YourString \n"
-                                             " nvs_set VarName blob -v 0123456789abcdef \n",
-                                     .hint = NULL,
-                                     .func = &set_value,
-                                     .argtable = &set_args};
-
-  const esp_console_cmd_t get_cmd = {.command = "nvs_get",
-                                     .help = "Get key-value pair from selected namespace. \n"
-                                             "Example: nvs_get VarName i32",
-                                     .hint = NULL,
-                                     .func = &get_value,
-                                     .argtable = &get_args};
-
-  const esp_console_cmd_t erase_cmd = {.command = "nvs_erase",
-                                       .help = "Erase key-value pair from current namespace",
-                                       .hint = NULL,
-                                       .func = &erase_value,
-                                       .argtable = &erase_args};
-
-  const esp_console_cmd_t erase_namespace_cmd = {.command = "nvs_erase_namespace",
-                                                 .help = "Erases specified namespace",
-                                                 .hint = NULL,
-                                                 .func = &erase_namespace,
-                                                 .argtable = &erase_all_args};
-
-  const esp_console_cmd_t namespace_cmd = {.command = "nvs_namespace",
-                                           .help = "Set current namespace",
-                                           .hint = NULL,
-                                           .func = &set_namespace,
-                                           .argtable = &namespace_args};
-
-  const esp_console_cmd_t list_entries_cmd = {
-    .command = "nvs_list",
-    .help =
-      "List stored key-value pairs stored in NVS."
-      "Namespace and type can be specified to print only those key-value pairs.\n"
-      "Following command list variables stored inside 'nvs' partition, under namespace 'storage' with type uint32_t"
-      "Example: nvs_list nvs -n storage -t u32 \n",
-    .hint = NULL,
-    .func = &list_entries,
-    .argtable = &list_args};
-
-  ESP_ERROR_CHECK(esp_console_cmd_register(&set_cmd));
-  ESP_ERROR_CHECK(esp_console_cmd_register(&get_cmd));
-  ESP_ERROR_CHECK(esp_console_cmd_register(&erase_cmd));
-  ESP_ERROR_CHECK(esp_console_cmd_register(&namespace_cmd));
-  ESP_ERROR_CHECK(esp_console_cmd_register(&list_entries_cmd));
-  ESP_ERROR_CHECK(esp_console_cmd_register(&erase_namespace_cmd));
+void register_nvs(void)
+{
+  cli_prompt_register_token("ns", 0, prompt_namespace, NULL);
+
+  static const cli_lazy_command_t set_cmd = {.command = "nvs_set",
+                                             .help = HELP_NVS_SET,
+                                             .hint = NULL,
+                                             .func = &set_value,
+                                             .argtable = &set_args,
+                                             .argtable_len = CLI_ARGTABLE_LEN(set_args),
+                                             .build = build_set_args};
+
+  static const cli_lazy_command_t get_cmd = {.command = "nvs_get",
+                                             .help = HELP_NVS_GET,
+                                             .hint = NULL,
+                                             .func = &get_value,
+                                             .argtable = &get_args,
+                                             .argtable_len = CLI_ARGTABLE_LEN(get_args),
+                                             .build = build_get_args};
+
+  static const cli_lazy_command_t erase_cmd = {.command = "nvs_erase",
+                                               .help = HELP_NVS_ERASE,
+                                               .hint = NULL,
+                                               .func = &erase_value,
+                                               .argtable = &erase_args,
+                                               .argtable_len = CLI_ARGTABLE_LEN(erase_args),
+                                               .build = build_erase_args};
+
+  static const cli_lazy_command_t erase_namespace_cmd = {.command = "nvs_erase_namespace",
+                                                         .help = HELP_NVS_ERASE_NAMESPACE,
+                                                         .hint = NULL,
+                                                         .func = &erase_namespace,
+                                                         .argtable = &erase_all_args,
+                                                         .argtable_len = CLI_ARGTABLE_LEN(erase_all_args),
+                                                         .build = build_erase_all_args};
+
+  static const cli_lazy_command_t namespace_cmd = {.command = "nvs_namespace",
+                                                   .help = HELP_NVS_NAMESPACE,
+                                                   .hint = NULL,
+                                                   .func = &set_namespace,
+                                                   .argtable = &namespace_args,
+                                                   .argtable_len = CLI_ARGTABLE_LEN(namespace_args),
+                                                   .build = build_namespace_args};
+
+  static const cli_lazy_command_t list_entries_cmd = {.command = "nvs_list",
+                                                      .help = HELP_NVS_LIST,
+                                                      .hint = NULL,
+                                                      .func = &list_entries,
+                                                      .argtable = &list_args,
+                                                      .argtable_len = CLI_ARGTABLE_LEN(list_args),
+                                                      .build = build_list_args};
+
+  ESP_ERROR_CHECK(cli_register_lazy_command(&set_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&get_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&erase_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&namespace_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&list_entries_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&erase_namespace_cmd));
 }
@@ -14,6 +14,8 @@
 void register_system(void)
 {
   register_system_common();
+  register_system_mem();
+  register_system_part();
 
 #if SOC_LIGHT_SLEEP_SUPPORTED
   register_system_light_sleep();
@@ -22,4 +24,8 @@ void register_system(void)
 #if SOC_DEEP_SLEEP_SUPPORTED
   register_system_deep_sleep();
 #endif
+
+#if SOC_LIGHT_SLEEP_SUPPORTED || SOC_DEEP_SLEEP_SUPPORTED
+  register_system_sleepstats();
+#endif
 }
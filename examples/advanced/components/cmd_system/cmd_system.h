@@ -14,6 +14,15 @@ void register_system(void);
 // Register common system functions: "version", "restart", "free", "heap", "tasks"
 void register_system_common(void);
 
+// Register memory inspection functions: "mem_read", "mem_write", "mem_fill"
+void register_system_mem(void);
+
+// Register partition functions: "part_list", "part_hash"
+void register_system_part(void);
+
 // Register deep and light sleep functions
 void register_system_deep_sleep(void);
 void register_system_light_sleep(void);
+
+// Register "sleepstats"; also completes the record of the deep sleep the chip woke up from
+void register_system_sleepstats(void);
@@ -18,6 +18,7 @@
 #include <string.h>
 
 #include "argtable3/argtable3.h"
+#include "cli-api.h"
 #include "cmd_system.h"
 #include "esp_chip_info.h"
 #include "esp_console.h"
@@ -25,6 +26,7 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "help_text.h"
 #include "sdkconfig.h"
 
 #ifdef CONFIG_FREERTOS_USE_STATS_FORMATTING_FUNCTIONS
@@ -115,13 +117,13 @@ static int get_version(int argc, char **argv)
 
 static void register_version(void)
 {
-  const esp_console_cmd_t cmd = {
+  static const cli_lazy_command_t cmd = {
     .command = "version",
-    .help = "Get version of chip and SDK",
+    .help = HELP_VERSION,
     .hint = NULL,
     .func = &get_version,
   };
-  ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&cmd));
 }
 
 /** 'restart' command restarts the program */
@@ -134,13 +136,13 @@ static int restart(int argc, char **argv)
 
 static void register_restart(void)
 {
-  const esp_console_cmd_t cmd = {
+  static const cli_lazy_command_t cmd = {
     .command = "restart",
-    .help = "Software reset of the chip",
+    .help = HELP_RESTART,
     .hint = NULL,
     .func = &restart,
   };
-  ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&cmd));
 }
 
 /** 'free' command prints available heap memory */
@@ -153,13 +155,13 @@ static int free_mem(int argc, char **argv)
 
 static void register_free(void)
 {
-  const esp_console_cmd_t cmd = {
+  static const cli_lazy_command_t cmd = {
     .command = "free",
-    .help = "Get the current size of free heap memory",
+    .help = HELP_FREE,
     .hint = NULL,
     .func = &free_mem,
   };
-  ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&cmd));
 }
 
 /* 'heap' command prints minimum heap size */
@@ -172,13 +174,13 @@ static int heap_size(int argc, char **argv)
 
 static void register_heap(void)
 {
-  const esp_console_cmd_t heap_cmd = {
+  static const cli_lazy_command_t heap_cmd = {
     .command = "heap",
-    .help = "Get minimum size of free heap memory that was available during program execution",
+    .help = HELP_HEAP,
     .hint = NULL,
     .func = &heap_size,
   };
-  ESP_ERROR_CHECK(esp_console_cmd_register(&heap_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&heap_cmd));
 }
 
 /** 'tasks' command prints the list of tasks and related information */
@@ -206,13 +208,13 @@ static int tasks_info(int argc, char **argv)
 
 static void register_tasks(void)
 {
-  const esp_console_cmd_t cmd = {
+  static const cli_lazy_command_t cmd = {
     .command = "tasks",
-    .help = "Get information about running tasks",
+    .help = HELP_TASKS,
     .hint = NULL,
     .func = &tasks_info,
   };
-  ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&cmd));
 }
 
 #endif  // WITH_TASKS_INFO
@@ -266,17 +268,21 @@ static int log_level(int argc, char **argv)
   return 0;
 }
 
-static void register_log_level(void)
+static void build_log_level_args(void)
 {
-  log_level_args.tag = arg_str1(NULL, NULL, "<tag|*>", "Log tag to set the level for, or * to set for all tags");
-  log_level_args.level =
-    arg_str1(NULL, NULL, "<none|error|warn|info|debug|verbose>", "Log level to set. Abbreviated words are accepted.");
+  log_level_args.tag = arg_str1(NULL, NULL, "<tag|*>", HELP_LOG_LEVEL_TAG);
+  log_level_args.level = arg_str1(NULL, NULL, "<none|error|warn|info|debug|verbose>", HELP_LOG_LEVEL_LEVEL);
   log_level_args.end = arg_end(2);
+}
 
-  const esp_console_cmd_t cmd = {.command = "log_level",
-                                 .help = "Set log level for all tags or a specific tag.",
-                                 .hint = NULL,
-                                 .func = &log_level,
-                                 .argtable = &log_level_args};
-  ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+static void register_log_level(void)
+{
+  static const cli_lazy_command_t cmd = {.command = "log_level",
+                                         .help = HELP_LOG_LEVEL,
+                                         .hint = NULL,
+                                         .func = &log_level,
+                                         .argtable = &log_level_args,
+                                         .argtable_len = CLI_ARGTABLE_LEN(log_level_args),
+                                         .build = build_log_level_args};
+  ESP_ERROR_CHECK(cli_register_lazy_command(&cmd));
 }
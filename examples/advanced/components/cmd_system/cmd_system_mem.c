@@ -0,0 +1,398 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Console example — memory inspection commands
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "argtable3/argtable3.h"
+#include "cli-api.h"
+#include "cmd_system.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_memory_utils.h"
+#include "help_text.h"
+#include "sdkconfig.h"
+#include "soc/soc_caps.h"
+
+static const char *TAG = "cmd_system_mem";
+
+/* Bytes copied per step when streaming a range, multiple of the 16-byte hexdump line */
+#define MEM_CHUNK_SIZE 256
+
+/* Upper bound for a single mem_read / mem_fill, catches typos in the length */
+#define MEM_MAX_LEN (16 * 1024 * 1024)
+
+static struct
+{
+  struct arg_str *address;
+  struct arg_str *length;
+  struct arg_lit *raw;
+  struct arg_end *end;
+} mem_read_args;
+
+static struct
+{
+  struct arg_str *address;
+  struct arg_str *value;
+  struct arg_int *width;
+  struct arg_end *end;
+} mem_write_args;
+
+static struct
+{
+  struct arg_str *address;
+  struct arg_str *length;
+  struct arg_str *value;
+  struct arg_end *end;
+} mem_fill_args;
+
+/**
+ * @brief Find the memory region that fully contains [start, start + len)
+ *
+ * @return Region name, or NULL if the range is not entirely inside one known region
+ */
+static const char *mem_region(uintptr_t start, size_t len, bool *writable)
+{
+  if (len == 0 || start + len - 1 < start)
+  {
+    return NULL;
+  }
+
+  void *first = (void *)start;
+  void *last = (void *)(start + len - 1);
+
+  *writable = true;
+  if (esp_ptr_in_dram(first) && esp_ptr_in_dram(last))
+  {
+    return "DRAM";
+  }
+#if SOC_RTC_FAST_MEM_SUPPORTED
+  if (esp_ptr_in_rtc_dram_fast(first) && esp_ptr_in_rtc_dram_fast(last))
+  {
+    return "RTC_FAST";
+  }
+#endif
+#if SOC_RTC_SLOW_MEM_SUPPORTED
+  if (esp_ptr_in_rtc_slow(first) && esp_ptr_in_rtc_slow(last))
+  {
+    return "RTC_SLOW";
+  }
+#endif
+#if CONFIG_SPIRAM
+  if (esp_ptr_external_ram(first) && esp_ptr_external_ram(last))
+  {
+    return "PSRAM";
+  }
+#endif
+
+  /* Code and flash-mapped data: readable only */
+  *writable = false;
+  if (esp_ptr_in_iram(first) && esp_ptr_in_iram(last))
+  {
+    return "IRAM";
+  }
+  if (esp_ptr_in_drom(first) && esp_ptr_in_drom(last))
+  {
+    return "DROM";
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Copy bytes using aligned 32-bit loads only (IRAM does not support byte access on every chip)
+ */
+static void mem_copy_words(uint8_t *dst, uintptr_t src, size_t len)
+{
+  uintptr_t word_addr = src & ~(uintptr_t)3;
+  size_t skip = src & 3;
+
+  while (len > 0)
+  {
+    uint32_t word = *(volatile const uint32_t *)word_addr;
+    for (size_t i = skip; i < 4 && len > 0; i++, len--)
+    {
+      *dst++ = (uint8_t)(word >> (8 * i));
+    }
+    skip = 0;
+    word_addr += 4;
+  }
+}
+
+static bool parse_number(const char *str, uint32_t *out)
+{
+  char *end;
+  unsigned long value = strtoul(str, &end, 0);
+  if (end == str || *end != '\0')
+  {
+    return false;
+  }
+  *out = (uint32_t)value;
+  return true;
+}
+
+/**
+ * @brief Validate address and length arguments against the memory map
+ */
+static const char *parse_range(const char *addr_str, const char *len_str, uintptr_t *addr, size_t *len, bool *writable)
+{
+  uint32_t a, l;
+  if (!parse_number(addr_str, &a) || !parse_number(len_str, &l))
+  {
+    printf("ERROR: Address and length must be numbers (decimal or 0x-prefixed hex)\n");
+    return NULL;
+  }
+  if (l == 0 || l > MEM_MAX_LEN)
+  {
+    printf("ERROR: Length must be between 1 and %d bytes\n", MEM_MAX_LEN);
+    return NULL;
+  }
+
+  const char *region = mem_region(a, l, writable);
+  if (region == NULL)
+  {
+    printf("ERROR: Range 0x%08" PRIx32 "..0x%08" PRIx32 " is not inside a single known memory region\n",
+           a,
+           a + l - 1);
+    return NULL;
+  }
+
+  *addr = a;
+  *len = l;
+  return region;
+}
+
+/** 'mem_read' command dumps a memory range as hexdump or raw binary */
+
+static int mem_read(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&mem_read_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, mem_read_args.end, argv[0]);
+    return 1;
+  }
+
+  uintptr_t addr;
+  size_t len;
+  bool writable;
+  if (parse_range(mem_read_args.address->sval[0], mem_read_args.length->sval[0], &addr, &len, &writable) == NULL)
+  {
+    return 1;
+  }
+
+  bool raw = mem_read_args.raw->count > 0;
+  uint8_t buf[MEM_CHUNK_SIZE];
+
+  /* Raw mode: a header line with the exact length, then the bytes untranslated, then a newline */
+  if (raw)
+  {
+    printf("MEMRAW 0x%08" PRIx32 " %u\n", (uint32_t)addr, (unsigned)len);
+    cli_set_binary_mode(true);
+  }
+
+  for (size_t done = 0; done < len;)
+  {
+    size_t chunk = (len - done < MEM_CHUNK_SIZE) ? len - done : MEM_CHUNK_SIZE;
+    mem_copy_words(buf, addr + done, chunk);
+
+    if (raw)
+    {
+      fwrite(buf, 1, chunk, stdout);
+    }
+    else
+    {
+      cli_hexdump((uint32_t)(addr + done), buf, chunk);
+    }
+    done += chunk;
+  }
+
+  if (raw)
+  {
+    cli_set_binary_mode(false);
+    printf("\n");
+  }
+
+  return 0;
+}
+
+/** 'mem_write' command writes one 8/16/32-bit value */
+
+static int mem_write(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&mem_write_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, mem_write_args.end, argv[0]);
+    return 1;
+  }
+
+  int width = (mem_write_args.width->count > 0) ? mem_write_args.width->ival[0] : 4;
+  if (width != 1 && width != 2 && width != 4)
+  {
+    printf("ERROR: Width must be 1, 2 or 4 bytes\n");
+    return 1;
+  }
+
+  uint32_t value;
+  if (!parse_number(mem_write_args.value->sval[0], &value) || (width < 4 && value >> (8 * width) != 0))
+  {
+    printf("ERROR: Invalid %d-byte value '%s'\n", width, mem_write_args.value->sval[0]);
+    return 1;
+  }
+
+  char width_str[2] = {(char)('0' + width), '\0'};
+  uintptr_t addr;
+  size_t len;
+  bool writable;
+  const char *region = parse_range(mem_write_args.address->sval[0], width_str, &addr, &len, &writable);
+  if (region == NULL)
+  {
+    return 1;
+  }
+  if (!writable)
+  {
+    printf("ERROR: %s is not writable\n", region);
+    return 1;
+  }
+  if (addr % width != 0)
+  {
+    printf("ERROR: Address must be aligned to %d bytes\n", width);
+    return 1;
+  }
+
+  uint32_t before, after;
+  switch (width)
+  {
+    case 1:
+      before = *(volatile uint8_t *)addr;
+      *(volatile uint8_t *)addr = (uint8_t)value;
+      after = *(volatile uint8_t *)addr;
+      break;
+    case 2:
+      before = *(volatile uint16_t *)addr;
+      *(volatile uint16_t *)addr = (uint16_t)value;
+      after = *(volatile uint16_t *)addr;
+      break;
+    default:
+      before = *(volatile uint32_t *)addr;
+      *(volatile uint32_t *)addr = value;
+      after = *(volatile uint32_t *)addr;
+      break;
+  }
+
+  ESP_LOGD(TAG, "%s write at 0x%08" PRIx32, region, (uint32_t)addr);
+  printf("0x%08" PRIx32 ": 0x%0*" PRIx32 " -> 0x%0*" PRIx32 "\n", (uint32_t)addr, width * 2, before, width * 2, after);
+
+  return (after == value) ? 0 : 1;
+}
+
+/** 'mem_fill' command fills a range with a byte value */
+
+static int mem_fill(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&mem_fill_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, mem_fill_args.end, argv[0]);
+    return 1;
+  }
+
+  uint32_t value;
+  if (!parse_number(mem_fill_args.value->sval[0], &value) || value > UINT8_MAX)
+  {
+    printf("ERROR: Fill value must be a byte (0-255)\n");
+    return 1;
+  }
+
+  uintptr_t addr;
+  size_t len;
+  bool writable;
+  const char *region =
+    parse_range(mem_fill_args.address->sval[0], mem_fill_args.length->sval[0], &addr, &len, &writable);
+  if (region == NULL)
+  {
+    return 1;
+  }
+  if (!writable)
+  {
+    printf("ERROR: %s is not writable\n", region);
+    return 1;
+  }
+
+  memset((void *)addr, (int)value, len);
+  printf("Filled %u bytes of %s at 0x%08" PRIx32 " with 0x%02" PRIx32 "\n", (unsigned)len, region, (uint32_t)addr,
+         value);
+
+  return 0;
+}
+
+/* Argument tables are built on first use (cli_register_lazy_command()) */
+
+static void build_mem_read_args(void)
+{
+  mem_read_args.address = arg_str1(NULL, NULL, "<addr>", HELP_MEM_READ_ADDR);
+  mem_read_args.length = arg_str1(NULL, NULL, "<len>", HELP_MEM_LEN);
+  mem_read_args.raw = arg_lit0("r", "raw", HELP_MEM_READ_RAW);
+  mem_read_args.end = arg_end(3);
+}
+
+static void build_mem_write_args(void)
+{
+  mem_write_args.address = arg_str1(NULL, NULL, "<addr>", HELP_MEM_WRITE_ADDR);
+  mem_write_args.value = arg_str1(NULL, NULL, "<value>", HELP_MEM_WRITE_VALUE);
+  mem_write_args.width = arg_int0("w", "width", "<1|2|4>", HELP_MEM_WRITE_WIDTH);
+  mem_write_args.end = arg_end(3);
+}
+
+static void build_mem_fill_args(void)
+{
+  mem_fill_args.address = arg_str1(NULL, NULL, "<addr>", HELP_MEM_FILL_ADDR);
+  mem_fill_args.length = arg_str1(NULL, NULL, "<len>", HELP_MEM_LEN);
+  mem_fill_args.value = arg_str1(NULL, NULL, "<byte>", HELP_MEM_FILL_VALUE);
+  mem_fill_args.end = arg_end(3);
+}
+
+void register_system_mem(void)
+{
+  static const cli_lazy_command_t read_cmd = {.command = "mem_read",
+                                              .help = HELP_MEM_READ,
+                                              .hint = NULL,
+                                              .func = &mem_read,
+                                              .argtable = &mem_read_args,
+                                              .argtable_len = CLI_ARGTABLE_LEN(mem_read_args),
+                                              .build = build_mem_read_args};
+
+  static const cli_lazy_command_t write_cmd = {.command = "mem_write",
+                                               .help = HELP_MEM_WRITE,
+                                               .hint = NULL,
+                                               .func = &mem_write,
+                                               .argtable = &mem_write_args,
+                                               .argtable_len = CLI_ARGTABLE_LEN(mem_write_args),
+                                               .build = build_mem_write_args};
+
+  static const cli_lazy_command_t fill_cmd = {.command = "mem_fill",
+                                              .help = HELP_MEM_FILL,
+                                              .hint = NULL,
+                                              .func = &mem_fill,
+                                              .argtable = &mem_fill_args,
+                                              .argtable_len = CLI_ARGTABLE_LEN(mem_fill_args),
+                                              .build = build_mem_fill_args};
+
+  ESP_ERROR_CHECK(cli_register_lazy_command(&read_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&write_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&fill_cmd));
+}
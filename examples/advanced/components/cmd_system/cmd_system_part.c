@@ -0,0 +1,303 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Pedro Luis Dionisio Fraga
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Console example — partition commands
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "argtable3/argtable3.h"
+#include "cli-api.h"
+#include "cmd_system.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "help_text.h"
+#include "psa/crypto.h"
+
+static const char *TAG = "cmd_system_part";
+
+/* Size of each of the two read buffers, a multiple of the 4 KB flash sector */
+#define PART_CHUNK_SIZE 4096
+
+#define PART_READER_STACK_SIZE 3072
+
+/**
+ * @brief A filled buffer handed from the reader task to the hashing task
+ */
+typedef struct
+{
+  uint8_t index; /**< Buffer index (0 or 1) */
+  size_t len;    /**< Bytes read, 0 marks the end of the stream */
+  esp_err_t err; /**< Read result */
+} part_chunk_t;
+
+/**
+ * @brief Shared state of one double-buffered read
+ */
+typedef struct
+{
+  const esp_partition_t *part; /**< Partition being read */
+  size_t offset;               /**< First byte to read */
+  size_t len;                  /**< Number of bytes to read */
+  uint8_t *buf[2];             /**< Read buffers */
+  QueueHandle_t free_q;        /**< Indexes of buffers the reader may fill */
+  QueueHandle_t full_q;        /**< Filled buffers (part_chunk_t) */
+} part_pipeline_t;
+
+/* Allocated on first use and kept: the reader task may still be returning from its last queue send when the command
+ * finishes, so the queues are never deleted */
+static part_pipeline_t s_pipeline;
+
+static struct
+{
+  struct arg_str *label;
+  struct arg_int *offset;
+  struct arg_int *length;
+  struct arg_end *end;
+} part_hash_args;
+
+static const char *part_type_name(esp_partition_type_t type)
+{
+  switch (type)
+  {
+    case ESP_PARTITION_TYPE_APP:
+      return "app";
+    case ESP_PARTITION_TYPE_DATA:
+      return "data";
+    case ESP_PARTITION_TYPE_BOOTLOADER:
+      return "boot";
+    case ESP_PARTITION_TYPE_PARTITION_TABLE:
+      return "table";
+    default:
+      return "?";
+  }
+}
+
+/** 'part_list' command prints the partition table */
+
+static int part_list(int argc, char **argv)
+{
+  printf("%-16s %-5s %7s %10s %10s %s\n", "Label", "Type", "Subtype", "Offset", "Size", "Flags");
+
+  esp_partition_iterator_t it = esp_partition_find(ESP_PARTITION_TYPE_ANY, ESP_PARTITION_SUBTYPE_ANY, NULL);
+  for (; it != NULL; it = esp_partition_next(it))
+  {
+    const esp_partition_t *part = esp_partition_get(it);
+    printf("%-16s %-5s    0x%02x 0x%08" PRIx32 " 0x%08" PRIx32 " %s%s\n",
+           part->label,
+           part_type_name(part->type),
+           part->subtype,
+           part->address,
+           part->size,
+           part->encrypted ? "encrypted " : "",
+           part->readonly ? "readonly" : "");
+  }
+  esp_partition_iterator_release(it);
+
+  return 0;
+}
+
+/**
+ * @brief Reader task: fills whichever buffer the hashing side has released, so the next flash read overlaps with
+ * hashing of the previous chunk
+ */
+static void part_reader_task(void *arg)
+{
+  part_pipeline_t *pl = arg;
+  size_t pos = 0;
+  part_chunk_t chunk = {0};
+
+  while (pos < pl->len)
+  {
+    xQueueReceive(pl->free_q, &chunk.index, portMAX_DELAY);
+
+    chunk.len = (pl->len - pos < PART_CHUNK_SIZE) ? pl->len - pos : PART_CHUNK_SIZE;
+    chunk.err = esp_partition_read(pl->part, pl->offset + pos, pl->buf[chunk.index], chunk.len);
+    xQueueSend(pl->full_q, &chunk, portMAX_DELAY);
+
+    if (chunk.err != ESP_OK)
+      break;
+    pos += chunk.len;
+  }
+
+  if (chunk.err == ESP_OK)
+  {
+    chunk.len = 0;
+    xQueueSend(pl->full_q, &chunk, portMAX_DELAY);
+  }
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief Hash a partition range with SHA-256 through the double-buffered reader
+ */
+static esp_err_t part_sha256(part_pipeline_t *pl, uint8_t digest[32])
+{
+  psa_hash_operation_t op = PSA_HASH_OPERATION_INIT;
+  if (psa_crypto_init() != PSA_SUCCESS || psa_hash_setup(&op, PSA_ALG_SHA_256) != PSA_SUCCESS)
+    return ESP_FAIL;
+
+  /* A previous read error may have left a buffer index behind */
+  xQueueReset(pl->free_q);
+  xQueueReset(pl->full_q);
+  for (uint8_t i = 0; i < 2; i++) xQueueSend(pl->free_q, &i, 0);
+
+  /* Same priority as the console task, so neither side starves the other */
+  if (xTaskCreate(part_reader_task, "part_reader", PART_READER_STACK_SIZE, pl, uxTaskPriorityGet(NULL), NULL) !=
+      pdPASS)
+  {
+    psa_hash_abort(&op);
+    return ESP_ERR_NO_MEM;
+  }
+
+  esp_err_t err = ESP_OK;
+  part_chunk_t chunk;
+  for (;;)
+  {
+    xQueueReceive(pl->full_q, &chunk, portMAX_DELAY);
+    if (chunk.err != ESP_OK)
+    {
+      /* The reader stops after a failed read */
+      err = chunk.err;
+      break;
+    }
+    if (chunk.len == 0)
+      break;
+
+    if (err == ESP_OK && psa_hash_update(&op, pl->buf[chunk.index], chunk.len) != PSA_SUCCESS)
+      err = ESP_FAIL;
+
+    /* Keep draining after a hash error, the reader must run to completion before the next command reuses the buffers */
+    xQueueSend(pl->free_q, &chunk.index, portMAX_DELAY);
+  }
+
+  size_t digest_len;
+  if (err == ESP_OK && psa_hash_finish(&op, digest, 32, &digest_len) != PSA_SUCCESS)
+    err = ESP_FAIL;
+  if (err != ESP_OK)
+    psa_hash_abort(&op);
+
+  return err;
+}
+
+/** 'part_hash' command computes the SHA-256 of a partition, or part of it */
+
+static int part_hash(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&part_hash_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, part_hash_args.end, argv[0]);
+    return 1;
+  }
+
+  const char *label = part_hash_args.label->sval[0];
+  const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_ANY, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (part == NULL)
+  {
+    printf("ERROR: Partition '%s' not found\n", label);
+    return 1;
+  }
+
+  int offset = (part_hash_args.offset->count > 0) ? part_hash_args.offset->ival[0] : 0;
+  if (offset < 0 || (uint32_t)offset > part->size)
+  {
+    printf("ERROR: Offset outside partition (size 0x%" PRIx32 ")\n", part->size);
+    return 1;
+  }
+  int length = (part_hash_args.length->count > 0) ? part_hash_args.length->ival[0] : (int)(part->size - offset);
+  if (length <= 0 || (uint32_t)length > part->size - offset)
+  {
+    printf("ERROR: Length must be between 1 and 0x%" PRIx32 "\n", part->size - offset);
+    return 1;
+  }
+
+  part_pipeline_t *pl = &s_pipeline;
+  if (pl->free_q == NULL)
+  {
+    pl->buf[0] = malloc(PART_CHUNK_SIZE);
+    pl->buf[1] = malloc(PART_CHUNK_SIZE);
+    pl->free_q = xQueueCreate(2, sizeof(uint8_t));
+    pl->full_q = xQueueCreate(3, sizeof(part_chunk_t));
+    if (!pl->buf[0] || !pl->buf[1] || !pl->free_q || !pl->full_q)
+    {
+      ESP_LOGE(TAG, "Out of memory for the read buffers");
+      free(pl->buf[0]);
+      free(pl->buf[1]);
+      if (pl->free_q)
+        vQueueDelete(pl->free_q);
+      if (pl->full_q)
+        vQueueDelete(pl->full_q);
+      memset(pl, 0, sizeof(*pl));
+      return 1;
+    }
+  }
+  pl->part = part;
+  pl->offset = offset;
+  pl->len = length;
+
+  uint8_t digest[32];
+  int64_t start = esp_timer_get_time();
+  esp_err_t err = part_sha256(pl, digest);
+  int64_t elapsed_us = esp_timer_get_time() - start;
+
+  if (err != ESP_OK)
+  {
+    ESP_LOGE(TAG, "Hashing '%s' failed: %s", label, esp_err_to_name(err));
+    return 1;
+  }
+
+  char hex[65];
+  for (int i = 0; i < 32; i++) sprintf(&hex[i * 2], "%02x", digest[i]);
+
+  printf("%s  %s 0x%x+0x%x\n", hex, label, offset, length);
+  printf("%d bytes in %" PRId64 " ms (%.2f MB/s)\n",
+         length,
+         elapsed_us / 1000,
+         elapsed_us > 0 ? (double)length / elapsed_us : 0.0);
+
+  return 0;
+}
+
+static void build_part_hash_args(void)
+{
+  part_hash_args.label = arg_str1(NULL, NULL, "<label>", HELP_PART_HASH_LABEL);
+  part_hash_args.offset = arg_int0("o", "offset", "<offset>", HELP_PART_HASH_OFFSET);
+  part_hash_args.length = arg_int0("l", "len", "<len>", HELP_PART_HASH_LEN);
+  part_hash_args.end = arg_end(3);
+}
+
+void register_system_part(void)
+{
+  static const cli_lazy_command_t list_cmd = {.command = "part_list",
+                                              .help = HELP_PART_LIST,
+                                              .hint = NULL,
+                                              .func = &part_list};
+
+  static const cli_lazy_command_t hash_cmd = {.command = "part_hash",
+                                              .help = HELP_PART_HASH,
+                                              .hint = NULL,
+                                              .func = &part_hash,
+                                              .argtable = &part_hash_args,
+                                              .argtable_len = CLI_ARGTABLE_LEN(part_hash_args),
+                                              .build = build_part_hash_args};
+
+  ESP_ERROR_CHECK(cli_register_lazy_command(&list_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&hash_cmd));
+}
@@ -19,19 +19,166 @@
 #include <unistd.h>
 
 #include "argtable3/argtable3.h"
+#include "cli-api.h"
 #include "cmd_system.h"
 #include "driver/gpio.h"
 #include "driver/rtc_io.h"
 #include "driver/uart.h"
+#include "esp_attr.h"
 #include "esp_chip_info.h"
 #include "esp_console.h"
 #include "esp_idf_version.h"
 #include "esp_log.h"
+#include "esp_private/esp_clk.h"
 #include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "help_text.h"
 #include "sdkconfig.h"
 
 static const char *TAG = "cmd_system_sleep";
 
+/** Sleep statistics: one record per light_sleep / deep_sleep, kept in RTC memory across deep sleep */
+
+#define SLEEP_STATS_MAGIC   0x534C5031 /* "SLP1", bump when the layout changes */
+#define SLEEP_STATS_HISTORY 8
+
+typedef enum
+{
+  SLEEP_LIGHT,
+  SLEEP_DEEP,
+  SLEEP_TYPES,
+} sleep_type_t;
+
+/**
+ * @brief One sleep, all durations in microseconds
+ *
+ * Wake latencies are exact for timer wakeups: the overshoot past the requested time, measured on the clock that kept
+ * running during the sleep. For other wakeups the light sleep one is unknown (0) and the deep sleep one comes from
+ * esp_timer, which starts counting at the wakeup reset.
+ */
+typedef struct
+{
+  uint8_t type;          /**< sleep_type_t */
+  uint32_t causes;       /**< Wakeup causes bitmap, bit n = esp_sleep_source_t n */
+  uint64_t requested_us; /**< Timer wakeup, 0 if none */
+  uint64_t slept_us;     /**< Sleep entry to wakeup */
+  uint32_t first_us;     /**< Wakeup to the first instruction after the sleep */
+  uint32_t ready_us;     /**< Wakeup to the console being ready again, 0 until known */
+} sleep_record_t;
+
+typedef struct
+{
+  uint32_t magic;                              /**< SLEEP_STATS_MAGIC when valid */
+  uint8_t deep_pending;                        /**< Deep sleep entered, record completed after the wakeup */
+  int64_t since_us;                            /**< Start of the statistics window (RTC time) */
+  int64_t enter_us;                            /**< RTC time at the last deep sleep entry */
+  uint64_t enter_requested_us;                 /**< Timer wakeup of that deep sleep */
+  uint32_t count[SLEEP_TYPES];                 /**< Sleeps per type */
+  uint64_t slept_us[SLEEP_TYPES];              /**< Time asleep per type */
+  uint32_t total;                              /**< Records written, the newest is (total - 1) % HISTORY */
+  sleep_record_t records[SLEEP_STATS_HISTORY]; /**< Most recent sleeps */
+} sleep_stats_t;
+
+/** Not initialized at boot: survives deep sleep and software resets */
+static RTC_NOINIT_ATTR sleep_stats_t s_stats;
+
+/* First instruction we control after a (wakeup) reset: RTC time and esp_timer */
+static int64_t s_boot_rtc_us;
+static int64_t s_boot_timer_us;
+
+/* The RTC timer keeps counting through deep sleep and is not moved by settimeofday() */
+static int64_t sleep_stats_now(void)
+{
+  return (int64_t)esp_clk_rtc_time();
+}
+
+/* Runs before app_main() */
+static void __attribute__((constructor)) sleep_stats_boot(void)
+{
+  s_boot_rtc_us = sleep_stats_now();
+  s_boot_timer_us = esp_timer_get_time();
+}
+
+static uint32_t sleep_wakeup_causes(void)
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(6, 0, 0)
+  return esp_sleep_get_wakeup_causes();
+#else
+  return 1UL << esp_sleep_get_wakeup_cause();
+#endif
+}
+
+static void sleep_stats_clear(void)
+{
+  memset(&s_stats, 0, sizeof(s_stats));
+  s_stats.magic = SLEEP_STATS_MAGIC;
+  s_stats.since_us = sleep_stats_now();
+}
+
+/**
+ * @brief Append a record and update the totals
+ *
+ * @param elapsed_us Sleep entry to the first instruction after it
+ * @param first_us Wake latency to use when the wakeup was not the timer one (0 if unknown)
+ */
+static sleep_record_t *sleep_stats_add(
+  sleep_type_t type, uint64_t requested_us, uint64_t elapsed_us, uint64_t first_us, uint32_t causes)
+{
+  /* Timer wakeup: it happened at the requested time, the rest of the elapsed time is wake latency */
+  if (requested_us > 0 && (causes & (1UL << ESP_SLEEP_WAKEUP_TIMER)) && elapsed_us >= requested_us)
+    first_us = elapsed_us - requested_us;
+  else if (first_us > elapsed_us)
+    first_us = elapsed_us;
+
+  sleep_record_t *rec = &s_stats.records[s_stats.total++ % SLEEP_STATS_HISTORY];
+  memset(rec, 0, sizeof(*rec));
+  rec->type = type;
+  rec->causes = causes;
+  rec->requested_us = requested_us;
+  rec->slept_us = elapsed_us - first_us;
+  rec->first_us = first_us;
+
+  s_stats.count[type]++;
+  s_stats.slept_us[type] += rec->slept_us;
+  return rec;
+}
+
+/**
+ * @brief Validate the RTC block and complete the record of the deep sleep we woke up from
+ */
+static void sleep_stats_init(void)
+{
+  if (s_stats.magic != SLEEP_STATS_MAGIC || s_stats.since_us > s_boot_rtc_us)
+    sleep_stats_clear(); /* Power-on: RTC memory and the RTC timer were reset */
+
+  if (!s_stats.deep_pending)
+    return;
+  s_stats.deep_pending = 0;
+  if (esp_reset_reason() != ESP_RST_DEEPSLEEP)
+    return;
+
+  /* Without a timer wakeup, the boot time counted by esp_timer since the wakeup reset is the latency */
+  sleep_stats_add(SLEEP_DEEP,
+                  s_stats.enter_requested_us,
+                  s_boot_rtc_us - s_stats.enter_us,
+                  s_boot_timer_us,
+                  sleep_wakeup_causes());
+}
+
+/**
+ * @brief Fill in the wakeup-to-prompt latency of a deep sleep record once the console has started
+ */
+static void sleep_stats_update_ready(void)
+{
+  if (s_stats.total == 0)
+    return;
+  sleep_record_t *rec = &s_stats.records[(s_stats.total - 1) % SLEEP_STATS_HISTORY];
+  int64_t ready = cli_get_ready_time_us();
+  if (rec->type == SLEEP_DEEP && rec->ready_us == 0 && ready > s_boot_timer_us)
+    rec->ready_us = rec->first_us + (ready - s_boot_timer_us);
+}
+
 #if SOC_DEEP_SLEEP_SUPPORTED
 /** 'deep_sleep' command puts the chip into deep sleep mode */
 static struct
@@ -52,9 +199,10 @@ static int deep_sleep(int argc, char **argv)
     arg_print_errors(stderr, deep_sleep_args.end, argv[0]);
     return 1;
   }
+  uint64_t timeout = 0;
   if (deep_sleep_args.wakeup_time->count)
   {
-    uint64_t timeout = 1000ULL * deep_sleep_args.wakeup_time->ival[0];
+    timeout = 1000ULL * deep_sleep_args.wakeup_time->ival[0];
     ESP_LOGI(TAG, "Enabling timer wakeup, timeout=%lluus", timeout);
     ESP_ERROR_CHECK(esp_sleep_enable_timer_wakeup(timeout));
   }
@@ -88,33 +236,40 @@ static int deep_sleep(int argc, char **argv)
 #if CONFIG_IDF_TARGET_ESP32
   rtc_gpio_isolate(GPIO_NUM_12);
 #endif  // CONFIG_IDF_TARGET_ESP32
+  sleep_stats_update_ready();
+  s_stats.enter_requested_us = timeout;
+  s_stats.deep_pending = 1;
+  s_stats.enter_us = sleep_stats_now();
   esp_deep_sleep_start();
   return 1;
 }
 
-void register_system_deep_sleep(void)
+static void build_deep_sleep_args(void)
 {
   int num_args = 1;
-  deep_sleep_args.wakeup_time = arg_int0("t", "time", "<t>", "Wake up time, ms");
+  deep_sleep_args.wakeup_time = arg_int0("t", "time", "<t>", HELP_SLEEP_TIME);
 #if SOC_PM_SUPPORT_EXT0_WAKEUP || SOC_PM_SUPPORT_EXT1_WAKEUP
-  deep_sleep_args.wakeup_gpio_num = arg_int0(NULL, "io", "<n>", "If specified, wakeup using GPIO with given number");
-  deep_sleep_args.wakeup_gpio_level = arg_int0(NULL, "io_level", "<0|1>", "GPIO level to trigger wakeup");
+  deep_sleep_args.wakeup_gpio_num = arg_int0(NULL, "io", "<n>", HELP_SLEEP_IO);
+  deep_sleep_args.wakeup_gpio_level = arg_int0(NULL, "io_level", "<0|1>", HELP_SLEEP_IO_LEVEL);
   num_args += 2;
 #endif
   deep_sleep_args.end = arg_end(num_args);
+}
 
-  const esp_console_cmd_t cmd = {.command = "deep_sleep",
-                                 .help = "Enter deep sleep mode. "
+void register_system_deep_sleep(void)
+{
+  static const cli_lazy_command_t cmd = {.command = "deep_sleep",
 #if SOC_PM_SUPPORT_EXT0_WAKEUP || SOC_PM_SUPPORT_EXT1_WAKEUP
-                                         "Two wakeup modes are supported: timer and GPIO. "
+                                         .help = HELP_DEEP_SLEEP_GPIO,
 #else
-                                         "Timer wakeup mode is supported. "
+                                         .help = HELP_DEEP_SLEEP_TIMER,
 #endif
-                                         "If no wakeup option is specified, will sleep indefinitely.",
-                                 .hint = NULL,
-                                 .func = &deep_sleep,
-                                 .argtable = &deep_sleep_args};
-  ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+                                         .hint = NULL,
+                                         .func = &deep_sleep,
+                                         .argtable = &deep_sleep_args,
+                                         .argtable_len = CLI_ARGTABLE_LEN(deep_sleep_args),
+                                         .build = build_deep_sleep_args};
+  ESP_ERROR_CHECK(cli_register_lazy_command(&cmd));
 }
 #endif  // SOC_DEEP_SLEEP_SUPPORTED
 
@@ -137,9 +292,10 @@ static int light_sleep(int argc, char **argv)
     return 1;
   }
   esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+  uint64_t timeout = 0;
   if (light_sleep_args.wakeup_time->count)
   {
-    uint64_t timeout = 1000ULL * light_sleep_args.wakeup_time->ival[0];
+    timeout = 1000ULL * light_sleep_args.wakeup_time->ival[0];
     ESP_LOGI(TAG, "Enabling timer wakeup, timeout=%lluus", timeout);
     ESP_ERROR_CHECK(esp_sleep_enable_timer_wakeup(timeout));
   }
@@ -174,7 +330,11 @@ static int light_sleep(int argc, char **argv)
   }
   fflush(stdout);
   fsync(fileno(stdout));
+  sleep_stats_update_ready();
+  int64_t enter_us = esp_timer_get_time();
   esp_light_sleep_start();
+  int64_t wake_us = esp_timer_get_time(); /* esp_timer is compensated for the time spent in light sleep */
+  sleep_record_t *rec = sleep_stats_add(SLEEP_LIGHT, timeout, wake_us - enter_us, 0, sleep_wakeup_causes());
   const char *cause_str;
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(6, 0, 0)
   /* IDF v6: esp_sleep_get_wakeup_cause() is deprecated; the replacement
@@ -210,26 +370,141 @@ static int light_sleep(int argc, char **argv)
   }
 #endif
   ESP_LOGI(TAG, "Woke up from: %s", cause_str);
+  rec->ready_us = rec->first_us + (esp_timer_get_time() - wake_us);
   return 0;
 }
 
-void register_system_light_sleep(void)
+static void build_light_sleep_args(void)
 {
-  light_sleep_args.wakeup_time = arg_int0("t", "time", "<t>", "Wake up time, ms");
-  light_sleep_args.wakeup_gpio_num =
-    arg_intn(NULL, "io", "<n>", 0, 8, "If specified, wakeup using GPIO with given number");
-  light_sleep_args.wakeup_gpio_level = arg_intn(NULL, "io_level", "<0|1>", 0, 8, "GPIO level to trigger wakeup");
+  light_sleep_args.wakeup_time = arg_int0("t", "time", "<t>", HELP_SLEEP_TIME);
+  light_sleep_args.wakeup_gpio_num = arg_intn(NULL, "io", "<n>", 0, 8, HELP_SLEEP_IO);
+  light_sleep_args.wakeup_gpio_level = arg_intn(NULL, "io_level", "<0|1>", 0, 8, HELP_SLEEP_IO_LEVEL);
   light_sleep_args.end = arg_end(3);
+}
 
-  const esp_console_cmd_t cmd = {.command = "light_sleep",
-                                 .help = "Enter light sleep mode. "
-                                         "Two wakeup modes are supported: timer and GPIO. "
-                                         "Multiple GPIO pins can be specified using pairs of "
-                                         "'io' and 'io_level' arguments. "
-                                         "Will also wake up on UART input.",
-                                 .hint = NULL,
-                                 .func = &light_sleep,
-                                 .argtable = &light_sleep_args};
-  ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+void register_system_light_sleep(void)
+{
+  static const cli_lazy_command_t cmd = {.command = "light_sleep",
+                                         .help = HELP_LIGHT_SLEEP,
+                                         .hint = NULL,
+                                         .func = &light_sleep,
+                                         .argtable = &light_sleep_args,
+                                         .argtable_len = CLI_ARGTABLE_LEN(light_sleep_args),
+                                         .build = build_light_sleep_args};
+  ESP_ERROR_CHECK(cli_register_lazy_command(&cmd));
 }
 #endif  // SOC_LIGHT_SLEEP_SUPPORTED
+
+/** 'sleepstats' command shows the measured sleeps and wake latencies */
+static struct
+{
+  struct arg_lit *clear;
+  struct arg_end *end;
+} sleepstats_args;
+
+static void print_causes(uint32_t causes)
+{
+  static const struct
+  {
+    esp_sleep_source_t source;
+    const char *name;
+  } names[] = {
+    {ESP_SLEEP_WAKEUP_EXT0, "ext0"},
+    {ESP_SLEEP_WAKEUP_EXT1, "ext1"},
+    {ESP_SLEEP_WAKEUP_TIMER, "timer"},
+    {ESP_SLEEP_WAKEUP_TOUCHPAD, "touch"},
+    {ESP_SLEEP_WAKEUP_ULP, "ulp"},
+    {ESP_SLEEP_WAKEUP_GPIO, "gpio"},
+    {ESP_SLEEP_WAKEUP_UART, "uart"},
+  };
+
+  printf("0x%04" PRIx32, causes);
+  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+  {
+    if (causes & (1UL << names[i].source))
+      printf(" %s", names[i].name);
+  }
+  printf("\n");
+}
+
+static int sleepstats(int argc, char **argv)
+{
+  int nerrors = arg_parse(argc, argv, (void **)&sleepstats_args);
+  if (nerrors != 0)
+  {
+    arg_print_errors(stderr, sleepstats_args.end, argv[0]);
+    return 1;
+  }
+
+  if (sleepstats_args.clear->count)
+  {
+    sleep_stats_clear();
+    printf("Sleep statistics cleared\n");
+    return 0;
+  }
+
+  sleep_stats_update_ready();
+
+  static const char *type_names[SLEEP_TYPES] = {"light", "deep"};
+  int64_t window = sleep_stats_now() - s_stats.since_us;
+  uint64_t slept = s_stats.slept_us[SLEEP_LIGHT] + s_stats.slept_us[SLEEP_DEEP];
+  printf("Window %.3f s, asleep %.3f s (%.2f%% residency)\n",
+         window / 1e6,
+         slept / 1e6,
+         window > 0 ? 100.0 * slept / window : 0.0);
+  for (int t = 0; t < SLEEP_TYPES; t++)
+    printf("  %-5s %5" PRIu32 " sleeps, %.3f s\n", type_names[t], s_stats.count[t], s_stats.slept_us[t] / 1e6);
+
+  if (s_stats.total == 0)
+    return 0;
+
+  printf("\n%6s %-5s %12s %12s %10s %10s  %s\n",
+         "#",
+         "type",
+         "request ms",
+         "slept ms",
+         "wake ms",
+         "ready ms",
+         "causes");
+  uint32_t n = s_stats.total < SLEEP_STATS_HISTORY ? s_stats.total : SLEEP_STATS_HISTORY;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    uint32_t seq = s_stats.total - 1 - i;
+    const sleep_record_t *rec = &s_stats.records[seq % SLEEP_STATS_HISTORY];
+    printf("%6" PRIu32 " %-5s %12.3f %12.3f ",
+           seq + 1,
+           type_names[rec->type],
+           rec->requested_us / 1e3,
+           rec->slept_us / 1e3);
+    if (rec->first_us)
+      printf("%10.3f ", rec->first_us / 1e3);
+    else
+      printf("%10s ", "-");
+    if (rec->ready_us)
+      printf("%10.3f  ", rec->ready_us / 1e3);
+    else
+      printf("%10s  ", "-");
+    print_causes(rec->causes);
+  }
+  return 0;
+}
+
+static void build_sleepstats_args(void)
+{
+  sleepstats_args.clear = arg_lit0(NULL, "clear", HELP_SLEEPSTATS_CLEAR);
+  sleepstats_args.end = arg_end(1);
+}
+
+void register_system_sleepstats(void)
+{
+  sleep_stats_init();
+
+  static const cli_lazy_command_t cmd = {.command = "sleepstats",
+                                         .help = HELP_SLEEPSTATS,
+                                         .hint = NULL,
+                                         .func = &sleepstats,
+                                         .argtable = &sleepstats_args,
+                                         .argtable_len = CLI_ARGTABLE_LEN(sleepstats_args),
+                                         .build = build_sleepstats_args};
+  ESP_ERROR_CHECK(cli_register_lazy_command(&cmd));
+}
@@ -18,6 +18,7 @@
 #include <string.h>
 
 #include "argtable3/argtable3.h"
+#include "cli-api.h"
 #include "esp_console.h"
 #include "esp_event.h"
 #include "esp_log.h"
@@ -25,6 +26,7 @@
 #include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "help_text.h"
 
 #define JOIN_TIMEOUT_MS (10000)
 
@@ -42,6 +44,16 @@ static void event_handler(void *arg, esp_event_base_t event_base, int32_t event_
   {
     xEventGroupSetBits(wifi_event_group, CONNECTED_BIT);
   }
+  cli_prompt_invalidate("wifi");
+}
+
+/** {wifi} prompt token: "off" until the driver is started, then "up" with an IP address or "down" */
+static void prompt_wifi(char *buf, size_t size, void *arg)
+{
+  const char *state = "off";
+  if (wifi_event_group != NULL)
+    state = (xEventGroupGetBits(wifi_event_group) & CONNECTED_BIT) ? "up" : "down";
+  strlcpy(buf, state, size);
 }
 
 static void initialise_wifi(void)
@@ -66,7 +78,15 @@ static void initialise_wifi(void)
   ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
   ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_NULL));
   ESP_ERROR_CHECK(esp_wifi_start());
+#if CONFIG_CONSOLE_TCP_SERVER
+  /* telnet <ip> once joined: extra consoles without a serial port, and without authentication */
+  if (cli_tcp_start(CONFIG_CONSOLE_TCP_PORT) != ESP_OK)
+  {
+    ESP_LOGW(__func__, "TCP console not available");
+  }
+#endif
   initialized = true;
+  cli_prompt_invalidate("wifi");
 }
 
 static bool wifi_join(const char *ssid, const char *pass, int timeout_ms)
@@ -122,18 +142,25 @@ static int connect(int argc, char **argv)
   return 0;
 }
 
-void register_wifi(void)
+static void build_join_args(void)
 {
-  join_args.timeout = arg_int0(NULL, "timeout", "<t>", "Connection timeout, ms");
-  join_args.ssid = arg_str1(NULL, NULL, "<ssid>", "SSID of AP");
-  join_args.password = arg_str0(NULL, NULL, "<pass>", "PSK of AP");
+  join_args.timeout = arg_int0(NULL, "timeout", "<t>", HELP_JOIN_TIMEOUT);
+  join_args.ssid = arg_str1(NULL, NULL, "<ssid>", HELP_JOIN_SSID);
+  join_args.password = arg_str0(NULL, NULL, "<pass>", HELP_JOIN_PASSWORD);
   join_args.end = arg_end(2);
+}
+
+void register_wifi(void)
+{
+  cli_prompt_register_token("wifi", 0, prompt_wifi, NULL);
 
-  const esp_console_cmd_t join_cmd = {.command = "join",
-                                      .help = "Join WiFi AP as a station",
-                                      .hint = NULL,
-                                      .func = &connect,
-                                      .argtable = &join_args};
+  static const cli_lazy_command_t join_cmd = {.command = "join",
+                                              .help = HELP_JOIN,
+                                              .hint = NULL,
+                                              .func = &connect,
+                                              .argtable = &join_args,
+                                              .argtable_len = CLI_ARGTABLE_LEN(join_args),
+                                              .build = build_join_args};
 
-  ESP_ERROR_CHECK(esp_console_cmd_register(&join_cmd));
+  ESP_ERROR_CHECK(cli_register_lazy_command(&join_cmd));
 }
@@ -27,10 +27,15 @@
 #include "soc/soc_caps.h"
 
 /* Component commands */
+#include "cmd_fs.h"
+#include "cmd_gpio.h"
 #include "cmd_nvs.h"
 #include "cmd_system.h"
 #include "cmd_wifi.h"
 
+/* Help text references, generated from help.txt at build time */
+#include "help_text.h"
+
 /* GPIO driver for the gpio command example */
 #include "driver/gpio.h"
 
@@ -83,7 +88,7 @@ static int cmd_echo(cli_context_t *ctx)
 
 static const cli_command_t echo_cmd = {
   .name = "echo",
-  .description = "Repeats a message N times",
+  .description = HELP_ECHO,
   .hint = NULL,
   .callback = cmd_echo,
   .args =
@@ -91,19 +96,19 @@ static const cli_command_t echo_cmd = {
       {.short_opt = "m",
        .long_opt = "msg",
        .datatype = "<text>",
-       .description = "Message to be displayed",
+       .description = HELP_ECHO_MSG,
        .type = CLI_ARG_TYPE_STRING,
        .required = true},
       {.short_opt = "n",
        .long_opt = "repeat",
        .datatype = "<N>",
-       .description = "Number of repetitions (default: 1)",
+       .description = HELP_ECHO_REPEAT,
        .type = CLI_ARG_TYPE_INT,
        .required = false},
       {.short_opt = "u",
        .long_opt = "uppercase",
        .datatype = NULL,
-       .description = "Converts to uppercase",
+       .description = HELP_ECHO_UPPER,
        .type = CLI_ARG_TYPE_FLAG,
        .required = false},
     },
@@ -150,7 +155,7 @@ static int cmd_calc(cli_context_t *ctx)
 
 static const cli_command_t calc_cmd = {
   .name = "calc",
-  .description = "Simple calculator (addition, subtraction, multiplication, division)",
+  .description = HELP_CALC,
   .hint = NULL,
   .callback = cmd_calc,
   .args =
@@ -158,19 +163,19 @@ static const cli_command_t calc_cmd = {
       {.short_opt = "a",
        .long_opt = NULL,
        .datatype = "<num>",
-       .description = "First number",
+       .description = HELP_CALC_A,
        .type = CLI_ARG_TYPE_INT,
        .required = true},
       {.short_opt = "b",
        .long_opt = NULL,
        .datatype = "<num>",
-       .description = "Second number",
+       .description = HELP_CALC_B,
        .type = CLI_ARG_TYPE_INT,
        .required = true},
       {.short_opt = "v",
        .long_opt = "verbose",
        .datatype = NULL,
-       .description = "Shows all operations",
+       .description = HELP_CALC_VERBOSE,
        .type = CLI_ARG_TYPE_FLAG,
        .required = false},
     },
@@ -181,23 +186,11 @@ static const cli_command_t calc_cmd = {
 /*                    EXAMPLE 3: GPIO (complex, 6 arguments)                  */
 /* ========================================================================== */
 
-/**
- * @brief Structure to store current GPIO configuration
- */
-typedef struct
-{
-  int pin;
-  gpio_mode_t mode;
-  gpio_pull_mode_t pull;
-  int level;
-  bool configured;
-} gpio_config_state_t;
-
-static gpio_config_state_t s_gpio_states[GPIO_NUM_MAX] = {0};
-
 /**
  * @brief Configure a GPIO pin with mode, pull, level, info and NVS save options.
  *
+ * The configuration is recorded in cmd_gpio, so -s (or "gpio_profile save") stores it in the boot profile.
+ *
  * Usage: gpio --pin <0-48> --mode <in|out|od> [--pull <up|down|none>] [--level <0|1>] [-i] [-s]
  */
 static int cmd_gpio(cli_context_t *ctx)
@@ -290,9 +283,9 @@ static int cmd_gpio(cli_context_t *ctx)
   /* ========== Determine level to use ========== */
   if (!level_specified)
   {
-    if (s_gpio_states[pin].configured)
-      level = s_gpio_states[pin].level;
-    else
+    gpio_mode_t prev_mode;
+    gpio_pull_mode_t prev_pull;
+    if (!gpio_state_get(pin, &prev_mode, &prev_pull, &level))
       level = 0;
   }
 
@@ -331,12 +324,8 @@ static int cmd_gpio(cli_context_t *ctx)
     gpio_set_level(pin, level);
   }
 
-  /* Save state */
-  s_gpio_states[pin].pin = pin;
-  s_gpio_states[pin].mode = gpio_mode;
-  s_gpio_states[pin].pull = pull_mode;
-  s_gpio_states[pin].level = level;
-  s_gpio_states[pin].configured = true;
+  /* Record state for gpio profiles */
+  gpio_state_record(pin, gpio_mode, pull_mode, level);
 
   /* Display result */
   const char *mode_names[] = {"DISABLE", "INPUT", "OUTPUT", "OUTPUT_OD", "INPUT_OUTPUT", "", "INPUT_OUTPUT_OD"};
@@ -361,6 +350,13 @@ static int cmd_gpio(cli_context_t *ctx)
     printf("|    Max GPIOs:     %d                    |\n", GPIO_NUM_MAX);
   }
 
+  /* ========== Save to the boot profile ========== */
+  if (save_nvs)
+  {
+    esp_err_t err = gpio_profile_save(GPIO_PROFILE_BOOT);
+    printf("|  Profile:   %-27s |\n", (err == ESP_OK) ? "saved (" GPIO_PROFILE_BOOT ")" : esp_err_to_name(err));
+  }
+
   printf("+-----------------------------------------+\n\n");
 
   return 0;
@@ -368,7 +364,7 @@ static int cmd_gpio(cli_context_t *ctx)
 
 static const cli_command_t gpio_cmd = {
   .name = "gpio",
-  .description = "Configure a GPIO (mode, pull, level)",
+  .description = HELP_GPIO,
   .hint = NULL,
   .callback = cmd_gpio,
   .args =
@@ -377,7 +373,7 @@ static const cli_command_t gpio_cmd = {
         .short_opt = "p",
         .long_opt = "pin",
         .datatype = "<0-48>",
-        .description = "GPIO number",
+        .description = HELP_GPIO_PIN,
         .type = CLI_ARG_TYPE_INT,
         .required = true,
       },
@@ -385,7 +381,7 @@ static const cli_command_t gpio_cmd = {
         .short_opt = "m",
         .long_opt = "mode",
         .datatype = "<in|out|od>",
-        .description = "Mode: in, out, od, inout, inout_od",
+        .description = HELP_GPIO_MODE,
         .type = CLI_ARG_TYPE_STRING,
         .required = true,
       },
@@ -393,7 +389,7 @@ static const cli_command_t gpio_cmd = {
         .short_opt = NULL,
         .long_opt = "pull",
         .datatype = "<up|down|none>",
-        .description = "Resistor pull: up, down, both, none",
+        .description = HELP_GPIO_PULL,
         .type = CLI_ARG_TYPE_STRING,
         .required = false,
       },
@@ -401,7 +397,7 @@ static const cli_command_t gpio_cmd = {
         .short_opt = "l",
         .long_opt = "level",
         .datatype = "<0|1>",
-        .description = "Initial level (for output)",
+        .description = HELP_GPIO_LEVEL,
         .type = CLI_ARG_TYPE_INT,
         .required = false,
       },
@@ -409,23 +405,38 @@ static const cli_command_t gpio_cmd = {
         .short_opt = "i",
         .long_opt = "info",
         .datatype = NULL,
-        .description = "Show extra GPIO information",
+        .description = HELP_GPIO_INFO,
+        .type = CLI_ARG_TYPE_FLAG,
+        .required = false,
+      },
+      {
+        .short_opt = "s",
+        .long_opt = "save",
+        .datatype = NULL,
+        .description = HELP_GPIO_SAVE,
         .type = CLI_ARG_TYPE_FLAG,
         .required = false,
       },
     },
-  .arg_count = 5,
+  .arg_count = 6,
 };
 
 /* ========================================================================== */
 /*                                 MAIN                                       */
 /* ========================================================================== */
 
+/* Status tokens are expanded before every prompt from cached providers (cli_prompt_register_token()) */
+#if (CONFIG_ESP_WIFI_ENABLED || CONFIG_ESP_HOST_WIFI_ENABLED)
+#define EXAMPLE_PROMPT CONFIG_IDF_TARGET " {heap} wifi:{wifi} nvs:{ns} rc:{rc}> "
+#else
+#define EXAMPLE_PROMPT CONFIG_IDF_TARGET " {heap} nvs:{ns} rc:{rc}> "
+#endif
+
 void app_main(void)
 {
   /* Configure and initialize the CLI */
   cli_config_t cli_cfg = {
-    .prompt = CONFIG_IDF_TARGET "> ",
+    .prompt = EXAMPLE_PROMPT,
     .banner = "\n"
               "=== ESP32 CLI-API Advanced Example ===\n"
               "Type 'help' to get the list of commands.\n"
@@ -441,10 +452,23 @@ void app_main(void)
               "=======================================",
     .register_help = true,
     .store_history = true,
+    .enable_scheduler = true,
+    .enable_audit = true,
+    .enable_compress = true,
+    .enable_time = true,
+    .enable_metrics = true,
+    .enable_profiler = true,
+    .enable_trace = true,
+    .enable_diff_redraw = true,
+    .enable_record = true,
+    .lazy_argtables = true,
   };
 
   ESP_ERROR_CHECK(cli_init(&cli_cfg));
 
+  /* Bring pins back to the saved "boot" GPIO profile before the prompt appears */
+  gpio_profile_restore_boot();
+
   /* Register system commands (free, heap, version, restart, sleep) */
   register_system_common();
 #if SOC_LIGHT_SLEEP_SUPPORTED
@@ -453,6 +477,15 @@ void app_main(void)
 #if SOC_DEEP_SLEEP_SUPPORTED
   register_system_deep_sleep();
 #endif
+#if SOC_LIGHT_SLEEP_SUPPORTED || SOC_DEEP_SLEEP_SUPPORTED
+  register_system_sleepstats();
+#endif
+
+  /* Register memory inspection commands (mem_read, mem_write, mem_fill) */
+  register_system_mem();
+
+  /* Register partition commands (part_list, part_hash) */
+  register_system_part();
 
   /* Register WiFi commands (join, scan, disconnect) */
 #if (CONFIG_ESP_WIFI_ENABLED || CONFIG_ESP_HOST_WIFI_ENABLED)
@@ -462,6 +495,15 @@ void app_main(void)
   /* Register NVS commands (get, set, erase) */
   register_nvs();
 
+  /* Register file commands for the history volume (ls, cat, rm, mv, df, hexdump, fsbench, rx, tx) */
+  register_fs();
+
+  /* Register GPIO bus commands (gpio_write, gpio_read, gpio_config, gpio_profile) */
+  register_gpio();
+
+  /* Descriptions of the example commands live in the generated help table */
+  ESP_ERROR_CHECK(cli_help_set_table(&help_text));
+
   /* Register CLI-API example commands using batch registration */
   const cli_command_t *cmds[] = {&echo_cmd, &calc_cmd, &gpio_cmd};
   for (size_t i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++)
@@ -6,14 +6,17 @@ import pytest
 from pytest_embedded import Dut
 from pytest_embedded_idf.utils import idf_parametrize
 
+# "<target> {heap} wifi:{wifi} nvs:{ns} rc:{rc}> " once the tokens are expanded
+PROMPT = r'{target} [^\r\n]*> '
+
 
 @pytest.mark.generic
 @idf_parametrize('target', ['esp32', 'esp32c3'], indirect=['target'])
 def test_console_advanced(dut: Dut) -> None:
     sleep(2)  # Some time for the OS to enumerate our USB device
 
-    # Wait until the console prompt appears
-    dut.expect(dut.target + '> ')
+    # Wait until the console prompt appears (status tokens follow the target name)
+    dut.expect(PROMPT.format(target=dut.target))
 
     # Write CLI command "version"
     dut.write('version')
@@ -22,3 +25,34 @@ def test_console_advanced(dut: Dut) -> None:
     # Check if following strings are present in the "version" command output
     dut.expect('IDF Version')
     dut.expect('Chip info')
+
+
+# A DRAM address that is mapped on each target, read by mem_read
+DRAM_ADDR = {'esp32': '0x3ffb0000', 'esp32c3': '0x3fc80000'}
+
+
+def run_mem_commands(dut: Dut) -> None:
+    dut.expect(PROMPT.format(target=dut.target))
+
+    dram_addr = DRAM_ADDR[dut.target]
+    dut.write(f'mem_read {dram_addr} 16')
+    dut.expect(dram_addr[2:] + '  ')
+
+    # Address 0 is outside every known region
+    dut.write('mem_write 0x0 0x1')
+    dut.expect('not inside a single known memory region')
+
+
+@pytest.mark.generic
+@idf_parametrize('target', ['esp32', 'esp32c3'], indirect=['target'])
+def test_console_advanced_mem(dut: Dut) -> None:
+    sleep(2)
+    run_mem_commands(dut)
+
+
+# The memory commands only touch CPU-mapped memory, which QEMU emulates on these targets
+@pytest.mark.host_test
+@pytest.mark.qemu
+@idf_parametrize('target', ['esp32', 'esp32c3'], indirect=['target'])
+def test_console_advanced_mem_qemu(dut: Dut) -> None:
+    run_mem_commands(dut)
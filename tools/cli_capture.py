@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""Run the advanced example's `gpio_capture` in RLE mode and save the result as a VCD file.
+
+    cli_capture.py -p /dev/ttyUSB0 -o bus.vcd -- -m 0xff0 -r 1000000 -n 50000
+    cli_capture.py -i capture.bin -o bus.vcd      # decode a raw console capture instead
+
+Open the .vcd in GTKWave, PulseView or any other waveform viewer. Close any serial monitor before running it.
+
+RLE stream, same as cmd_gpio_capture.c: a text line
+
+    GPIOCAP RLE <rate> <first_pin> <bits> <width> <bytes>
+
+then <bytes> of runs, each the sample value (<width> bytes, little endian) followed by the run length as LEB128.
+"""
+
+import argparse
+import sys
+import time
+
+HEADER = b'GPIOCAP RLE '
+TIMEOUT = 10.0
+
+
+def decode_runs(data, width):
+    """Yield (value, run_length) pairs."""
+    i = 0
+    while i < len(data):
+        value = int.from_bytes(data[i:i + width], 'little')
+        i += width
+        run = shift = 0
+        while True:
+            b = data[i]
+            i += 1
+            run |= (b & 0x7F) << shift
+            shift += 7
+            if b < 0x80:
+                break
+        yield value, run
+
+
+def write_vcd(out, rate, first_pin, bits, width, data):
+    """Same output as capture_vcd() on the device."""
+    pins = [bit for bit in range(32) if bits & (1 << bit)]
+    out.write('$timescale 1 ns $end\n$scope module gpio $end\n')
+    for bit in pins:
+        out.write(f'$var wire 1 {chr(33 + bit)} gpio{first_pin + bit} $end\n')
+    out.write('$upscope $end\n$enddefinitions $end\n')
+
+    sample = 0
+    prev = None
+    for value, run in decode_runs(data, width):
+        changed = bits if prev is None else (value ^ prev) & bits
+        if changed:
+            out.write(f'#{sample * 1000000000 // rate}\n')
+            for bit in pins:
+                if changed & (1 << bit):
+                    out.write(f'{(value >> bit) & 1}{chr(33 + bit)}\n')
+            prev = value
+        sample += run
+    out.write(f'#{sample * 1000000000 // rate}\n')
+    return sample
+
+
+def parse_capture(buf):
+    """Find the header in console output; return (fields, payload) or None if incomplete."""
+    start = buf.find(HEADER)
+    if start < 0:
+        return None
+    eol = buf.find(b'\n', start)
+    if eol < 0:
+        return None
+    rate, first_pin, bits, width, size = (int(x) for x in buf[start + len(HEADER):eol].split())
+    payload = buf[eol + 1:eol + 1 + size]
+    if len(payload) < size:
+        return None
+    return (rate, first_pin, bits, width), payload
+
+
+def capture_serial(port_name, baud, args):
+    import serial  # pyserial
+
+    with serial.Serial(port_name, baud, timeout=0.1) as port:
+        port.write(('gpio_capture -f rle ' + ' '.join(args) + '\r').encode())
+        buf = bytearray()
+        deadline = time.monotonic() + TIMEOUT
+        while time.monotonic() < deadline:
+            buf += port.read(4096)
+            result = parse_capture(bytes(buf))
+            if result is not None:
+                return result
+            if b'ERROR' in buf:
+                line = buf[buf.find(b'ERROR'):].split(b'\n')[0]
+                sys.exit(line.decode(errors='replace').strip())
+    sys.exit('timeout waiting for the capture')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-p', '--port', help='serial port of the console')
+    parser.add_argument('-b', '--baud', type=int, default=115200)
+    parser.add_argument('-i', '--input', help='raw console capture to decode instead of a port')
+    parser.add_argument('-o', '--output', required=True, help='VCD file to write')
+    parser.add_argument('capture_args', nargs=argparse.REMAINDER, help='gpio_capture arguments, after --')
+    args = parser.parse_args()
+
+    if args.input:
+        with open(args.input, 'rb') as f:
+            result = parse_capture(f.read())
+        if result is None:
+            sys.exit('no complete GPIOCAP RLE capture in the input')
+    elif args.port:
+        result = capture_serial(args.port, args.baud, [a for a in args.capture_args if a != '--'])
+    else:
+        parser.error('give --port or --input')
+
+    (rate, first_pin, bits, width), payload = result
+    with open(args.output, 'w') as out:
+        samples = write_vcd(out, rate, first_pin, bits, width, payload)
+    sys.stderr.write(f'{samples} samples at {rate} Hz ({len(payload)} bytes RLE) -> {args.output}\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""Generate an interned, compressed help text table for cli_help_set_table().
+
+    cli_helpgen.py help.txt -o build/help_text                 # writes build/help_text.c and .h
+    cli_helpgen.py a.txt b.txt -o help_text --symbol app_help
+    cli_helpgen.py help.txt -o help_text --no-compress --block 2048
+
+Input: one entry per line, `NAME text`. NAME is a C identifier; the text runs to the end of the line and accepts
+C escapes (\\n, \\t, \\\\, \\"). Indented lines continue the previous entry, joined with a space. Blank lines and lines
+starting with # are ignored.
+
+The header defines each NAME as a reference (`CLI_HELP_REF_MARK "index"`, 3 to 6 bytes of rodata) to use as a
+command or argument description, and declares the table. Entries with the same text share one string. The strings
+are packed whole into blocks of up to --block bytes, and each block is LZSS-compressed in the format of the
+'compress' command (kept as is if that does not make it smaller), so 'help <command>' only decompresses the blocks
+it prints. Sizes are reported on stderr.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+NAME = re.compile(r'[A-Za-z_][A-Za-z0-9_]*$')
+ESCAPES = {'n': '\n', 't': '\t', '\\': '\\', '"': '"', "'": "'", 'r': '\r'}
+WINDOW = 4096
+MIN_MATCH = 3
+MAX_MATCH = 18
+MAX_CHAIN = 256
+MAX_BLOCKS = 64
+
+
+def unescape(text, where):
+    out = []
+    i = 0
+    while i < len(text):
+        c = text[i]
+        if c == '\\':
+            if i + 1 >= len(text) or text[i + 1] not in ESCAPES:
+                sys.exit(f'{where}: unknown escape in {text!r}')
+            out.append(ESCAPES[text[i + 1]])
+            i += 2
+        else:
+            out.append(c)
+            i += 1
+    return ''.join(out)
+
+
+def parse(paths):
+    """Return [(name, text)] in file order."""
+    entries = []
+    names = set()
+    for path in paths:
+        with open(path, encoding='utf-8') as f:
+            for number, line in enumerate(f, 1):
+                line = line.rstrip('\n')
+                where = f'{path}:{number}'
+                if not line.strip() or line.lstrip().startswith('#'):
+                    continue
+                if line[0] in ' \t':
+                    if not entries:
+                        sys.exit(f'{where}: continuation line without an entry')
+                    name, text = entries[-1]
+                    entries[-1] = (name, text + ' ' + unescape(line.strip(), where))
+                    continue
+                name, _, text = line.partition(' ')
+                if not NAME.match(name):
+                    sys.exit(f'{where}: {name!r} is not a C identifier')
+                if name in names:
+                    sys.exit(f'{where}: {name} defined twice')
+                names.add(name)
+                entries.append((name, unescape(text.strip(), where)))
+    if not entries:
+        sys.exit('no entries')
+    return entries
+
+
+def lzss_compress(data):
+    """Greedy LZSS, same format as cli-compress.c: flag byte per 8 items (1 = literal), matches are
+    offset - 1 (12 bits) and length - 3 (4 bits)."""
+    out = bytearray()
+    chains = {}
+    i = 0
+    flag_pos = 0
+    bit = 8
+    while i < len(data):
+        if bit == 8:
+            flag_pos = len(out)
+            out.append(0)
+            bit = 0
+        best_len = best_off = 0
+        if i + MIN_MATCH <= len(data):
+            limit = min(MAX_MATCH, len(data) - i)
+            for p in reversed(chains.get(data[i:i + MIN_MATCH], [])[-MAX_CHAIN:]):
+                if i - p > WINDOW:
+                    break
+                length = 0
+                while length < limit and data[p + length] == data[i + length]:
+                    length += 1
+                if length > best_len:
+                    best_len, best_off = length, i - p
+                    if length == limit:
+                        break
+        step = best_len if best_len >= MIN_MATCH else 1
+        if best_len >= MIN_MATCH:
+            out.append((best_off - 1) & 0xFF)
+            out.append(((best_off - 1) >> 8) << 4 | (best_len - MIN_MATCH))
+        else:
+            out[flag_pos] |= 1 << bit
+            out.append(data[i])
+        for k in range(i, i + step):
+            if k + MIN_MATCH <= len(data):
+                chains.setdefault(data[k:k + MIN_MATCH], []).append(k)
+        i += step
+        bit += 1
+    return bytes(out)
+
+
+def lzss_decompress(data, raw_len):
+    out = bytearray()
+    i = 0
+    while i < len(data) and len(out) < raw_len:
+        flags = data[i]
+        i += 1
+        for bit in range(8):
+            if i >= len(data) or len(out) >= raw_len:
+                break
+            if flags & (1 << bit):
+                out.append(data[i])
+                i += 1
+            else:
+                offset = (data[i] | (data[i + 1] >> 4) << 8) + 1
+                length = (data[i + 1] & 0x0F) + 3
+                i += 2
+                for _ in range(length):
+                    out.append(out[-offset])
+    return bytes(out)
+
+
+def pack(strings, block_size, compress):
+    """Return (data, block_pos, block_raw, str_raw)."""
+    blocks = [bytearray()]
+    str_raw = []
+    raw = 0
+    for s in strings:
+        b = s.encode('utf-8') + b'\0'
+        if len(b) > WINDOW:
+            sys.exit(f'text longer than {WINDOW - 1} bytes: {s[:40]!r}...')
+        if blocks[-1] and len(blocks[-1]) + len(b) > block_size:
+            blocks.append(bytearray())
+        str_raw.append(raw)
+        blocks[-1] += b
+        raw += len(b)
+    if len(blocks) > MAX_BLOCKS:
+        sys.exit(f'{len(blocks)} blocks, at most {MAX_BLOCKS}: raise --block')
+
+    data = bytearray()
+    block_pos = [0]
+    block_raw = [0]
+    for block in blocks:
+        stored = bytes(block)
+        if compress:
+            packed = lzss_compress(stored)
+            if len(packed) < len(stored):
+                assert lzss_decompress(packed, len(stored)) == stored
+                stored = packed
+        data += stored
+        block_pos.append(len(data))
+        block_raw.append(block_raw[-1] + len(block))
+    return bytes(data), block_pos, block_raw, str_raw
+
+
+def c_array(values, per_line, fmt):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('  ' + ', '.join(fmt.format(v) for v in values[i:i + per_line]) + ',')
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('inputs', nargs='+', help='help text files')
+    parser.add_argument('-o', '--output', required=True, help='output path without extension (.c and .h written)')
+    parser.add_argument('--symbol', help='table variable name (default: output file name)')
+    parser.add_argument('--block', type=int, default=1024, help='uncompressed bytes per block (default 1024)')
+    parser.add_argument('--no-compress', action='store_true', help='store the blocks uncompressed (interning only)')
+    args = parser.parse_args()
+
+    if not MIN_MATCH < args.block <= WINDOW:
+        parser.error(f'--block must be at most {WINDOW}')
+    base = os.path.basename(args.output)
+    symbol = args.symbol or re.sub(r'\W', '_', base)
+
+    entries = parse(args.inputs)
+    strings = []
+    ids = {}
+    for _, text in entries:
+        if text not in ids:
+            ids[text] = len(strings)
+            strings.append(text)
+    data, block_pos, block_raw, str_raw = pack(strings, args.block, not args.no_compress)
+
+    guard = re.sub(r'\W', '_', base).upper() + '_H'
+    with open(args.output + '.h', 'w') as f:
+        f.write(f'/* Generated by tools/cli_helpgen.py from {", ".join(os.path.basename(p) for p in args.inputs)}. '
+                'Do not edit. */\n\n')
+        f.write(f'#ifndef {guard}\n#define {guard}\n\n#include "cli-api.h"\n\n')
+        width = max(len(name) for name, _ in entries)
+        for name, text in entries:
+            f.write(f'#define {name:<{width}} CLI_HELP_REF_MARK "{ids[text]}"\n')
+        f.write(f'\nextern const cli_help_table_t {symbol};\n\n#endif /* {guard} */\n')
+
+    with open(args.output + '.c', 'w') as f:
+        f.write(f'/* Generated by tools/cli_helpgen.py. Do not edit. */\n\n#include "{base}.h"\n\n')
+        f.write(f'static const uint8_t s_data[{len(data)}] = {{\n{c_array(data, 16, "0x{:02x}")}\n}};\n\n')
+        f.write(f'static const uint32_t s_block_pos[] = {{\n{c_array(block_pos, 8, "{}")}\n}};\n\n')
+        f.write(f'static const uint32_t s_block_raw[] = {{\n{c_array(block_raw, 8, "{}")}\n}};\n\n')
+        f.write(f'static const uint32_t s_str_raw[] = {{\n{c_array(str_raw, 8, "{}")}\n}};\n\n')
+        f.write(f'const cli_help_table_t {symbol} = {{\n'
+                '  .data = s_data,\n'
+                '  .block_pos = s_block_pos,\n'
+                '  .block_raw = s_block_raw,\n'
+                '  .str_raw = s_str_raw,\n'
+                f'  .block_count = {len(block_pos) - 1},\n'
+                f'  .str_count = {len(strings)},\n'
+                '};\n')
+
+    text_bytes = sum(len(t.encode('utf-8')) + 1 for _, t in entries)
+    tables = 4 * (len(block_pos) + len(block_raw) + len(str_raw))
+    sys.stderr.write(f'{symbol}: {len(entries)} texts, {text_bytes} bytes; {len(strings)} distinct, '
+                     f'{block_raw[-1]} bytes; stored {len(data)} bytes in {len(block_pos) - 1} blocks '
+                     f'+ {tables} bytes of offsets\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""Decoder for the output of the cli-api `compress <command>` prefix.
+
+Plain console text passes through unchanged; compressed frames are replaced by their decompressed content.
+
+    cli_lz.py -p /dev/ttyUSB0          # terminal: type commands, e.g. "compress cat history.txt"
+    cli_lz.py capture.bin > out.txt    # decode a raw capture of the console
+
+Frame layout (little endian), same as cli-compress.c:
+
+    ESC 'Z' | type | raw_len (2) | data_len (2) | data | crc32 of the raw bytes (4)
+
+type 'B' = LZSS block, 'R' = stored block, 'E' = end of stream.
+"""
+
+import argparse
+import struct
+import sys
+import threading
+import zlib
+
+MAGIC = b'\x1bZ'
+HEADER = struct.Struct('<2sBHH')
+CRC_SIZE = 4
+MAX_BLOCK = 4096
+MAX_DATA = MAX_BLOCK + (MAX_BLOCK + 7) // 8
+
+
+def lzss_decompress(data, raw_len):
+    out = bytearray()
+    i = 0
+    while i < len(data) and len(out) < raw_len:
+        flags = data[i]
+        i += 1
+        for bit in range(8):
+            if i >= len(data) or len(out) >= raw_len:
+                break
+            if flags & (1 << bit):
+                out.append(data[i])
+                i += 1
+            else:
+                b0, b1 = data[i], data[i + 1]
+                i += 2
+                offset = (b0 | (b1 >> 4) << 8) + 1
+                length = (b1 & 0x0F) + 3
+                for _ in range(length):
+                    out.append(out[-offset])
+    return bytes(out)
+
+
+class Decoder:
+    """Incremental decoder: feed() console bytes, get back displayable bytes."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.raw = 0
+        self.wire = 0
+
+    def feed(self, data):
+        self.buf += data
+        out = bytearray()
+        while True:
+            start = self.buf.find(MAGIC)
+            if start < 0:
+                # Keep a trailing ESC, it may be the start of a frame split across reads
+                keep = 1 if self.buf.endswith(b'\x1b') else 0
+                out += self.buf[:len(self.buf) - keep]
+                del self.buf[:len(self.buf) - keep]
+                return bytes(out)
+            out += self.buf[:start]
+            del self.buf[:start]
+            if len(self.buf) < HEADER.size:
+                return bytes(out)
+            _, frame_type, raw_len, data_len = HEADER.unpack_from(self.buf)
+            if frame_type not in b'BRE' or raw_len > MAX_BLOCK or data_len > MAX_DATA:
+                out += self.buf[:1]
+                del self.buf[:1]
+                continue
+            total = HEADER.size + data_len + CRC_SIZE
+            if len(self.buf) < total:
+                return bytes(out)
+            data = bytes(self.buf[HEADER.size:HEADER.size + data_len])
+            (crc,) = struct.unpack_from('<I', self.buf, HEADER.size + data_len)
+            raw = lzss_decompress(data, raw_len) if frame_type == ord('B') else data
+            if frame_type != ord('E') and (len(raw) != raw_len or zlib.crc32(raw) != crc):
+                # Not a valid frame after all: show the bytes as they are
+                out += self.buf[:1]
+                del self.buf[:1]
+                continue
+            del self.buf[:total]
+            out += raw
+            self.raw += raw_len
+            self.wire += total
+            if frame_type == ord('E'):
+                ratio = self.raw / self.wire if self.wire else 0
+                sys.stderr.write(f'[compress: {self.raw} bytes in {self.wire} ({ratio:.1f}x)]\n')
+                self.raw = self.wire = 0
+
+
+def terminal(port_name, baud):
+    import serial  # pyserial
+
+    decoder = Decoder()
+    with serial.Serial(port_name, baud, timeout=0.1) as port:
+
+        def reader():
+            while True:
+                data = port.read(4096)
+                if data:
+                    sys.stdout.buffer.write(decoder.feed(data))
+                    sys.stdout.buffer.flush()
+
+        threading.Thread(target=reader, daemon=True).start()
+        try:
+            for line in sys.stdin:
+                port.write(line.rstrip('\n').encode() + b'\r')
+        except KeyboardInterrupt:
+            pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('capture', nargs='?', help='raw console capture to decode')
+    parser.add_argument('-p', '--port', help='serial port: run as a line-mode terminal')
+    parser.add_argument('-b', '--baud', type=int, default=115200)
+    args = parser.parse_args()
+
+    if args.port:
+        terminal(args.port, args.baud)
+    elif args.capture:
+        with open(args.capture, 'rb') as f:
+            sys.stdout.buffer.write(Decoder().feed(f.read()))
+    else:
+        parser.error('give a capture file or --port')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""Run the console's `profile` command and add up its samples per function using the application ELF.
+
+    cli_profile.py -e build/app.elf -p /dev/ttyUSB0 -- --hz 5000 fsbench -s 256
+    cli_profile.py -e build/app.elf -i console.log      # symbolize a saved `profile --top 0` output instead
+
+Close any serial monitor before running it. The device only prints addresses; they are looked up in the symbol table
+of the ELF (`nm` of the ESP-IDF toolchain, picked from the ELF machine type unless --nm is given).
+"""
+
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+import time
+from collections import Counter
+
+SAMPLE = re.compile(rb'^\s*(\d+)\s+[\d.]+%\s+0x([0-9a-fA-F]+)\s*$')
+SUMMARY = re.compile(rb'^\s*(\d+) distinct addresses, (\d+) samples dropped')
+HEADER = re.compile(rb'^Profile: (\d+) Hz for (\d+) ms, (\d+) samples')
+TIMEOUT = 70.0
+
+NM_BY_MACHINE = {94: 'xtensa-esp-elf-nm', 243: 'riscv32-esp-elf-nm'}
+
+
+def default_nm(elf):
+    with open(elf, 'rb') as f:
+        ident = f.read(20)
+    if ident[:4] != b'\x7fELF':
+        sys.exit(f'{elf}: not an ELF file')
+    return NM_BY_MACHINE.get(int.from_bytes(ident[18:20], 'little'), 'nm')
+
+
+def load_symbols(elf, nm):
+    """Sorted list of (start, end, name) for every function in the ELF."""
+    out = subprocess.run([nm, '-S', '-C', '-n', '--defined-only', elf], check=True, capture_output=True, text=True)
+    symbols = []
+    for line in out.stdout.splitlines():
+        parts = line.split(maxsplit=3)
+        if len(parts) == 4 and parts[2] in 'tTwW':
+            start, size = int(parts[0], 16), int(parts[1], 16)
+            symbols.append((start, start + size, parts[3]))
+    return symbols
+
+
+def symbolize(symbols, pc):
+    i = bisect.bisect_right(symbols, (pc, float('inf'), '')) - 1
+    if i >= 0 and symbols[i][0] <= pc < symbols[i][1]:
+        return symbols[i][2]
+    return f'?? 0x{pc:08x}'
+
+
+def parse_profile(text):
+    """Return (header, {pc: samples}, dropped) from console output; header is None if there was no profile."""
+    header = None
+    samples = Counter()
+    dropped = 0
+    for line in text.splitlines():
+        m = HEADER.match(line)
+        if m:
+            header = tuple(int(x) for x in m.groups())
+            samples.clear()
+            continue
+        m = SAMPLE.match(line)
+        if m and header is not None:
+            samples[int(m.group(2), 16)] += int(m.group(1))
+            continue
+        m = SUMMARY.match(line)
+        if m:
+            dropped = int(m.group(2))
+    return header, samples, dropped
+
+
+def profile_serial(port_name, baud, args):
+    import serial  # pyserial
+
+    with serial.Serial(port_name, baud, timeout=0.1) as port:
+        port.write(('profile --top 0 ' + ' '.join(args) + '\r').encode())
+        buf = bytearray()
+        deadline = time.monotonic() + TIMEOUT
+        while time.monotonic() < deadline:
+            buf += port.read(4096)
+            if any(SUMMARY.match(line) for line in buf.splitlines()):
+                return bytes(buf)
+            if b'Usage: profile' in buf or b'ERROR' in buf:
+                sys.exit(buf.decode(errors='replace').strip())
+    sys.exit('timeout waiting for the profile')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-e', '--elf', required=True, help='application ELF the device runs')
+    parser.add_argument('-p', '--port', help='serial port of the console')
+    parser.add_argument('-b', '--baud', type=int, default=115200)
+    parser.add_argument('-i', '--input', help='saved console output to symbolize instead of a port')
+    parser.add_argument('-n', '--top', type=int, default=25, help='functions to list (default: 25, 0 = all)')
+    parser.add_argument('--nm', help='nm executable (default: from the ELF machine type)')
+    parser.add_argument('profile_args', nargs=argparse.REMAINDER, help='profile options and command, after --')
+    args = parser.parse_args()
+
+    if args.input:
+        with open(args.input, 'rb') as f:
+            text = f.read()
+    elif args.port:
+        text = profile_serial(args.port, args.baud, [a for a in args.profile_args if a != '--'])
+    else:
+        parser.error('give --port or --input')
+
+    header, samples, dropped = parse_profile(text)
+    if header is None:
+        sys.exit('no profile in the input')
+    hz, ms, total = header
+
+    symbols = load_symbols(args.elf, args.nm or default_nm(args.elf))
+    functions = Counter()
+    for pc, count in samples.items():
+        functions[symbolize(symbols, pc)] += count
+
+    busy = sum(functions.values())
+    print(f'{total} samples at {hz} Hz over {ms} ms, {busy} outside idle and interrupts, {dropped} dropped')
+    print(f'{"samples":>10} {"%busy":>7}  function')
+    for name, count in functions.most_common(args.top or None):
+        print(f'{count:10} {100.0 * count / busy:6.2f}%  {name}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""Replay a console recording (`record start` / `record stop`) against a device or a linux-target build.
+
+    cli_replay.py session.rec -p /dev/ttyUSB0                        # at the recorded pace
+    cli_replay.py session.rec -p /dev/ttyUSB0 --speed 4
+    cli_replay.py session.rec --max -e build/test_record_replay.elf  # linux target, under a pseudo-terminal
+    cli_replay.py session.rec --dump                                 # list the recorded input batches
+
+Fetch the recording from the device first, e.g. `cli_xfer.py -p PORT get session.rec`. Close any serial monitor
+before running it. The console output goes to stdout (or -o), the timing summary to stderr.
+
+Recording format (little endian), same as cli-record.c: `CLIREC1\\n`, then `delta_us (4) | len (2) | bytes (len)`
+per input batch.
+
+The tool also answers the terminal queries linenoise sends (device status, cursor position, with an 80 column
+terminal), so the console runs in its normal line editing mode instead of dumb mode. With --max the next line is sent
+once the output has been idle for --idle ms, so the device's UART receive buffer is never overrun.
+"""
+
+import argparse
+import os
+import re
+import select
+import shlex
+import struct
+import subprocess
+import sys
+import threading
+import time
+
+MAGIC = b'CLIREC1\n'
+CHUNK = struct.Struct('<IH')
+COLUMNS = 80
+RESPONSE_TIMEOUT = 10.0
+QUERY = re.compile(rb'\x1b\[(999C|5n|6n)')
+
+
+def load(path):
+    """Return [(delta_us, bytes)] of a recording."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if not data.startswith(MAGIC):
+        sys.exit(f'{path}: not a console recording')
+    chunks = []
+    pos = len(MAGIC)
+    while pos + CHUNK.size <= len(data):
+        delta_us, length = CHUNK.unpack_from(data, pos)
+        pos += CHUNK.size
+        chunks.append((delta_us, data[pos:pos + length]))
+        pos += length
+    return chunks
+
+
+class Terminal:
+    """Collects the console output, answers linenoise's queries and tracks when output was last seen."""
+
+    def __init__(self, write, out):
+        self.write = write
+        self.out = out
+        self.last_output = time.monotonic()
+        self.measuring = False
+        self.tail = b''
+        self.bytes = 0
+
+    def feed(self, data):
+        self.last_output = time.monotonic()
+        self.bytes += len(data)
+        self.out.write(data)
+        self.out.flush()
+        # Queries may be split across reads: keep a few bytes of context
+        text = self.tail + data
+        for m in QUERY.finditer(text):
+            if m.end() <= len(self.tail):
+                continue
+            query = m.group(1)
+            if query == b'999C':
+                self.measuring = True
+            elif query == b'5n':
+                self.write(b'\x1b[0n')
+            else:
+                self.write(b'\x1b[1;%dR' % (COLUMNS if self.measuring else 1))
+                self.measuring = False
+        self.tail = text[-5:]
+
+    def wait_idle(self, idle, since=None):
+        """Wait for output after `since` (if given, at most RESPONSE_TIMEOUT), then for `idle` s without any."""
+        deadline = time.monotonic() + RESPONSE_TIMEOUT
+        while since is not None and self.last_output <= since and time.monotonic() < deadline:
+            time.sleep(idle / 4)
+        while time.monotonic() - self.last_output < idle:
+            time.sleep(idle / 4)
+
+
+def open_serial(port_name, baud):
+    import serial  # pyserial
+
+    port = serial.Serial(port_name, baud, timeout=0.05)
+    return port.write, lambda: port.read(4096), port.close
+
+
+def open_process(argv):
+    import pty
+
+    master, slave = pty.openpty()
+    proc = subprocess.Popen(argv, stdin=slave, stdout=slave, stderr=slave, close_fds=True)
+    os.close(slave)
+
+    def read():
+        if not select.select([master], [], [], 0.05)[0]:
+            return b''
+        try:
+            return os.read(master, 4096)
+        except OSError:  # the process exited
+            time.sleep(0.05)
+            return b''
+
+    def close():
+        proc.terminate()
+        proc.wait()
+        os.close(master)
+
+    return lambda data: os.write(master, data), read, close
+
+
+def replay(chunks, term, speed, idle):
+    """Send the batches; returns the time from the first byte to the end of the output."""
+    start = time.monotonic()
+    due = start
+    for delta_us, data in chunks:
+        if speed:
+            due += delta_us / 1e6 / speed
+            time.sleep(max(0.0, due - time.monotonic()))
+        sent = time.monotonic()
+        term.write(data)
+        if not speed and (b'\r' in data or b'\n' in data):
+            term.wait_idle(idle, since=sent)
+    term.wait_idle(idle, since=sent)
+    return term.last_output - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('recording', help='file made with the console record command')
+    parser.add_argument('-p', '--port', help='serial port of the console')
+    parser.add_argument('-b', '--baud', type=int, default=115200)
+    parser.add_argument('-s', '--speed', type=float, default=1.0, help='pace multiplier (default 1)')
+    parser.add_argument('--max', action='store_true', help='no recorded delays, each line once the output is idle')
+    parser.add_argument('--idle', type=float, default=200, help='ms without output that end a command (default 200)')
+    parser.add_argument('--boot', type=float, default=2.0, help='s to wait for the console before replaying')
+    parser.add_argument('-o', '--output', help='file for the console output (default stdout)')
+    parser.add_argument('--dump', action='store_true', help='list the recorded input batches and exit')
+    parser.add_argument('-e', '--exec', help='linux-target executable to run instead of a port, with its arguments')
+    args = parser.parse_args()
+
+    chunks = load(args.recording)
+    if args.dump:
+        t = 0
+        for delta_us, data in chunks:
+            t += delta_us
+            print(f'{t / 1e6:10.3f} +{delta_us / 1e3:9.1f} ms  {data!r}')
+        return
+
+    command = shlex.split(args.exec) if args.exec else None
+    if args.port:
+        write, read, close = open_serial(args.port, args.baud)
+    elif command:
+        write, read, close = open_process(command)
+    else:
+        parser.error('give --port or a linux-target command')
+    if args.speed <= 0:
+        parser.error('--speed must be > 0')
+
+    out = open(args.output, 'wb') if args.output else sys.stdout.buffer
+    term = Terminal(write, out)
+    done = threading.Event()
+
+    def reader():
+        while not done.is_set():
+            data = read()
+            if data:
+                term.feed(data)
+
+    thread = threading.Thread(target=reader, daemon=True)
+    thread.start()
+    try:
+        if command:
+            time.sleep(args.boot)
+        write(b'\r')  # fresh prompt
+        term.wait_idle(args.idle / 1000)
+        elapsed = replay(chunks, term, 0 if args.max else args.speed, args.idle / 1000)
+    finally:
+        done.set()
+        thread.join()
+        close()
+
+    recorded = sum(d for d, _ in chunks) / 1e6
+    sent = sum(len(c) for _, c in chunks)
+    lines = sum(c.count(b'\r') + c.count(b'\n') for _, c in chunks)
+    sys.stderr.write(f'replayed {sent} bytes, {lines} lines in {elapsed:.3f} s (recorded over {recorded:.3f} s), '
+                     f'{term.bytes} bytes of output\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""Run console commands over the TCP console (cli_tcp_start()), e.g. from scripts in a lab rack.
+
+    cli_tcp.py 192.168.1.40 "free" "tasks"          # run the commands, print their output
+    cli_tcp.py 192.168.1.40 -f script.txt            # one command per line
+    cli_tcp.py 127.0.0.1 -P 2323                     # interactive, lines from stdin
+    cli_tcp.py 192.168.1.40 "version" --check        # exit status 1 if a command reported an error
+
+Any telnet client works for interactive use; this tool waits for each command's prompt before sending the next line,
+so its output can be captured or compared. The session greeting and the prompts are not printed.
+"""
+
+import argparse
+import re
+import socket
+import sys
+
+PROMPT = re.compile(rb'(?:^|\n)tcp\d+> $')
+ERRORS = (b'Command not recognized', b'Command returned error', b'Internal error', b'ERROR:')
+IAC = b'\xff'
+
+
+class Session:
+    """One TCP console session, output converted back from NVT (CR LF, doubled IAC)."""
+
+    def __init__(self, host, port, timeout):
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.buf = b''
+        greeting = self.until_prompt()
+        if b'console sessions are in use' in greeting:
+            sys.exit(greeting.decode(errors='replace').strip())
+
+    def until_prompt(self):
+        while not PROMPT.search(self.buf):
+            data = self.sock.recv(4096)
+            if not data:
+                sys.exit('connection closed by the device')
+            self.buf += data
+        out = PROMPT.sub(b'\n', self.buf).replace(b'\r\n', b'\n').replace(IAC + IAC, IAC)
+        self.buf = b''
+        return out.lstrip(b'\n')
+
+    def run(self, line):
+        self.sock.sendall(line.encode() + b'\r\n')
+        return self.until_prompt()
+
+    def close(self):
+        self.sock.sendall(b'\x04')
+        self.sock.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('host', help='device address')
+    parser.add_argument('commands', nargs='*', help='command lines to run (default: read them from stdin)')
+    parser.add_argument('-P', '--port', type=int, default=23, help='TCP port (default 23)')
+    parser.add_argument('-f', '--file', help='file with one command per line (# starts a comment)')
+    parser.add_argument('-t', '--timeout', type=float, default=30.0, help='s to wait for a command (default 30)')
+    parser.add_argument('--check', action='store_true', help='exit with status 1 if a command reported an error')
+    args = parser.parse_intermixed_args()
+
+    if args.file:
+        with open(args.file) as f:
+            lines = [line.strip() for line in f]
+        lines = [line for line in lines if line and not line.startswith('#')]
+    else:
+        lines = args.commands or None
+
+    session = Session(args.host, args.port, args.timeout)
+    failed = False
+    try:
+        for line in lines if lines is not None else (line.rstrip('\n') for line in sys.stdin):
+            out = session.run(line)
+            sys.stdout.buffer.write(out)
+            sys.stdout.flush()
+            failed |= any(out.startswith(e) or b'\n' + e in out for e in ERRORS)
+    except socket.timeout:
+        sys.exit(f'no prompt within {args.timeout} s')
+    finally:
+        session.close()
+
+    sys.exit(1 if args.check and failed else 0)
+
+
+if __name__ == '__main__':
+    main()
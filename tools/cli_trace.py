@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""Convert the console's `trace dump` output to Chrome trace / Perfetto JSON.
+
+    cli_trace.py -p /dev/ttyUSB0 -o trace.json      # run `trace dump` on the device
+    cli_trace.py -i console.log -o trace.json       # convert a saved dump instead
+
+Open the JSON in https://ui.perfetto.dev or chrome://tracing. Close any serial monitor before running it.
+
+Dump format (cli-trace.c): a `TRACE <format> <cores> <events> <now_us>` header, `CMD <index> <name>` lines, then one
+`<ts_us> <core> <event> <session> <arg>` line per event, oldest first, and `TRACE END`. Timestamps are the low
+32 bits of esp_timer_get_time().
+
+Each command becomes a `command` slice with its stages nested inside: `dispatch` (esp_console tokenizing the line and
+finding the command), `lookup`, `parse` and `callback`, then `flush` from the end of the command to the last output
+byte on the wire. Commands registered directly with esp_console only show `dispatch`. Keys typed until the line is
+complete form the `input` slice. Every raw event is also kept as an instant event.
+"""
+
+import argparse
+import json
+import sys
+import time
+
+NOT_FOUND = 0xFFFF
+SESSIONS = {0: 'console', 0xFF: 'scheduler', **{1 + i: f'tcp{1 + i}' for i in range(4)}}
+INPUT_TID = 1000
+TIMEOUT = 10.0
+
+
+def parse_dump(text):
+    """Return (commands, [(ts_us, core, event, session, arg)]) with timestamps unwrapped to 64 bits."""
+    lines = text.decode(errors='replace').splitlines()
+    try:
+        start = max(i for i, line in enumerate(lines) if line.startswith('TRACE ') and line != 'TRACE END')
+    except ValueError:
+        sys.exit('no trace dump in the input')
+
+    commands = {}
+    events = []
+    offset = 0
+    last = None
+    for line in lines[start + 1:]:
+        fields = line.split()
+        if line.strip() == 'TRACE END':
+            break
+        if len(fields) == 3 and fields[0] == 'CMD':
+            commands[int(fields[1])] = fields[2]
+            continue
+        if len(fields) != 5:
+            continue
+        ts = int(fields[0])
+        if last is not None and ts + offset < last - (1 << 31):
+            offset += 1 << 32
+        last = ts + offset
+        events.append((last, int(fields[1]), fields[2], int(fields[3]), int(fields[4])))
+    return commands, events
+
+
+def to_chrome(commands, events):
+    out = []
+    stacks = {}  # tid -> [[name, start_us, args]]
+    input_start = None
+    input_bytes = 0
+    flush_from = {}  # tid -> end of the last command
+
+    def begin(tid, name, ts, **args):
+        stacks.setdefault(tid, []).append([name, ts, args])
+
+    def end(tid, ts, until=None):
+        """Close the innermost slice, or every slice down to and including `until`."""
+        stack = stacks.get(tid, [])
+        while stack:
+            name, start, args = stack.pop()
+            out.append({'name': name, 'ph': 'X', 'pid': 1, 'tid': tid, 'ts': start, 'dur': ts - start, 'args': args})
+            if until is None or name == until:
+                return
+
+    def command_frame(tid):
+        for frame in reversed(stacks.get(tid, [])):
+            if frame[0] == 'command':
+                return frame
+        return None
+
+    for ts, core, event, session, arg in events:
+        tid = INPUT_TID if event in ('rx', 'line') else session
+        out.append({'name': event, 'ph': 'i', 's': 't', 'pid': 1, 'tid': tid, 'ts': ts,
+                    'args': {'core': core, 'arg': arg}})
+
+        if event == 'rx':
+            if input_start is None:
+                input_start, input_bytes = ts, 0
+            input_bytes += 1
+        elif event == 'line':
+            if input_start is not None:
+                out.append({'name': 'input', 'ph': 'X', 'pid': 1, 'tid': INPUT_TID, 'ts': input_start,
+                            'dur': ts - input_start, 'args': {'bytes': input_bytes, 'length': arg}})
+            input_start = None
+        elif event == 'exec':
+            begin(tid, 'command', ts)
+            begin(tid, 'dispatch', ts)
+        elif event == 'tokenized':
+            end(tid, ts, until='dispatch')
+            begin(tid, 'lookup', ts)
+        elif event == 'lookup':
+            end(tid, ts, until='lookup')
+            frame = command_frame(tid)
+            if arg != NOT_FOUND:
+                if frame is not None:
+                    frame[2]['command'] = commands.get(arg, f'#{arg}')
+                begin(tid, 'parse', ts)
+        elif event == 'parsed':
+            end(tid, ts, until='parse')
+        elif event == 'cb_start':
+            frame = command_frame(tid)
+            begin(tid, 'callback', ts, **({'command': frame[2]['command']} if frame and 'command' in frame[2] else {}))
+        elif event == 'cb_end':
+            end(tid, ts, until='callback')
+        elif event == 'done':
+            frame = command_frame(tid)
+            if frame is not None:
+                frame[2]['result'] = 'not found' if arg == NOT_FOUND else arg
+            end(tid, ts, until='command')
+            flush_from[tid] = ts
+        elif event == 'flushed' and tid in flush_from:
+            start = flush_from.pop(tid)
+            out.append({'name': 'flush', 'ph': 'X', 'pid': 1, 'tid': tid, 'ts': start, 'dur': ts - start, 'args': {}})
+
+    # Slices still open when the dump was taken are cut at the last event
+    if events:
+        for tid in list(stacks):
+            while stacks[tid]:
+                end(tid, events[-1][0])
+
+    out.append({'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': INPUT_TID, 'args': {'name': 'input'}})
+    for tid in {e['tid'] for e in out if e['tid'] != INPUT_TID}:
+        out.append({'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': tid,
+                    'args': {'name': SESSIONS.get(tid, f'session {tid}')}})
+    return out
+
+
+def dump_serial(port_name, baud):
+    import serial  # pyserial
+
+    with serial.Serial(port_name, baud, timeout=0.1) as port:
+        port.write(b'trace dump\r')
+        buf = bytearray()
+        deadline = time.monotonic() + TIMEOUT
+        while time.monotonic() < deadline:
+            buf += port.read(4096)
+            if b'TRACE END' in buf:
+                return bytes(buf)
+            if b'Unrecognized command' in buf or b'Command not recognized' in buf:
+                sys.exit('the device has no trace command (cli_config_t.enable_trace)')
+    sys.exit('timeout waiting for the trace dump')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-p', '--port', help='serial port of the console')
+    parser.add_argument('-b', '--baud', type=int, default=115200)
+    parser.add_argument('-i', '--input', help='saved console output to convert instead of a port')
+    parser.add_argument('-o', '--output', required=True, help='JSON file to write')
+    args = parser.parse_args()
+
+    if args.input:
+        with open(args.input, 'rb') as f:
+            text = f.read()
+    elif args.port:
+        text = dump_serial(args.port, args.baud)
+    else:
+        parser.error('give --port or --input')
+
+    commands, events = parse_dump(text)
+    trace = to_chrome(commands, events)
+    with open(args.output, 'w') as f:
+        json.dump({'traceEvents': trace, 'displayTimeUnit': 'ms'}, f)
+
+    slices = sum(1 for e in trace if e['ph'] == 'X' and e['name'] == 'command')
+    sys.stderr.write(f'{len(events)} events, {slices} commands -> {args.output}\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,315 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""Host side of the advanced example's `rx` / `tx` file transfer commands.
+
+    cli_xfer.py -p /dev/ttyUSB0 get history.txt            # device /data/history.txt -> ./history.txt
+    cli_xfer.py -p /dev/ttyUSB0 put config.json cfg.json   # ./config.json -> device /data/cfg.json
+
+Interrupted transfers resume: `get` keeps the partial download in <local>.part, `put` resumes from the
+<remote>.part file left on the device. A partial file is only resumed if its CRC32 matches the start of the file
+being sent, and the whole-file CRC32 is checked before it is renamed. Close any serial monitor before running it.
+
+Frame layout (little endian), CRC32 over type..payload, same as cmd_fs_xfer.c:
+
+    0xA5 | type | seq | len (2) | offset (4) | payload (len) | crc32 (4)
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+SOF = 0xA5
+HEADER = struct.Struct('<BBHI')  # type, seq, len, offset (after SOF)
+CRC_SIZE = 4
+BLOCK_SIZE = 1024
+WINDOW = 4
+TIMEOUT = 2.0
+START_TIMEOUT = 10.0
+MAX_RETRIES = 10
+
+START, DATA, ACK, NAK, END, ABORT = (ord(c) for c in 'SDANEX')
+
+
+class XferError(Exception):
+    pass
+
+
+class Link:
+    """Frame codec over a pyserial-like port (read/write/timeout)."""
+
+    def __init__(self, port):
+        self.port = port
+        self.buf = bytearray()
+        self.seq = 0
+
+    def send(self, frame_type, offset, payload=b''):
+        body = HEADER.pack(frame_type, self.seq & 0xFF, len(payload), offset) + payload
+        self.seq += 1
+        self.port.write(bytes([SOF]) + body + struct.pack('<I', zlib.crc32(body)))
+
+    def _fill(self, deadline):
+        remaining = deadline - time.monotonic()
+        if remaining <= 0:
+            return False
+        self.port.timeout = min(remaining, 0.1)
+        data = self.port.read(4096)
+        self.buf += data
+        return True
+
+    def _parse(self):
+        while True:
+            start = self.buf.find(bytes([SOF]))
+            if start < 0:
+                self.buf.clear()
+                return None
+            del self.buf[:start]
+            if len(self.buf) < 1 + HEADER.size:
+                return None
+            frame_type, _, length, offset = HEADER.unpack_from(self.buf, 1)
+            if length > BLOCK_SIZE:
+                del self.buf[0]
+                continue
+            total = 1 + HEADER.size + length + CRC_SIZE
+            if len(self.buf) < total:
+                return None
+            body = bytes(self.buf[1:1 + HEADER.size + length])
+            (crc,) = struct.unpack_from('<I', self.buf, 1 + HEADER.size + length)
+            if zlib.crc32(body) != crc:
+                del self.buf[0]
+                continue
+            del self.buf[:total]
+            return frame_type, offset, body[HEADER.size:]
+
+    def recv(self, timeout=TIMEOUT):
+        """Return (type, offset, payload), or None on timeout."""
+        deadline = time.monotonic() + timeout
+        while True:
+            frame = self._parse()
+            if frame is not None:
+                return frame
+            if not self._fill(deadline):
+                return None
+
+    def wait_line(self, prefix, timeout=START_TIMEOUT):
+        """Skip console echo until a text line starting with prefix arrives; keep what follows it buffered."""
+        deadline = time.monotonic() + timeout
+        while True:
+            while b'\n' in self.buf:
+                line, _, rest = bytes(self.buf).partition(b'\n')
+                self.buf = bytearray(rest)
+                text = line.decode(errors='replace').strip()
+                if text.startswith(prefix):
+                    return text
+                if text.startswith('ERROR'):
+                    raise XferError(text)
+            if not self._fill(deadline):
+                raise XferError(f'timeout waiting for "{prefix}"')
+
+
+def file_crc(f, length):
+    """CRC32 of the first length bytes of an open file."""
+    f.seek(0)
+    crc = 0
+    while length > 0:
+        chunk = f.read(min(length, 65536))
+        if not chunk:
+            break
+        crc = zlib.crc32(chunk, crc)
+        length -= len(chunk)
+    return crc
+
+
+def progress(done, total, started):
+    rate = done / max(time.monotonic() - started, 1e-6) / 1024
+    sys.stderr.write(f'\r{done}/{total} bytes  {rate:.1f} KB/s ')
+    sys.stderr.flush()
+
+
+def send_stream(link, f, size, acked, window, crc):
+    """Go-back-N sender, mirror of xfer_send_file() on the device."""
+    started = time.monotonic()
+    next_offset = acked
+    retries = 0
+    f.seek(acked)
+    while acked < size:
+        while next_offset < size and next_offset - acked < window * BLOCK_SIZE:
+            chunk = f.read(min(BLOCK_SIZE, size - next_offset))
+            link.send(DATA, next_offset, chunk)
+            next_offset += len(chunk)
+
+        frame = link.recv()
+        rewind = frame is None
+        if frame is not None:
+            frame_type, offset, _ = frame
+            if frame_type == ABORT:
+                raise XferError('device aborted')
+            if frame_type in (ACK, NAK) and acked <= offset <= next_offset:
+                if offset > acked:
+                    retries = 0
+                acked = offset
+                rewind = frame_type == NAK
+        if rewind:
+            retries += 1
+            if retries > MAX_RETRIES:
+                raise XferError(f'no progress at offset {acked}')
+            next_offset = acked
+            f.seek(acked)
+        progress(acked, size, started)
+
+    for _ in range(MAX_RETRIES):
+        link.send(END, size, struct.pack('<I', crc))
+        frame = link.recv()
+        if frame is not None and frame[0] == ACK and frame[1] == size:
+            return
+        if frame is not None and frame[0] == ABORT:
+            raise XferError('device rejected the file CRC, partial file discarded')
+    # The device may have finished and only the final ACK was lost; its status line decides
+    sys.stderr.write('\nno ACK for END, checking device status\n')
+
+
+def receive_stream(link, f, size, expected):
+    """Receiver, mirror of xfer_recv_file() on the device. Returns the file CRC32 sent with END."""
+    started = time.monotonic()
+    nak_sent = False
+    retries = 0
+    while True:
+        frame = link.recv()
+        if frame is None:
+            retries += 1
+            if retries > MAX_RETRIES:
+                raise XferError(f'no data at offset {expected}')
+            link.send(NAK, expected)
+            continue
+
+        frame_type, offset, payload = frame
+        if frame_type == DATA:
+            if offset == expected and expected + len(payload) <= size:
+                f.write(payload)
+                expected += len(payload)
+                link.send(ACK, expected)
+                nak_sent = False
+                retries = 0
+                progress(expected, size, started)
+            elif offset > expected and not nak_sent:
+                link.send(NAK, expected)
+                nak_sent = True
+            elif offset < expected:
+                link.send(ACK, expected)
+        elif frame_type == END:
+            if expected == size and len(payload) >= 4:
+                link.send(ACK, expected)
+                return struct.unpack_from('<I', payload)[0]
+            link.send(NAK, expected)
+        elif frame_type == ABORT:
+            raise XferError('device aborted')
+
+
+def quote(name):
+    return '"' + name.replace('"', '\\"') + '"' if ' ' in name else name
+
+
+def cmd_get(link, remote, local):
+    part = local + '.part'
+    resume = os.path.getsize(part) if os.path.exists(part) else 0
+
+    link.port.write(f'tx {quote(remote)}\r'.encode())
+    size = int(link.wait_line('XFER TX').split()[2])
+    if resume > size:
+        resume = 0
+
+    with open(part, 'r+b' if resume else 'w+b') as f:
+        # The device resumes only if our partial copy is the start of its file, and answers the offset to use
+        prefix_crc = file_crc(f, resume)
+        for _ in range(MAX_RETRIES):
+            link.send(START, resume, struct.pack('<I', prefix_crc))
+            frame = link.recv()
+            if frame is not None and frame[0] == ACK:
+                break
+        else:
+            raise XferError('device did not answer START')
+        start = frame[1]
+        if start != resume:
+            sys.stderr.write(f'{part} does not match the device file, starting over\n')
+        elif start:
+            sys.stderr.write(f'resuming at {start} bytes\n')
+        f.truncate(start)
+        f.seek(start)
+        crc = receive_stream(link, f, size, start)
+        f.flush()
+        ok = file_crc(f, size) == crc
+
+    status = link.wait_line('XFER')
+    if not ok:
+        os.remove(part)
+        raise XferError('file CRC mismatch, partial file discarded')
+    os.replace(part, local)
+    sys.stderr.write(f'\n{status}: {size} bytes -> {local}\n')
+
+
+def cmd_put(link, local, remote):
+    size = os.path.getsize(local)
+
+    link.port.write(f'rx {quote(remote)}\r'.encode())
+    partial = int(link.wait_line('XFER RX').split()[2])
+
+    with open(local, 'rb') as f:
+        # The device checks that its partial file is the start of ours before resuming from it
+        prefix_crc = file_crc(f, partial)
+        crc = file_crc(f, size)
+        for _ in range(MAX_RETRIES):
+            link.send(START, partial, struct.pack('<II', size, prefix_crc))
+            frame = link.recv()
+            if frame is not None and frame[0] == ACK:
+                break
+        else:
+            raise XferError('device did not answer START')
+        _, acked, payload = frame
+        window = payload[0] if payload else 1
+        if acked:
+            sys.stderr.write(f'resuming at {acked} bytes\n')
+        elif partial:
+            sys.stderr.write(f'/data/{remote}.part does not match {local}, starting over\n')
+
+        send_stream(link, f, size, acked, window, crc)
+
+    status = link.wait_line('XFER')
+    sys.stderr.write(f'\n{status}: {local} -> /data/{remote}\n')
+    if status != 'XFER OK':
+        raise XferError(status)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-p', '--port', required=True, help='serial port of the console')
+    parser.add_argument('-b', '--baud', type=int, default=115200)
+    sub = parser.add_subparsers(dest='command', required=True)
+    get = sub.add_parser('get', help='copy a file from the device')
+    get.add_argument('remote')
+    get.add_argument('local', nargs='?')
+    put = sub.add_parser('put', help='copy a file to the device')
+    put.add_argument('local')
+    put.add_argument('remote', nargs='?')
+    args = parser.parse_args()
+
+    import serial  # pyserial, only needed when talking to a device
+
+    with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+        link = Link(port)
+        try:
+            if args.command == 'get':
+                cmd_get(link, args.remote, args.local or os.path.basename(args.remote))
+            else:
+                cmd_put(link, args.local, args.remote or os.path.basename(args.local))
+        except XferError as e:
+            link.send(ABORT, 0)
+            sys.exit(f'\nerror: {e}')
+        except KeyboardInterrupt:
+            link.send(ABORT, 0)
+            sys.exit('\ninterrupted, run the same command again to resume')
+
+
+if __name__ == '__main__':
+    main()